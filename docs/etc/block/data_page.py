@@ -7,6 +7,11 @@ def activate_data_page(*args, **kwargs):
     pass
 
 
+def data_page_ready(*args, **kwargs):
+    """data_page_ready(ip: int) -> bool"""
+    pass
+
+
 def get_data_page_pointer(*args, **kwargs):
     """get_data_page_pointer(ip: int) -> int"""
     pass
@@ -22,6 +27,20 @@ def load_data_page(*args, **kwargs):
     pass
 
 
+def load_data_page_async(*args, **kwargs):
+    """load_data_page_async(ip: int, filename: str) -> None
+
+    Queue the load of page ip on the I/O thread."""
+    pass
+
+
+def print_data_page_usage(*args, **kwargs):
+    """print_data_page_usage() -> None
+
+    Print the largest use of each data page so far."""
+    pass
+
+
 def release_data_pages(*args, **kwargs):
     """release_data_pages() -> None"""
     pass
@@ -32,7 +51,27 @@ def save_data_page(*args, **kwargs):
     pass
 
 
+def save_data_page_async(*args, **kwargs):
+    """save_data_page_async(ip: int, filename: str) -> None
+
+    Queue the save of page ip on the I/O thread."""
+    pass
+
+
+def set_data_page_cache(*args, **kwargs):
+    """set_data_page_cache(n: int) -> None
+
+    Keep up to n doubles of recently used page files in memory."""
+    pass
+
+
 def set_data_page_pointer(*args, **kwargs):
     """set_data_page_pointer(ip: int, offset: int) -> None"""
     pass
 
+
+def wait_data_page(*args, **kwargs):
+    """wait_data_page(ip: int = -1) -> None
+
+    Wait for the queued saves and loads of page ip (all pages for -1)."""
+    pass
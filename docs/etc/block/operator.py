@@ -1025,7 +1025,17 @@ Overloaded function.
 
 class StackSparseMatrix:
     """Block-sparse matrix. 
-Non-zero blocks are identified by symmetry (quantum numbers) requirements and stored as :class:`StackMatrix` objects"""
+Non-zero blocks are identified by symmetry (quantum numbers) requirements and stored as :class:`StackMatrix` objects. The whole data region can be viewed with ``numpy.asarray``."""
+
+    @property
+    def block_offsets(self):
+        """Offsets of the non zero blocks in the data region, in the order of :attr:`StackSparseMatrix.non_zero_blocks`."""
+        pass
+
+    @property
+    def block_shapes(self):
+        """Rows and columns of the non zero blocks, as an n x 2 array."""
+        pass
 
     @property
     def total_memory(self):
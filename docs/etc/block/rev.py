@@ -2,6 +2,13 @@
 """Revised Block functions."""
 
 
+def block_tensor_contract(*args, **kwargs):
+    """block_tensor_contract(a: list, b: list, c: list, gemms: list) -> None
+
+    c[ic] += a[ia] @ b[ib] for each (ia, ib, ic) in gemms, all blocks C-contiguous 2-d float64 arrays."""
+    pass
+
+
 def product(*args, **kwargs):
     """product(a: block.operator.StackSparseMatrix, b: block.operator.StackSparseMatrix, c: block.operator.StackSparseMatrix, state_info: block.symmetry.StateInfo, scale: float = 1.0) -> None"""
     pass
@@ -22,6 +29,13 @@ def tensor_product(*args, **kwargs):
     pass
 
 
+def tensor_product_batch(*args, **kwargs):
+    """tensor_product_batch(c: list, terms: list, state_info: block.symmetry.VectorStateInfo) -> None
+
+    Add the list of terms (a, b, scale) to each c, a or b None for the identity."""
+    pass
+
+
 def tensor_product_diagonal(*args, **kwargs):
     """tensor_product_diagonal(a: block.operator.StackSparseMatrix, b: block.operator.StackSparseMatrix, c: block.DiagonalMatrix, state_info: block.symmetry.VectorStateInfo, scale: float = 1.0) -> None"""
     pass
@@ -66,3 +80,18 @@ def tensor_trace_multiply(*args, **kwargs):
     """tensor_trace_multiply(a: block.operator.StackSparseMatrix, c: block.operator.Wavefunction, v: block.operator.Wavefunction, state_info: block.symmetry.StateInfo, trace_right: bool, scale: float) -> None"""
     pass
 
+
+class TensorProductMultiplyPlan:
+    """Precomputed block walk and coupling coefficients of :func:`tensor_product_multiply`."""
+
+    def __init__(self, *args, **kwargs):
+        """__init__(self: block.rev.TensorProductMultiplyPlan, a: block.operator.StackSparseMatrix, b: block.operator.StackSparseMatrix, c: block.operator.Wavefunction, v: block.operator.Wavefunction, state_info: block.symmetry.VectorStateInfo, op_q: block.symmetry.SpinQuantum) -> None"""
+        pass
+
+    def multiply(self, *args, **kwargs):
+        """multiply(self: block.rev.TensorProductMultiplyPlan, a: block.operator.StackSparseMatrix, b: block.operator.StackSparseMatrix, c: block.operator.Wavefunction, v: block.operator.Wavefunction, scale: float) -> None"""
+        pass
+
+    @property
+    def size(self):
+        pass
@@ -88,6 +88,7 @@ class Compress:
         self._post_sweep = contractor.post_sweep if contractor is not None else lambda: None
         
         self.beta = 0
+        self.one_dot_noise = 0.0
 
         self.rebuild = contractor.rebuild
         
@@ -359,6 +360,9 @@ class Compress:
         self.center = i
 
         if self.dot == 1:
+            # a one-dot update cannot add states to the bond by itself, the
+            # noise in the density matrix keeps the subspace open
+            noise = max(noise, self.one_dot_noise)
             return self.update_one_dot(i, forward, bond_dim, ket_bond_dim, noise, beta)
         else:
             return self.update_two_dot(i, forward, bond_dim, ket_bond_dim, noise, beta)
@@ -413,7 +417,7 @@ class Compress:
 
         return sweep_results[-1]
 
-    def solve(self, n_sweeps, tol, forward=True, two_dot_to_one_dot=-1):
+    def solve(self, n_sweeps, tol, forward=True, two_dot_to_one_dot=-1, one_dot_tol=None, one_dot_noise=1E-7):
         """
         Perform Compression algorithm.
         
@@ -426,6 +430,13 @@ class Compress:
                 Direction of first sweep. If True, sweep is performed from left to right.
             two_dot_to_one_dot : int or -1
                 Indicating when to switch to one-dot scheme. If -1, no switching.
+            one_dot_tol : float or None
+                If not None, switch to one-dot scheme after the first two-dot sweep at the final
+                bond dimension that changes the norm by less than this threshold.
+                The one-dot sweeps work on tensors smaller by the dimension of one site.
+            one_dot_noise : float
+                Minimal noise of the one-dot sweeps after switching with ``one_dot_tol``,
+                so that the bond dimension can still grow.
         
         Returns:
             nrom : float
@@ -446,6 +457,13 @@ class Compress:
             pprint("Sweep = %4d | Direction = %8s | Bond dimension = %4d | Noise = %9.2g | Beta = %9.2g"
                 % (iw, "forward" if forward else "backward", self.bond_dims[iw], self.noise[iw], self.beta))
             
+            if (one_dot_tol is not None and self.dot == 2 and len(self.energies) >= 2
+                and abs(self.energies[-1] - self.energies[-2]) < one_dot_tol
+                and self.bond_dims[iw - 1] == self.bond_dims[-1]):
+                pprint("Switching to one-dot scheme")
+                self.one_dot_noise = one_dot_noise
+                two_dot_to_one_dot = iw
+            
             if two_dot_to_one_dot == iw:
                 assert self.dot == 2
                 self.dot = 1
@@ -49,16 +49,43 @@ class Expect:
     The sweep will thus change the canonical form of MPS and MPSInfo in contractor.
     Therefore, it is recommended that a copy of MPS and MPSInfo is used here.
     
+    Several MPOs can be evaluated in one sweep by giving `mpo` and `contractor` as dicts
+    with the same keys, e.g. ``{'H': mpo, 'N': nmpo}``. Every MPO keeps its own environment
+    (its contractor needs its own page frame), while the copies of the MPS, the fusing
+    and the decomposition of the local MPS tensors and the MPSInfo updates
+    are done once for all of them. The results are then dicts from the keys to the
+    expectation values.
+    
+    With `variance`, the energy variance of the ket is evaluated at each canonical form as well,
+    from the local effective Hamiltonian applied to the local tensor (see
+    :meth:`DMRGContractor.expect`), so that no :class:`SquareMPO` is needed. This needs
+    a single Hamiltonian MPO and the bra and ket being the same state.
+    
     Attributes:
         n_sites : int
             Number of sites/orbitals
         dot : int
             Two-dot (2) or one-dot (1) scheme.
+        variances : list(float)
+            Energy variance at each canonical form of the last :meth:`solve`, with `variance`.
     """
-    def __init__(self, mpo, bra_mps, ket_mps, bra_canonical_form=None, ket_canonical_form=None, contractor=None):
-        self.n_sites = len(mpo)
-        if hasattr(mpo, "n_physical_sites"):
-            self.n_physical_sites = mpo.n_physical_sites
+    def __init__(self, mpo, bra_mps, ket_mps, bra_canonical_form=None, ket_canonical_form=None, contractor=None,
+                 variance=False):
+        if isinstance(mpo, dict):
+            self.names = list(mpo.keys())
+            mpos = [mpo[k] for k in self.names]
+            if contractor is None:
+                contractor = {}
+            ctrs = [contractor.get(k, None) for k in self.names]
+        else:
+            self.names = None
+            mpos, ctrs = [mpo], [contractor]
+        if variance and self.names is not None:
+            raise ExpectationError('Variance needs a single Hamiltonian MPO!')
+        self.variance = variance
+        self.n_sites = len(mpos[0])
+        if hasattr(mpos[0], "n_physical_sites"):
+            self.n_physical_sites = mpos[0].n_physical_sites
         else:
             self.n_physical_sites = self.n_sites
         self.dot = bra_mps.dot
@@ -68,9 +95,11 @@ class Expect:
 
         self._k = ket_mps.deep_copy().add_tags({'_KET'})
         self._b = bra_mps.deep_copy().add_tags({'_BRA'})
-        self._h = mpo.copy().add_tags({'_HAM'})
-
-        self._h.set_contractor(contractor)
+        self._hs = [m.copy().add_tags({'_HAM'}) for m in mpos]
+        self._ctrs = ctrs
+        for h, ctr in zip(self._hs, ctrs):
+            h.set_contractor(ctr)
+        self._h = self._hs[0]
 
         if bra_canonical_form is None:
             self.bra_canonical_form  = ['L'] * min(self.center, self.n_sites)
@@ -86,12 +115,55 @@ class Expect:
         
         assert self.ket_canonical_form == self.bra_canonical_form
         
-        self._pre_sweep = contractor.pre_sweep if contractor is not None else lambda: None
-        self._post_sweep = contractor.post_sweep if contractor is not None else lambda: None
+    def _pre_sweep(self):
+        for ctr in self._ctrs:
+            if ctr is not None:
+                ctr.pre_sweep()
+    
+    def _post_sweep(self):
+        for ctr in self._ctrs[::-1]:
+            if ctr is not None:
+                ctr.post_sweep()
     
     def construct_envs(self):
         t = time.perf_counter()
-        self.eff_ham = MovingEnvironment(self.n_sites, self.center, self.dot, self._b | self._h | self._k, iprint=False)
+        self.eff_hams = []
+        for h, ctr in zip(self._hs, self._ctrs):
+            if len(self._hs) == 1:
+                tn = self._b | h | self._k
+            else:
+                # the MPS tensors of an environment are contracted by its own contractor
+                tn = self._b.copy().set_contractor(ctr) | h | self._k.copy().set_contractor(ctr)
+            self.eff_hams.append(MovingEnvironment(self.n_sites, self.center, self.dot, tn, iprint=False))
+        self.eff_ham = self.eff_hams[0]
+    
+    def _expect(self, i, fuse_tags, psi_bra, psi_ket):
+        """Expectation values of all MPOs for the local bra and ket tensors."""
+        results = []
+        for env, h in zip(self.eff_hams, self._hs):
+            h_eff = (env() ^ '_HAM')['_HAM']
+            h_eff.tags |= fuse_tags
+            if self.variance:
+                result, self._variance = h[{i, '_HAM'}].contractor.expect(h_eff, psi_bra, psi_ket, variance=True)
+            else:
+                result = h[{i, '_HAM'}].contractor.expect(h_eff, psi_bra, psi_ket)
+            if len(result) == 1 and repr(list(result.keys())[0]) == 'H':
+                result = list(result.values())[0]
+            results.append(result)
+        return results[0] if self.names is None else dict(zip(self.names, results))
+    
+    def _update_mps_info(self, left, i, tensor):
+        """Update the MPSInfo of the contractors, each distinct one once."""
+        done = set()
+        for ctr in self._ctrs:
+            info = ctr._get_mps_info(tensor.tags)
+            if id(info) in done:
+                continue
+            done.add(id(info))
+            if left:
+                ctr.update_local_left_mps_info(i, tensor)
+            else:
+                ctr.update_local_right_mps_info(i, tensor)
     
     def update_one_dot(self, i, forward, bond_dim):
         """
@@ -125,16 +197,12 @@ class Expect:
             else:
                 ctr.fuse_right(i, kb[{i, tag}], cf[i])
         
-        self.eff_ham()[{i, '_HAM'}].tags |= fuse_tags
-        h_eff = (self.eff_ham() ^ '_HAM')['_HAM']
-        h_eff.tags |= fuse_tags
+        for env in self.eff_hams:
+            env()[{i, '_HAM'}].tags |= fuse_tags
         psi_bra = self._b[{i, '_BRA'}]
         psi_ket = self._k[{i, '_KET'}]
         
-        result = ctr.expect(h_eff, psi_bra, psi_ket)
-        
-        if len(result) == 1 and repr(list(result.keys())[0]) == 'H':
-            result = list(result.values())[0]
+        result = self._expect(i, fuse_tags, psi_bra, psi_ket)
         
         if forward is None:
             return result
@@ -172,11 +240,11 @@ class Expect:
         TensorNetwork(tensors=[l_fused_ket, r_fused_ket]).add_tags({'_KET'})
         
         if forward:
-            ctr.update_local_left_mps_info(i, l_fused_bra)
-            ctr.update_local_left_mps_info(i, l_fused_ket)
+            self._update_mps_info(True, i, l_fused_bra)
+            self._update_mps_info(True, i, l_fused_ket)
         else:
-            ctr.update_local_right_mps_info(i, r_fused_bra)
-            ctr.update_local_right_mps_info(i, r_fused_ket)
+            self._update_mps_info(False, i, r_fused_bra)
+            self._update_mps_info(False, i, r_fused_ket)
         
         if forward:
             l_bra = ctr.unfuse_left(i, l_fused_bra)
@@ -187,13 +255,14 @@ class Expect:
                 adj_ket = Tensor.contract(r_fused_ket, self._k[{i + 1, '_KET'}], [1], [0])
                 self._b[{i + 1, '_BRA'}].modify(adj_bra)
                 self._k[{i + 1, '_KET'}].modify(adj_ket)
-                self.eff_ham.envs[self.eff_ham.pos + 1][{i + 1, '_BRA'}].modify(adj_bra)
-                self.eff_ham.envs[self.eff_ham.pos + 1][{i + 1, '_KET'}].modify(adj_ket)
+                for env in self.eff_hams:
+                    env.envs[env.pos + 1][{i + 1, '_BRA'}].modify(adj_bra)
+                    env.envs[env.pos + 1][{i + 1, '_KET'}].modify(adj_ket)
             else:
                 l_bra.right_multiply(r_fused_bra.to_dict(0))
                 l_ket.right_multiply(r_fused_ket.to_dict(0))
-                ctr.update_local_left_mps_info(i, l_bra.add_tags({'_BRA'}))
-                ctr.update_local_left_mps_info(i, l_ket.add_tags({'_KET'}))
+                self._update_mps_info(True, i, l_bra.add_tags({'_BRA'}))
+                self._update_mps_info(True, i, l_ket.add_tags({'_KET'}))
                 self.bra_canonical_form[i] = self.ket_canonical_form[i] = 'K'
         else:
             r_bra = ctr.unfuse_right(i, r_fused_bra)
@@ -204,20 +273,22 @@ class Expect:
                 adj_ket = Tensor.contract(self._k[{i - 1, '_KET'}], l_fused_ket, [2], [0])
                 self._b[{i - 1, '_BRA'}].modify(adj_bra)
                 self._k[{i - 1, '_KET'}].modify(adj_ket)
-                self.eff_ham.envs[self.eff_ham.pos - 1][{i - 1, '_BRA'}].modify(adj_bra)
-                self.eff_ham.envs[self.eff_ham.pos - 1][{i - 1, '_KET'}].modify(adj_ket)
+                for env in self.eff_hams:
+                    env.envs[env.pos - 1][{i - 1, '_BRA'}].modify(adj_bra)
+                    env.envs[env.pos - 1][{i - 1, '_KET'}].modify(adj_ket)
             else:
                 r_bra.left_multiply(l_fused_bra.to_dict(1))
                 r_ket.left_multiply(l_fused_ket.to_dict(1))
-                ctr.update_local_right_mps_info(i, r_bra.add_tags({'_BRA'}))
-                ctr.update_local_right_mps_info(i, r_ket.add_tags({'_KET'}))
+                self._update_mps_info(False, i, r_bra.add_tags({'_BRA'}))
+                self._update_mps_info(False, i, r_ket.add_tags({'_KET'}))
                 self.bra_canonical_form[i] = self.ket_canonical_form[i] = 'S'
 
-        self.eff_ham()[{i, '_HAM'} | fuse_tags].tags -= fuse_tags
         self._b[{i, '_BRA'}].modify(l_bra if forward else r_bra)
         self._k[{i, '_KET'}].modify(l_ket if forward else r_ket)
-        self.eff_ham()[{i, '_BRA'}].modify(l_bra if forward else r_bra)
-        self.eff_ham()[{i, '_KET'}].modify(l_ket if forward else r_ket)
+        for env in self.eff_hams:
+            env()[{i, '_HAM'} | fuse_tags].tags -= fuse_tags
+            env()[{i, '_BRA'}].modify(l_bra if forward else r_bra)
+            env()[{i, '_KET'}].modify(l_ket if forward else r_ket)
 
         return result
 
@@ -251,17 +322,14 @@ class Expect:
                 ctr.fuse_right(i + 1, kb[{i + 1, tag}], cf[i + 1])
                 two_site = kb.select({i, i + 1}, which='any') ^ (tag, i, i + 1)
                 kb.replace({i, i + 1}, two_site, which='any')
-                [self.eff_ham().remove({j, tag}, in_place=True) for j in [i, i + 1]]
-                self.eff_ham().add(two_site)
+                for env in self.eff_hams:
+                    [env().remove({j, tag}, in_place=True) for j in [i, i + 1]]
+                    env().add(two_site)
 
-        h_eff = (self.eff_ham() ^ '_HAM')['_HAM']
         psi_bra = self.eff_ham()[{i, i + 1, '_BRA'}]
         psi_ket = self.eff_ham()[{i, i + 1, '_KET'}]
         
-        result = ctr.expect(h_eff, psi_bra, psi_ket)
-        
-        if len(result) == 1 and repr(list(result.keys())[0]) == 'H':
-            result = list(result.values())[0]
+        result = self._expect(i, set(), psi_bra, psi_ket)
         
         if forward is None:
             return result
@@ -297,11 +365,11 @@ class Expect:
         TensorNetwork(tensors=[l_fused_ket, r_fused_ket]).add_tags({'_KET'})
         
         if forward:
-            ctr.update_local_left_mps_info(i, l_fused_bra)
-            ctr.update_local_left_mps_info(i, l_fused_ket)
+            self._update_mps_info(True, i, l_fused_bra)
+            self._update_mps_info(True, i, l_fused_ket)
         else:
-            ctr.update_local_right_mps_info(i + 1, r_fused_bra)
-            ctr.update_local_right_mps_info(i + 1, r_fused_ket)
+            self._update_mps_info(False, i + 1, r_fused_bra)
+            self._update_mps_info(False, i + 1, r_fused_ket)
         
         l_bra = ctr.unfuse_left(i, l_fused_bra)
         r_bra = ctr.unfuse_right(i + 1, r_fused_bra)
@@ -319,6 +387,8 @@ class Expect:
         self._k.replace({i, i + 1}, tn_lr_ket)
         self._b.replace({i, i + 1}, tn_lr_bra)
         self.eff_ham().replace({i, i + 1}, tn_lr_ket | tn_lr_bra)
+        for env, xctr in zip(self.eff_hams[1:], self._ctrs[1:]):
+            env().replace({i, i + 1}, (tn_lr_ket | tn_lr_bra).copy().set_contractor(xctr))
         
         return result
     
@@ -339,7 +409,8 @@ class Expect:
             result : float
                 Expectation value.
         """
-        self.eff_ham.move_to(i)
+        for env in self.eff_hams:
+            env.move_to(i)
         self.center = i
 
         if self.dot == 1:
@@ -374,6 +445,7 @@ class Expect:
             sweep_range = range(self.center, -1, -1)
 
         self.results = []
+        self.variances = []
 
         for i in sweep_range:
             if self.dot == 2:
@@ -383,35 +455,47 @@ class Expect:
             t = time.perf_counter()
             result = self.blocking(i, forward=forward, bond_dim=bond_dim)
             
-            if isinstance(result, dict):
+            if self.names is not None:
+                pprint(" ".join(["%s = %15.8f" % (k, v) if not isinstance(v, dict) else
+                                 "%s: Nterms = %4d" % (k, len(v)) for k, v in result.items()])
+                       + " T = %4.2f" % (time.perf_counter() - t))
+            elif isinstance(result, dict):
                 pprint("Nterms = %4d T = %4.2f" % (len(result), time.perf_counter() - t))
+            elif self.variance:
+                pprint("Result = %15.8f Var = %15.8f T = %4.2f" % (result, self._variance, time.perf_counter() - t))
             else:
                 pprint("Result = %15.8f T = %4.2f" % (result, time.perf_counter() - t))
             
             self.results.append(result)
+            if self.variance:
+                self.variances.append(self._variance)
 
         self._post_sweep()
 
         return result
     
-    def get_1pdm_spatial(self, normsq=1):
+    def get_1pdm_spatial(self, normsq=1, name=None):
         """
-        Spatial 1-particle density matrix.
+        Spatial 1-particle density matrix (of the MPO `name` in multi-MPO mode).
         """
         pdmat = np.zeros((self.n_physical_sites, self.n_physical_sites))
         assert hasattr(self, "results")
         for r in self.results:
+            if name is not None:
+                r = r[name]
             for k, v in r.items():
                 pdmat[k.site_index[0], k.site_index[1]] = v / normsq
         return pdmat
     
-    def get_1pdm(self, normsq=1):
+    def get_1pdm(self, normsq=1, name=None):
         """
-        1-particle density matrix.
+        1-particle density matrix (of the MPO `name` in multi-MPO mode).
         """
         pdmat = np.zeros((self.n_physical_sites, self.n_physical_sites, 2, 2))
         assert hasattr(self, "results")
         for r in self.results:
+            if name is not None:
+                r = r[name]
             for k, v in r.items():
                 pdmat[k.site_index[0], k.site_index[1], k.site_index[2], k.site_index[3]] = v / normsq
         return pdmat
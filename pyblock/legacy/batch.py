@@ -0,0 +1,148 @@
+#
+#    pyblock: Spin-adapted quantum chemistry DMRG in MPO language (based on Block C++ code)
+#    Copyright (C) 2019-2020 Huanchen Zhai
+#
+#    Block 1.5.3: density matrix renormalization group (DMRG) algorithm for quantum chemistry
+#    Developed by Sandeep Sharma and Garnet K.-L. Chan, 2012
+#    Copyright (C) 2012 Garnet K.-L. Chan
+#
+#    This program is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License as published by
+#    the Free Software Foundation, either version 3 of the License, or
+#    (at your option) any later version.
+#
+#    This program is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+"""
+Many small DMRG calculations in one batch.
+
+The input, integrals and stack memory of block are global to the process, so the jobs
+of a batch run side by side in worker processes. Each worker keeps one ``block.dmrg.Session``
+for all its jobs, and pays the start up of block once.
+"""
+
+import concurrent.futures
+import multiprocessing
+import json
+import time
+import sys
+import os
+
+# keywords of the input that the batch sets for each job
+JOB_KEYWORDS = {'orbitals', 'orbs', 'prefix', 'scratch', 'num_thrds'}
+
+_session = None
+
+
+def job_input(input_file, fcidump, scratch, n_threads=1):
+    """
+    Input of one job: the input file with the integrals, scratch directory
+    and number of threads of the job.
+
+    Args:
+        input_file : str
+            Block input file, shared by the jobs.
+        fcidump : str
+            FCIDUMP of the job.
+        scratch : str
+            Scratch directory of the job.
+        n_threads : int
+            OpenMP threads of the job.
+
+    Returns:
+        conf : str
+    """
+    lines = []
+    with open(input_file, 'r') as f:
+        for l in f:
+            tok = l.split()
+            if len(tok) != 0 and tok[0].lower() in JOB_KEYWORDS:
+                continue
+            lines.append(l.rstrip('\n'))
+    lines.append('orbitals %s' % os.path.abspath(fcidump))
+    lines.append('prefix %s' % os.path.abspath(scratch))
+    lines.append('num_thrds %d' % n_threads)
+    return '\n'.join(lines) + '\n'
+
+
+def _init_worker():
+    global _session
+    from block.dmrg import Session
+    _session = Session()
+
+
+def _run_job(idx, input_file, fcidump, scratch, n_threads):
+    os.makedirs(scratch, exist_ok=True)
+    conf = os.path.join(scratch, 'dmrg.conf')
+    with open(conf, 'w') as f:
+        f.write(job_input(input_file, fcidump, scratch, n_threads))
+    result = {'job': idx, 'input': input_file, 'fcidump': fcidump,
+              'output': os.path.join(scratch, 'dmrg.out')}
+    # block writes to the standard output of the process
+    sys.stdout.flush()
+    stdout = os.dup(1)
+    out = os.open(result['output'], os.O_WRONLY | os.O_CREAT | os.O_TRUNC, 0o644)
+    os.dup2(out, 1)
+    os.close(out)
+    t = time.perf_counter()
+    try:
+        result['energies'] = [float(e) for e in _session.run(conf)]
+    except Exception as e:
+        result['error'] = str(e)
+    finally:
+        sys.stdout.flush()
+        os.dup2(stdout, 1)
+        os.close(stdout)
+    result['time'] = time.perf_counter() - t
+    return result
+
+
+def run_batch(jobs, scratch, n_workers=None, n_threads=1, output=None):
+    """
+    Run DMRG jobs in worker processes.
+
+    Args:
+        jobs : list((str, str))
+            FCIDUMP and block input file of each job. Of the input, the keywords
+            orbitals, prefix and num_thrds are set by the batch.
+        scratch : str
+            The scratch directory of job ``i`` is ``scratch/job<i>``, with
+            its input ``dmrg.conf`` and the output of block ``dmrg.out``.
+        n_workers : int or None
+            Number of worker processes. If None, the cores are divided by ``n_threads``.
+        n_threads : int
+            OpenMP threads of each job.
+        output : str or None
+            If not None, each result is appended as one line of JSON to this file when
+            its job finishes.
+
+    Yields:
+        result : dict
+            Results in the order the jobs finish, with the job index ``job``, ``input``,
+            ``fcidump``, ``output``, the ``time`` in seconds and either the ``energies``
+            of the roots or the ``error``.
+    """
+    if n_workers is None:
+        n_workers = max(1, (os.cpu_count() or 1) // n_threads)
+    ctx = multiprocessing.get_context('spawn')
+    f = open(output, 'a') if output is not None else None
+    try:
+        with concurrent.futures.ProcessPoolExecutor(max_workers=n_workers, mp_context=ctx,
+                                                    initializer=_init_worker) as ex:
+            futs = [ex.submit(_run_job, i, inp, fcidump, os.path.join(scratch, 'job%d' % i), n_threads)
+                    for i, (fcidump, inp) in enumerate(jobs)]
+            for fut in concurrent.futures.as_completed(futs):
+                result = fut.result()
+                if f is not None:
+                    f.write(json.dumps(result) + '\n')
+                    f.flush()
+                yield result
+    finally:
+        if f is not None:
+            f.close()
@@ -0,0 +1,60 @@
+#
+#    pyblock: Spin-adapted quantum chemistry DMRG in MPO language (based on Block C++ code)
+#    Copyright (C) 2019-2020 Huanchen Zhai
+#
+#    Block 1.5.3: density matrix renormalization group (DMRG) algorithm for quantum chemistry
+#    Developed by Sandeep Sharma and Garnet K.-L. Chan, 2012
+#    Copyright (C) 2012 Garnet K.-L. Chan
+#
+#    This program is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License as published by
+#    the Free Software Foundation, either version 3 of the License, or
+#    (at your option) any later version.
+#
+#    This program is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+"""
+Performance report of a completed block run.
+
+With the ``profile`` keyword a run leaves ``profile.rank<n>.json`` and ``metrics.rank<n>.json``
+in its save prefix. The report sums the call trees of all threads and ranks by phase, lists the
+sweep positions, writes the folded stacks of a flame graph and ranks what became slower than a
+baseline run.
+
+    python -m pyblock.legacy.report <prefix> [--baseline <prefix>] [--flame-graph <file>]
+"""
+
+import argparse
+import sys
+
+
+def performance_report(prefix, baseline=None, flame_graph=None, top=10):
+    """Return the report of the run in ``prefix`` as text, against the run in ``baseline``
+    if given, and write its folded stacks to ``flame_graph`` if given."""
+    from block import report
+    run = report.read(prefix)
+    if flame_graph is not None:
+        run.flame_graph(flame_graph)
+    base = report.read(baseline) if baseline is not None else None
+    return run.format(base, top)
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.strip().split('\n')[0])
+    parser.add_argument('prefix', help='save prefix of the profiled run')
+    parser.add_argument('--baseline', help='save prefix of a profiled baseline run')
+    parser.add_argument('--flame-graph', help='file for the folded stacks (flamegraph.pl)')
+    parser.add_argument('--top', type=int, default=10, help='number of regressions listed')
+    args = parser.parse_args(argv)
+    print(performance_report(args.prefix, args.baseline, args.flame_graph, args.top))
+
+
+if __name__ == '__main__':
+    sys.exit(main())
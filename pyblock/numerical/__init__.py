@@ -3,6 +3,6 @@
 Numerical algorithms
 """
 
-from .davidson import davidson
-from .expo import expo
+from .davidson import davidson, block_davidson
+from .expo import expo, KrylovExpo
 
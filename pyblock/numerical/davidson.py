@@ -94,6 +94,15 @@ class Vector:
     def ref(self):
         return self.data
     
+    @property
+    def view(self):
+        """numpy.ndarray view of the data (without factor)."""
+        return self.data
+    
+    def same_layout(self, other):
+        """Whether the two vectors can be handled as plain arrays of the same length."""
+        return self.data.shape == other.data.shape
+    
     def __repr__(self):
         return repr(self.factor) + " * " + repr(self.data)
 
@@ -121,6 +130,21 @@ class Matrix:
         """
         result.data = np.dot(self.data, other.data)
         result.factor = other.factor
+    
+    def apply_batch(self, others, results):
+        """
+        Perform :math:`\\hat{H}|\\psi_i\\rangle` for several vectors in one call.
+        
+        Args:
+            others : list(Vector)
+                Input vectors.
+            results : list(Vector)
+                Output vectors.
+        """
+        x = np.dot(np.array([o.factor * o.data for o in others]), self.data.T)
+        for r, ix in zip(results, x):
+            r.data = ix
+            r.factor = 1.0
 
 def olsen_precondition(q, c, ld, diag):
     """Olsen precondition."""
@@ -286,3 +310,171 @@ def davidson(a, b, k, max_iter=500, conv_thold=5e-6, deflation_min_size=2, defla
         sigma[i].deallocate()
     
     return ld[:ck], b[:ck], xiter
+
+def _apply_rows(a, rows, bw, sw):
+    """Apply the matrix to the rows of a numpy array, through the work vectors."""
+    n = len(rows)
+    for i in range(n):
+        np.copyto(bw[i].view, rows[i])
+        bw[i].factor = 1.0
+    if hasattr(a, 'apply_batch'):
+        a.apply_batch(bw[:n], sw[:n])
+    else:
+        for i in range(n):
+            a.apply(bw[i], sw[i])
+    return np.array([sw[i].factor * sw[i].view for i in range(n)])
+
+# B. Liu, Numerical Algorithms in Chemistry: Algebraic Methods, 49-53 (1978).
+def block_davidson(a, b, k, max_iter=500, conv_thold=5e-6, deflation_min_size=2, deflation_max_size=30,
+                   iprint=False, mpi=False):
+    """
+    Block Davidson diagonalization.
+    
+    All unconverged roots get a correction vector in every iteration, and
+    the new vectors are multiplied by the matrix in one ``a.apply_batch``
+    (one pass over the operators for :class:`BlockMultiplyH`) if ``a`` has it.
+    The sub-space and the products are kept as rows of numpy arrays, so that
+    the sub-space matrix, the Ritz vectors and the orthogonalization are
+    single matrix products. All vectors must have the same layout
+    (``same_layout``), which is the case for the roots of one target quanta.
+    
+    Args:
+        a : Matrix
+            The matrix to diagonalize.
+        b : list(Vector)
+            The initial guesses for eigenvectors.
+    
+    Kwargs:
+        max_iter : int
+            Maximal number of davidson iteration.
+        conv_thold : float
+            Convergence threshold for squared norm of eigenvector.
+        deflation_min_size : int
+            Sub-space size after deflation.
+        deflation_max_size : int
+            Maximal sub-space size before deflation.
+        iprint : bool
+            Indicate whether davidson iteration information should be printed.
+    
+    Returns:
+        ld : list(float)
+            List of eigenvalues.
+        b : list(Vector)
+            List of eigenvectors.
+    """
+    
+    if mpi:
+        from mpi4py import MPI
+        rank = MPI.COMM_WORLD.Get_rank()
+        comm = MPI.COMM_WORLD
+    else:
+        rank = 0
+    
+    if iprint and rank == 0:
+        print("")
+    
+    assert len(b) == k
+    for ib in b[1:]:
+        assert b[0].same_layout(ib)
+    if deflation_min_size < k:
+        deflation_min_size = k
+    if deflation_max_size < deflation_min_size + k:
+        deflation_max_size = deflation_min_size + k
+    aa = a.diag()
+    n = len(b[0].view)
+    
+    # sub-space vectors and their products, as rows
+    bs = np.zeros((deflation_max_size, n))
+    ss = np.zeros((deflation_max_size, n))
+    for i in range(k):
+        bs[i] = b[i].factor * b[i].view
+    if rank == 0:
+        bs[:k] = np.linalg.qr(bs[:k].T)[0].T
+    if mpi:
+        comm.Bcast(bs[:k], root=0)
+    
+    bw = [b[0].clear_copy() for _ in range(k)]
+    sw = [b[0].clear_copy() for _ in range(k)]
+    q = b[0].clear_copy()
+    c = b[0].clear_copy()
+    m = 0
+    nnew = k
+    xiter = 0
+    while xiter < max_iter:
+        xiter += 1
+        if nnew != 0:
+            ss[m:m + nnew] = _apply_rows(a, bs[m:m + nnew], bw, sw)
+            m += nnew
+        # [m, nnew, converged]
+        state = np.zeros((3, ), dtype=int)
+        if rank == 0:
+            atilde = np.dot(bs[:m], ss[:m].T)
+            atilde = (atilde + atilde.T) / 2
+            ld, alpha = np.linalg.eigh(atilde)
+            # Ritz vectors and residuals of the k lowest roots
+            xs = np.dot(alpha[:, :k].T, bs[:m])
+            axs = np.dot(alpha[:, :k].T, ss[:m])
+            rs = axs - ld[:k, None] * xs
+            qq = np.einsum('ij,ij->i', rs, rs)
+            ck = np.sum(np.cumprod(qq < conv_thold))
+            if iprint:
+                print("%5d %5d %5d %15.8f %9.2e" % (xiter, m, ck, ld[min(ck, k - 1)], np.max(qq)))
+            if ck == k:
+                state[:] = [m, 0, 1]
+            else:
+                # precondition
+                qs = []
+                for i in range(k):
+                    if qq[i] >= conv_thold:
+                        np.copyto(q.view, rs[i])
+                        np.copyto(c.view, xs[i])
+                        q.factor = c.factor = 1.0
+                        olsen_precondition(q, c, ld[i], aa)
+                        qs.append(q.factor * q.view)
+                qs = np.array(qs)
+                if m + len(qs) > deflation_max_size:
+                    mm = deflation_min_size
+                    bs[:mm] = np.dot(alpha[:, :mm].T, bs[:m])
+                    ss[:mm] = np.dot(alpha[:, :mm].T, ss[:m])
+                    m = mm
+                # orthogonalize twice against the sub-space, then among the new vectors
+                for _ in range(2):
+                    qs -= np.dot(np.dot(qs, bs[:m].T), bs[:m])
+                nnew = 0
+                for iq in qs:
+                    iq -= np.dot(np.dot(bs[m:m + nnew], iq), bs[m:m + nnew])
+                    nq = np.linalg.norm(iq)
+                    if nq > 1E-8:
+                        bs[m + nnew] = iq / nq
+                        nnew += 1
+                state[:] = [m, nnew, 0]
+        if mpi:
+            comm.Bcast(state, root=0)
+        m, nnew = state[0], state[1]
+        if state[2] == 1:
+            break
+        if mpi:
+            comm.Bcast(bs[:m + nnew], root=0)
+            comm.Bcast(ss[:m], root=0)
+        
+        if xiter == max_iter:
+            raise DavidsonError("Only %d converged!" % ck if rank == 0 else "Not converged!")
+    
+    if rank != 0:
+        ld = np.zeros((k, ))
+        xs = np.zeros((k, n))
+    if mpi:
+        comm.Bcast(ld[:k], root=0)
+        comm.Bcast(xs, root=0)
+    for i in range(k):
+        np.copyto(b[i].view, xs[i])
+        b[i].factor = 1.0
+    
+    c.deallocate()
+    q.deallocate()
+    for i in range(k - 1, -1, -1):
+        sw[i].deallocate()
+    for i in range(k - 1, -1, -1):
+        bw[i].deallocate()
+    
+    return ld[:k], b[:k], xiter
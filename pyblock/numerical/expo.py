@@ -1,6 +1,9 @@
 
 import numpy as np
-from expokitpy import dsexpv
+try:
+    from expokitpy import dsexpv
+except ImportError:
+    dsexpv = None
 import os
 import sys
 from contextlib import contextmanager
@@ -65,3 +68,114 @@ def expo(a, b, beta, const_a=0.0, expo_tol=0, deflation_max_size=20):
     b.ref[:] = u[:]
     return b, nexpo
 
+
+class KrylovExpo:
+    """
+    Lanczos approximation of exp(-beta (a + const_a)) b with adaptive size.
+    
+    The Lanczos basis grows until the a posteriori error estimate
+    ``|b| beta_{m+1} |e_m^T exp(-beta T_m) e_1|`` is below ``tol`` |b|, up to ``max_size``
+    vectors. If that is not enough, beta is split into sub-steps, each starting a new basis.
+    The effective Hamiltonian changes at every site, so the basis itself can not be
+    reused from one call to the next; the length of the last accepted sub-step is kept
+    instead (for each beta), so that repeated calls start with a step that converges.
+    
+    Args:
+        tol : float
+            Target error of the result, relative to the norm of b.
+        max_size : int
+            Maximal number of Lanczos vectors.
+    """
+    def __init__(self, tol=1E-12, max_size=40):
+        self.tol = tol
+        self.max_size = max_size
+        self.step_hints = {}
+    
+    def __call__(self, a, b, beta, const_a=0.0):
+        """
+        Calculate exp(-beta (a + const_a)) b.
+        
+        Args:
+            a : object with ``apply(x, y)``
+                Symmetric operator, for example :class:`BlockMultiplyH`.
+            b : BlockWavefunction
+                Initial vector, overwritten by the result.
+            beta : float
+                Time step.
+            const_a : float
+                Constant added to a.
+        
+        Returns:
+            b : BlockWavefunction
+                The result.
+            nexpo : int
+                Number of applications of a.
+        """
+        n = b.ref.size
+        tmpa = b.clear_copy()
+        tmpb = b.clear_copy()
+        
+        icnt = [0]
+        def adot(x):
+            icnt[0] += 1
+            tmpa.ref[:] = x[:]
+            tmpb.ref[:] = 0.0
+            a.apply(tmpa, tmpb)
+            y = np.array(tmpb.ref.copy())
+            if const_a == 0.0:
+                return y
+            else:
+                return y + const_a * x
+        
+        def small_expo(alpha, betas, tau):
+            tmat = np.diag(alpha) + np.diag(betas[:-1], 1) + np.diag(betas[:-1], -1)
+            lam, u = np.linalg.eigh(tmat)
+            return u @ (np.exp(-beta * tau * lam) * u[0, :])
+        
+        v = np.array(b.ref, dtype=float)
+        left = 1.0
+        step = self.step_hints.get(beta, 1.0)
+        m_max = min(self.max_size, n)
+        while left > 1E-14:
+            vnorm = np.linalg.norm(v)
+            if vnorm == 0.0:
+                break
+            tau = min(step, left)
+            q = [v / vnorm]
+            alpha, betas = [], []
+            converged = False
+            for j in range(m_max):
+                w = adot(q[j])
+                alpha.append(np.dot(q[j], w))
+                # full reorthogonalization, cheap compared to adot
+                for qk in q:
+                    w -= np.dot(qk, w) * qk
+                betas.append(np.linalg.norm(w))
+                if betas[-1] < 1E-14 * max(1.0, abs(alpha[-1])):
+                    # invariant subspace, exact for any time
+                    tau = left
+                    y = small_expo(alpha, betas, tau)
+                    converged = True
+                    break
+                y = small_expo(alpha, betas, tau)
+                if vnorm * betas[-1] * abs(y[-1]) < self.tol * vnorm:
+                    converged = True
+                    break
+                if j != m_max - 1:
+                    q.append(w / betas[-1])
+            if not converged:
+                # shorten the step until the full basis is accurate enough
+                while tau > 1E-8 and vnorm * betas[-1] * abs(y[-1]) >= self.tol * vnorm:
+                    tau /= 2
+                    y = small_expo(alpha, betas, tau)
+            v = vnorm * (np.array(q[:len(y)]).T @ y)
+            left -= tau
+            step = tau * 2 if converged and len(y) < m_max // 2 else tau
+        self.step_hints[beta] = min(step, 1.0)
+        
+        tmpb.deallocate()
+        tmpa.deallocate()
+        
+        b.ref[:] = v[:]
+        return b, icnt[0]
+
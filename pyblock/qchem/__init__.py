@@ -10,4 +10,4 @@ from .mpo import LocalMPOInfo, LocalMPO, SquareMPOInfo, SquareMPO
 from .mps import MPSInfo, MPS, LineCoupling
 from .core import BlockHamiltonian
 from .simplifier import AllRules, NoTransposeRules, PDM1Rules, Simplifier
-from .parallelizer import ParaRule, Parallelizer
+from .parallelizer import ParaRule, CostParaRule, Parallelizer
@@ -21,6 +21,7 @@ class Ancilla:
         x.n_sites *= 2
         if isinstance(x, MPOInfo):
             Ancilla._init_ancilla_operator_names(x, npdm=self.npdm)
+            x.identity_sites = set(range(1, x.n_sites, 2))
         elif isinstance(x, MPO):
             Ancilla._init_ancilla_mpo_tensors(x)
         return x
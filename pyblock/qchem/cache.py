@@ -0,0 +1,109 @@
+#
+#    pyblock: Spin-adapted quantum chemistry DMRG in MPO language (based on Block C++ code)
+#    Copyright (C) 2019-2020 Huanchen Zhai
+#
+#    Block 1.5.3: density matrix renormalization group (DMRG) algorithm for quantum chemistry
+#    Developed by Sandeep Sharma and Garnet K.-L. Chan, 2012
+#    Copyright (C) 2012 Garnet K.-L. Chan
+#
+#    This program is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License as published by
+#    the Free Software Foundation, either version 3 of the License, or
+#    (at your option) any later version.
+#
+#    This program is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+"""
+Persistent cache of symbolic MPO construction and simplified expressions.
+
+Every entry is one pickle file ``<name>.<key>.pkl`` in the cache directory,
+holding the format version, the full key and the cached object. The key is
+a hash of everything the symbolic objects depend on: integrals, symmetry and
+site ordering of the Hamiltonian, and the extra parts given by the caller
+(class name, simplification rules, MPI rank). Files with a different version
+or key are ignored, so a stale cache is never used.
+"""
+
+import hashlib
+import os
+import pickle
+
+CACHE_VERSION = 2
+
+
+def cache_key(*parts):
+    """Return hex digest of a sequence of str/bytes parts."""
+    h = hashlib.sha1()
+    for p in parts:
+        p = p if isinstance(p, bytes) else repr(p).encode()
+        h.update(len(p).to_bytes(8, 'little'))
+        h.update(p)
+    return h.hexdigest()
+
+
+def hamiltonian_key(hamil, *extra):
+    """
+    Return cache key for symbolic objects built from a Hamiltonian.
+
+    Args:
+        hamil : BlockHamiltonian
+            The Hamiltonian. The integrals are hashed in the site order used by the MPO.
+        extra : tuple
+            Extra parts of the key.
+
+    Returns:
+        key : str or None
+            None if the integrals are not available (Hamiltonian read from an input file),
+            in which case nothing should be cached.
+    """
+    if hasattr(hamil, 't'):
+        names = ['t', 'v']
+    else:
+        names = ['ta', 'tb', 'vaa', 'vab', 'vba', 'vbb']
+    ints = [getattr(hamil, name, None) for name in names]
+    if any(x is None for x in ints):
+        return None
+    parts = [CACHE_VERSION, hamil.n_sites, hamil.spin_adapted, hamil.point_group,
+             list(hamil.spatial_syms), hamil.n_electrons, hamil.target_s,
+             hamil.target_spatial_sym]
+    for x in ints:
+        parts += [x.__class__.__name__, x.n, x.data.tobytes()]
+    return cache_key(*parts, *extra)
+
+
+def _cache_file(cache_dir, name, key):
+    return os.path.join(cache_dir, '%s.%s.pkl' % (name, key[:24]))
+
+
+def load_cache(cache_dir, name, key):
+    """Return the object cached under name and key, or None if there is no valid entry."""
+    if cache_dir is None or key is None:
+        return None
+    try:
+        with open(_cache_file(cache_dir, name, key), 'rb') as f:
+            version, fkey, obj = pickle.load(f)
+    except (OSError, EOFError, pickle.UnpicklingError, AttributeError, ImportError,
+            TypeError, ValueError):
+        return None
+    if version != CACHE_VERSION or fkey != key:
+        return None
+    return obj
+
+
+def save_cache(cache_dir, name, key, obj):
+    """Write obj under name and key. The file is replaced atomically,
+    so that concurrent or interrupted runs never leave a partial entry."""
+    if cache_dir is None or key is None:
+        return
+    os.makedirs(cache_dir, exist_ok=True)
+    fn = _cache_file(cache_dir, name, key)
+    tmp = '%s.%d.tmp' % (fn, os.getpid())
+    with open(tmp, 'wb') as f:
+        pickle.dump((CACHE_VERSION, key, obj), f, protocol=pickle.HIGHEST_PROTOCOL)
+    os.replace(tmp, fn)
@@ -29,10 +29,12 @@ from block.rev import tensor_scale, tensor_dot_product, tensor_scale_add_no_tran
 from block.rev import tensor_precondition
 from block.data_page import init_data_pages, release_data_pages, activate_data_page
 from block.data_page import load_data_page, save_data_page
+from block.data_page import load_data_page_async, save_data_page_async
+from block.data_page import wait_data_page, set_data_page_cache
 from block.data_page import set_data_page_pointer, get_data_page_pointer
 
 from ..tensor.tensor import Tensor, SubTensor
-from ..numerical import davidson, expo
+from ..numerical import davidson, expo, KrylovExpo
 from .core import BlockHamiltonian, BlockEvaluation, BlockSymmetry
 from .simplifier import NoSimplifier
 import numpy as np
@@ -67,14 +69,35 @@ class DataPage:
         pass
 
 class DMRGDataPage(DataPage):
-    """Determine how to swap data between disk and memory for DMRG calculation."""
-    def __init__(self, save_dir='node0', n_frames=1):
+    """
+    Determine how to swap data between disk and memory for DMRG calculation.
+    
+    Args:
+        save_dir : str
+            Directory of the page files.
+        n_frames : int
+            Number of independent sets of pages, see :meth:`get`.
+        asynchronous : bool
+            If True, pages are saved on a background thread, and the next
+            environment page of the sweep direction is loaded ahead of time.
+        cache_memory : int
+            Number of doubles of recently used page files kept in memory,
+            so that loading them again needs no disk read.
+    """
+    def __init__(self, save_dir='node0', n_frames=1, asynchronous=True, cache_memory=0):
         self.current_pages = {}
         self.main_page = -1
         self.n_pages = 5
         self.save_dir = save_dir
         self.n_frames = n_frames
         self.i_frame = 0
+        self.asynchronous = asynchronous
+        self.cache_memory = cache_memory
+        # page id -> tags of the saved or loaded data still in that page
+        self.resident = {}
+        # pages with a background load in progress
+        self.prefetched = set()
+        self.forward = True
         if not os.path.isdir(self.save_dir):
             os.mkdir(self.save_dir)
     
@@ -103,7 +126,14 @@ class DMRGDataPage(DataPage):
         ip = self._get_page(tags)
         if ip not in self.current_pages:
             self.current_pages[ip] = tags
-            load_data_page(ip, self._get_file_name(self.current_pages[ip]))
+            if self.resident.get(ip, None) == tags:
+                # still in memory, or being prefetched
+                if ip in self.prefetched:
+                    wait_data_page(ip)
+                    self.prefetched.discard(ip)
+            else:
+                load_data_page(ip, self._get_file_name(self.current_pages[ip]))
+                self.resident[ip] = tags
         else:
             assert self.current_pages[ip] == tags
     
@@ -113,6 +143,25 @@ class DMRGDataPage(DataPage):
         if ip in self.current_pages:
             assert self.current_pages[ip] == tags
             del self.current_pages[ip]
+            # the environment block of the next sweep step
+            site = [i for i in tags if isinstance(i, int)]
+            if self.forward and '_RIGHT' in tags:
+                self.prefetch({site[0] + 1, '_RIGHT'})
+            elif not self.forward and '_LEFT' in tags:
+                self.prefetch({site[0] - 1, '_LEFT'})
+    
+    def prefetch(self, tags):
+        """Start loading a data page in the background, if its memory is not in use."""
+        if not self.asynchronous:
+            return
+        ip = self._get_page(tags)
+        if ip in self.current_pages or self.resident.get(ip, None) == tags:
+            return
+        fn = self._get_file_name(tags)
+        if os.path.isfile(fn):
+            load_data_page_async(ip, fn)
+            self.resident[ip] = tags
+            self.prefetched.add(ip)
     
     def activate(self, tags, reset=False):
         """Activate one data page in memory for writing data."""
@@ -122,6 +171,9 @@ class DMRGDataPage(DataPage):
         self.current_pages[ip] = tags
         self.main_page = ip
         activate_data_page(ip)
+        # the page will be changed, it no longer matches its file
+        self.resident.pop(ip, None)
+        self.prefetched.discard(ip)
         if reset:
             set_data_page_pointer(ip, 0)
     
@@ -130,7 +182,18 @@ class DMRGDataPage(DataPage):
         ip = self._get_page(tags)
         if ip in self.current_pages:
             assert self.current_pages[ip] == tags
-            save_data_page(ip, self._get_file_name(self.current_pages[ip]))
+            if '_LEFT' in tags:
+                self.forward = True
+            elif '_RIGHT' in tags:
+                self.forward = False
+            if self.asynchronous:
+                save_data_page_async(ip, self._get_file_name(self.current_pages[ip]))
+                # nothing may be allocated in the page while it is written
+                if ip == self.main_page:
+                    self.activate({'_BASE'})
+            else:
+                save_data_page(ip, self._get_file_name(self.current_pages[ip]))
+            self.resident[ip] = tags
         else:
             assert False
     
@@ -138,7 +201,10 @@ class DMRGDataPage(DataPage):
         """Allocate memory for all pages."""
         if self.i_frame == 0:
             init_data_pages(self.n_pages * self.n_frames)
+            set_data_page_cache(self.cache_memory)
         self.current_pages = {}
+        self.resident = {}
+        self.prefetched = set()
         self.activate({'_BASE'})
     
     def release(self):
@@ -148,6 +214,7 @@ class DMRGDataPage(DataPage):
     
     def clean(self):
         """Delete all temporary files."""
+        wait_data_page(-1)
         shutil.rmtree(self.save_dir)
        
     def __repr__(self):
@@ -180,6 +247,21 @@ class DMRGContractor:
         if parallelizer is not None:
             BlockEvaluation.parallelizer = parallelizer
         self.is_parallel = parallelizer is not None
+        # exp(-beta H) v of expo_apply; pyblock.numerical.expo for the expokit version
+        self.expo = KrylovExpo()
+        self.mpo_info.load_cached_exprs(self._cache_tag())
+    
+    def _cache_tag(self):
+        """Key of cached expressions for the current simplification rules and MPI partition."""
+        simpl, par = BlockEvaluation.simplifier, BlockEvaluation.parallelizer
+        tag = [simpl.__class__.__name__]
+        if hasattr(simpl, 'rule'):
+            tag.append(simpl.rule.__class__.__name__)
+            tag.append(getattr(simpl.rule, 'su2', None))
+        if par is not None:
+            tag += [par.__class__.__name__, par.rule.__class__.__name__, par.rank,
+                    getattr(par.rule, 'size', None), getattr(par.rule, 'cache_tag', None)]
+        return repr(tag)
     
     def pre_sweep(self):
         """Operations performed at the beginning of each DMRG sweep."""
@@ -190,6 +272,7 @@ class DMRGContractor:
         """Operations performed at the end of each DMRG sweep."""
         if self.rebuild:
             BlockHamiltonian.set_current_memory(self.mem_ptr)
+        self.mpo_info.save_cached_exprs(self._cache_tag())
     
     def _tag_site(self, tensor):
         tags = tensor.tags
@@ -233,7 +316,23 @@ class DMRGContractor:
             sts = (st_l, st_r)
         return st_l, st_r, sts
 
-    def expect(self, opt, brat, kett):
+    def expect(self, opt, brat, kett, variance=False):
+        """
+        Expectation value of ``opt`` between the local bra and ket tensors.
+        
+        With ``variance``, the local energy variance of the ket is also returned, without a
+        squared MPO: with :math:`|\\phi\\rangle = \\hat{H}|\\psi\\rangle` from one
+        :meth:`BlockMultiplyH.apply` on the local (two-site or fused one-site) tensor,
+        :math:`\\langle \\hat{H}^2\\rangle` is taken as :math:`\\langle\\phi|\\phi\\rangle`,
+        its projection on the space of the local tensor for the current environments.
+        This needs the bra to be the same state as the ket.
+        
+        Returns:
+            results : dict(OpElement -> float)
+            variance : float
+                :math:`(\\langle \\hat{H}^2\\rangle - \\langle \\hat{H}\\rangle^2)/\\langle\\psi|\\psi\\rangle`,
+                only with ``variance``.
+        """
         
         dot = len(brat.tags - {'_BRA'})
         
@@ -255,6 +354,16 @@ class DMRGContractor:
         
         results = bopt.expect(bkwfn, bbwfn)
         
+        if variance:
+            ket_st = state_tensor_product_target(kst_l, kst_r)
+            hopt = BlockMultiplyH(opt, VectorStateInfo([ket_st, ket_st]), diag=False)
+            bhwfn = bkwfn.clear_copy()
+            hopt.apply(bkwfn, bhwfn)
+            normsq = bkwfn.dot(bkwfn)
+            energy = bkwfn.dot(bhwfn) / normsq
+            var = bhwfn.dot(bhwfn) / normsq - energy ** 2
+            bhwfn.deallocate()
+        
         if dot == 2 or '_FUSE_L' in opt.tags or '_NO_FUSE' in opt.tags:
             self.page.unload({i, '_LEFT'})
             self.page.unload({i + 1, '_RIGHT'})
@@ -265,7 +374,7 @@ class DMRGContractor:
         bkwfn.deallocate()
         bbwfn.deallocate()
         
-        return results
+        return (results, var) if variance else results
     
     def apply(self, opt, mpst):
         
@@ -323,7 +432,7 @@ class DMRGContractor:
         bkwfn = BlockWavefunction(kwfn)
         bbwfn = BlockWavefunction(bwfn)
         assert len(bkwfn.ref) == len(bbwfn.ref)
-        vs, nexpo = expo(bopt, bkwfn, beta, const_a=self.mpo_info.hamil.e)
+        vs, nexpo = self.expo(bopt, bkwfn, beta, const_a=self.mpo_info.hamil.e)
 
         bopt.apply(vs, bbwfn)
         normsq = vs.dot(vs)
@@ -646,9 +755,24 @@ class BlockWavefunction:
     
     def __iadd__(self, other):
         assert self.factor == 1.0
-        tensor_scale_add_no_trans(other.factor, other.data, self.data)
+        if self.same_layout(other):
+            self.view += other.factor * other.view
+        else:
+            tensor_scale_add_no_trans(other.factor, other.data, self.data)
         return self
     
+    @property
+    def view(self):
+        """numpy.ndarray view of the whole data region (without factor)."""
+        return np.asarray(self.data)
+    
+    def same_layout(self, other):
+        """Whether the two wavefunctions have the same non zero blocks at the same offsets,
+        so that they can be handled as plain vectors."""
+        return self.data.total_memory == other.data.total_memory \
+            and np.array_equal(self.data.block_offsets, other.data.block_offsets) \
+            and np.array_equal(self.data.block_shapes, other.data.block_shapes)
+    
     def copy(self):
         """Return a deep copy of this object."""
         mat = self.data.__class__()
@@ -664,11 +788,16 @@ class BlockWavefunction:
     def copy_data(self, other):
         """Fill the matrix elements in this object with data
         from another :class:`BlockWavefunction` object."""
-        self.data.copy_data(other.data)
+        if self.same_layout(other):
+            np.copyto(self.view, other.view)
+        else:
+            self.data.copy_data(other.data)
         self.factor = other.factor
     
     def dot(self, other):
         """Return dot product of two :class:`BlockWavefunction`."""
+        if self.same_layout(other):
+            return np.dot(self.view, other.view) * self.factor * other.factor
         return tensor_dot_product(self.data, other.data) * self.factor * other.factor
     
     def precondition(self, ld, diag):
@@ -713,10 +842,14 @@ class BlockMultiplyH:
             StateInfo of super block.
         diag_mat : DiagonalMatrix
             Diagonal elements of super block Hamiltonian, in flatten form with no quantum labels.
+        plans : dict
+            Contraction plans of operator pairs, built in the first :meth:`apply`
+            and reused in later Davidson iterations.
     """
     def __init__(self, opt, sts, diag=True):
         self.opt = opt
         self.sts = sts
+        self.plans = {}
         if diag:
             self.diag_mat = BlockEvaluation.expr_diagonal_eval(opt.mat[0, 0], opt.ops[0], opt.ops[1], sts)
         else:
@@ -752,4 +885,23 @@ class BlockMultiplyH:
         result.data.clear()
         result.factor = 1.0
         BlockEvaluation.expr_multiply_eval(self.opt.mat[0, 0], self.opt.ops[0], self.opt.ops[1],
-            other.data, result.data, self.sts)
+            other.data, result.data, self.sts, self.plans)
+    
+    def apply_batch(self, others, results):
+        """
+        Perform :math:`\\hat{H}|\\psi_i\\rangle` for several vectors of the same quanta,
+        using every operator pair once for all of them.
+        
+        Args:
+            others : list(BlockWavefunction)
+                Input vectors/wavefunctions.
+            results : list(BlockWavefunction)
+                Output vectors/wavefunctions.
+        """
+        assert len(others) == len(results)
+        for result in results:
+            assert isinstance(result, BlockWavefunction)
+            result.data.clear()
+            result.factor = 1.0
+        BlockEvaluation.expr_multiply_eval(self.opt.mat[0, 0], self.opt.ops[0], self.opt.ops[1],
+            [x.data for x in others], [x.data for x in results], self.sts, self.plans)
@@ -37,14 +37,17 @@ from block.block import Block, VectorBlock
 from block.rev import tensor_scale, tensor_trace, tensor_rotate, tensor_product
 from block.rev import tensor_trace_diagonal, tensor_product_diagonal
 from block.rev import tensor_trace_multiply, tensor_product_multiply, product
+from block.rev import tensor_trace_multiply_batch
+from block.rev import TensorProductMultiplyPlan
 from block.rev import tensor_scale_add_no_trans, tensor_dot_product
+from block.rev import tensor_product_batch
 
 from ..symmetry.symmetry import ParticleN, SU2, SZ, PointGroup, point_group
 from ..symmetry.symmetry import DirectProdGroup
 from .operator import OpElement, OpNames, OpString, OpSum
 from .mpo import OperatorTensor, DualOperatorTensor
 from .simplifier import NoSimplifier, OpCollection, OpShell
-from .fcidump import read_fcidump
+from .fcidump import read_fcidump, VInt
 from fractions import Fraction
 import contextlib
 import numpy as np
@@ -205,6 +208,18 @@ class BlockEvaluation:
             sts = VectorStateInfo([mps_info.left_state_info_no_trunc[i]])
         else:
             sts = VectorStateInfo([bra_mps_info.left_state_info_no_trunc[i], mps_info.left_state_info_no_trunc[i]])
+        if i in mpo_info.identity_sites:
+            # the left block is only expanded by the basis of the dot
+            i_op = OpElement(OpNames.I, ())
+            zipped = [(abs(op), OpString([abs(op), i_op])) for op in op_names if abs(op) in optl.ops]
+            new_ops = {}
+            self.expr_eval_batch(zipped, optl.ops, optd.ops, sts, new_ops)
+            if isinstance(optd, OperatorTensor):
+                return OperatorTensor(mat=op_names.reshape((1, -1)), ops=new_ops,
+                                      tags=optd.tags, contractor=optd.contractor)
+            else:
+                return DualOperatorTensor(lmat=op_names.reshape((1, -1)), ops=new_ops,
+                                          tags=optd.tags, contractor=optd.contractor)
         exprs = mpo_info.cached_exprs.get((i, '_LEFT'), None)
         if exprs is None:
             if isinstance(optd, OperatorTensor):
@@ -219,8 +234,7 @@ class BlockEvaluation:
             if mpo_info.cache_contraction:
                 mpo_info.cached_exprs[(i, '_LEFT')] = exprs
         with exprs() as (zipped, new_ops):
-            for op, expr in zipped:
-                new_ops[op] = self.expr_eval(expr, optl.ops, optd.ops, sts, op.q_label)
+            self.expr_eval_batch(zipped, optl.ops, optd.ops, sts, new_ops)
         if isinstance(optd, OperatorTensor):
             return OperatorTensor(mat=op_names.reshape((1, -1)),
                                   ops=new_ops, tags=optd.tags,
@@ -259,6 +273,18 @@ class BlockEvaluation:
             sts = VectorStateInfo([mps_info.right_state_info_no_trunc[i]])
         else:
             sts = VectorStateInfo([bra_mps_info.right_state_info_no_trunc[i], mps_info.right_state_info_no_trunc[i]])
+        if i in mpo_info.identity_sites and i != mpo_info.n_sites - 1:
+            # the right block is only expanded by the basis of the dot
+            i_op = OpElement(OpNames.I, ())
+            zipped = [(abs(op), OpString([i_op, abs(op)])) for op in op_names if abs(op) in optr.ops]
+            new_ops = {}
+            self.expr_eval_batch(zipped, optd.ops, optr.ops, sts, new_ops)
+            if isinstance(optd, OperatorTensor):
+                return OperatorTensor(mat=op_names.reshape((-1, 1)), ops=new_ops,
+                                      tags=optd.tags, contractor=optd.contractor)
+            else:
+                return DualOperatorTensor(rmat=op_names.reshape((-1, 1)), ops=new_ops,
+                                          tags=optd.tags, contractor=optd.contractor)
         exprs = mpo_info.cached_exprs.get((i, '_RIGHT'), None)
         if exprs is None:
             if isinstance(optd, OperatorTensor):
@@ -273,8 +299,7 @@ class BlockEvaluation:
             if mpo_info.cache_contraction:
                 mpo_info.cached_exprs[(i, '_RIGHT')] = exprs
         with exprs() as (zipped, new_ops):
-            for op, expr in zipped:
-                new_ops[op] = self.expr_eval(expr, optd.ops, optr.ops, sts, op.q_label)
+            self.expr_eval_batch(zipped, optd.ops, optr.ops, sts, new_ops)
         if isinstance(optd, OperatorTensor):
             return OperatorTensor(mat=op_names.reshape((-1, 1)),
                                   ops=new_ops, tags=optd.tags,
@@ -373,7 +398,7 @@ class BlockEvaluation:
             assert False
     
     @classmethod
-    def expr_multiply_eval(self, expr, a, b, c, nwave, sts):
+    def expr_multiply_eval(self, expr, a, b, c, nwave, sts, plans=None):
         """
         Evaluate the result of a symbolic operator expression applied on a wavefunction.
         
@@ -384,33 +409,54 @@ class BlockEvaluation:
                 A map from operator symbol in left block to its matrix representation.
             b : dict(OpElement -> StackSparseMatrix)
                 A map from operator symbol in right block to its matrix representation.
-            c : Wavefunction
-                The input wavefuction.
-            nwave : Wavefunction
-                The output wavefuction.
+            c : Wavefunction or list(Wavefunction)
+                The input wavefuction, or several of the same quanta, which are then
+                all multiplied in one pass over the operator blocks.
+            nwave : Wavefunction or list(Wavefunction)
+                The output wavefuction(s), as many as ``c``.
             sts : VectorStateInfo
                 StateInfo in which the wavefuction is represented.
+            plans : None or dict((OpElement, OpElement) -> TensorProductMultiplyPlan)
+                If not None, contraction plans of operator pairs are cached here and reused
+                in later calls. Only valid when ``a``, ``b`` and the quantum numbers of
+                ``c`` and ``nwave`` are the same in all calls sharing ``plans``.
         """
         if isinstance(expr, OpString):
             assert len(expr.ops) == 2
             if a[expr.ops[0]] == 0 or b[expr.ops[1]] == 0:
                 return
             factor = float(expr.factor) * a[expr.ops[0]].symm_scale * b[expr.ops[1]].symm_scale
+            batch = isinstance(c, list)
+            trace = tensor_trace_multiply_batch if batch else tensor_trace_multiply
             if expr.ops[0] == OpElement(OpNames.I, ()) and len(sts) == 1:
-                tensor_trace_multiply(b[expr.ops[1]], c, nwave, sts[0], False, factor)
+                trace(b[expr.ops[1]], c, nwave, sts[0], False, factor)
             elif expr.ops[1] == OpElement(OpNames.I, ()) and len(sts) == 1:
-                tensor_trace_multiply(a[expr.ops[0]], c, nwave, sts[0], True, factor)
+                trace(a[expr.ops[0]], c, nwave, sts[0], True, factor)
             else:
                 aq, bq = a[expr.ops[0]].delta_quantum[0], b[expr.ops[1]].delta_quantum[0]
                 op_q = (aq + bq)[0]
-                tensor_product_multiply(a[expr.ops[0]], b[expr.ops[1]], c, nwave, sts, op_q, factor)
+                if plans is None and not batch:
+                    tensor_product_multiply(a[expr.ops[0]], b[expr.ops[1]], c, nwave, sts, op_q, factor)
+                else:
+                    key = (expr.ops[0], expr.ops[1])
+                    plan = plans.get(key, None) if plans is not None else None
+                    if plan is None:
+                        plan = TensorProductMultiplyPlan(a[expr.ops[0]], b[expr.ops[1]],
+                                                         c[0] if batch else c,
+                                                         nwave[0] if batch else nwave, sts, op_q)
+                        if plans is not None:
+                            plans[key] = plan
+                    if batch:
+                        plan.multiply_batch(a[expr.ops[0]], b[expr.ops[1]], c, nwave, factor)
+                    else:
+                        plan.multiply(a[expr.ops[0]], b[expr.ops[1]], c, nwave, factor)
         elif isinstance(expr, OpCollection):
             with expr() as (zipped, new_ops):
                 (op, expr), = zipped
                 assert op == OpElement(OpNames.H, ())
                 if expr != 0:
                     for x in expr.strings if isinstance(expr, OpSum) else [expr]:
-                        self.expr_multiply_eval(x, a, b, c, nwave, sts)
+                        self.expr_multiply_eval(x, a, b, c, nwave, sts, plans)
                 new_ops[op] = nwave
         else:
             assert False
@@ -490,6 +536,67 @@ class BlockEvaluation:
             nmat.initialized = True
             return nmat
     
+    @classmethod
+    def expr_eval_batch(self, zipped, a, b, sts, new_ops):
+        """
+        Evaluate a list of symbolic operator expressions, with the same result as
+        calling :meth:`expr_eval` for each of them. The result matrices are allocated
+        here in order, then all products are done in one native call with the
+        result operators in parallel.
+        
+        Args:
+            zipped : list((OpElement, OpString or OpSum or OpShell))
+                Result operator symbols and the expressions to evaluate.
+            a : dict(OpElement -> StackSparseMatrix)
+                A map from operator symbol in left block to its matrix representation.
+            b : dict(OpElement -> StackSparseMatrix)
+                A map from operator symbol in right block to its matrix representation.
+            sts : VectorStateInfo
+                StateInfo in which the result of the operator expressions is represented.
+            new_ops : dict(OpElement -> StackSparseMatrix)
+                The results are stored here.
+        """
+        i_op = OpElement(OpNames.I, ())
+        mats, terms = [], []
+        for op, expr in zipped:
+            if isinstance(expr, OpShell):
+                new_ops[op] = self.expr_eval(expr, a, b, sts, op.q_label)
+                continue
+            elif isinstance(expr, OpString):
+                strings = [expr]
+            elif expr == 0:
+                new_ops[op] = 0
+                continue
+            else:
+                assert isinstance(expr, OpSum)
+                strings = expr.strings
+            nmat = 0
+            op_terms = []
+            for x in strings:
+                assert len(x.ops) == 2
+                ma, mb = a[x.ops[0]], b[x.ops[1]]
+                if ma == 0 or mb == 0:
+                    continue
+                if nmat == 0:
+                    nmat = StackSparseMatrix()
+                    cq = BlockSymmetry.to_spin_quantum(op.q_label)
+                    nmat.delta_quantum = VectorSpinQuantum([cq])
+                    nmat.fermion = ma.fermion ^ mb.fermion
+                    nmat.allocate(sts)
+                    nmat.initialized = True
+                factor = float(x.factor) * ma.symm_scale * mb.symm_scale
+                if x.ops[0] == i_op and len(sts) == 1:
+                    op_terms.append((None, mb, factor))
+                elif x.ops[1] == i_op and len(sts) == 1:
+                    op_terms.append((ma, None, factor))
+                else:
+                    op_terms.append((ma, mb, factor))
+            new_ops[op] = nmat
+            if nmat != 0:
+                mats.append(nmat)
+                terms.append(op_terms)
+        tensor_product_batch(mats, terms, sts)
+    
     @classmethod
     def eigen_values(self, mat):
         """Return all eigenvalues of a StackSparseMatrix."""
@@ -776,6 +883,14 @@ class BlockHamiltonian:
                 
                 return ops
             
+            # integrals coupling site m to the other sites, gathered at once
+            sites = np.arange(self.n_sites)
+            t_im = self.t.gather(sites, m)
+            v_immm = self.v.gather(sites, m, m, m)
+            v_imkm = self.v.gather(sites[:, None], m, sites[None, :], m)
+            v_ijmm = self.v.gather(sites[:, None], sites[None, :], m, m)
+            v_immj = self.v.gather(sites[:, None], m, m, sites[None, :])
+            
             mat = StackSparseMatrix()
             mat.fermion = False
             mat.delta_quantum = VectorSpinQuantum([BlockSymmetry.to_spin_quantum(self.empty)])
@@ -838,7 +953,7 @@ class BlockHamiltonian:
                 if i == m:
                     continue
                 
-                if np.isclose(self.t[i, m], 0) and np.isclose(self.v[i, m, m, m], 0):
+                if np.isclose(t_im[i], 0) and np.isclose(v_immm[i], 0):
                     
                     if OpElement(OpNames.R, (i, )) in op_set:
                         ops[OpElement(OpNames.R, (i, ))] = 0
@@ -853,14 +968,14 @@ class BlockHamiltonian:
                         mat = StackSparseMatrix()
                         mat.deep_copy(ops[OpElement(OpNames.D, (m, ))])
                         assert mat.fermion
-                        tensor_scale(self.t[i, m] * np.sqrt(2) * 0.25, mat)
+                        tensor_scale(t_im[i] * np.sqrt(2) * 0.25, mat)
                         mat.delta_quantum = VectorSpinQuantum([BlockSymmetry.to_spin_quantum(-self.one_site_q[m])])
 
                         mat2 = StackSparseMatrix()
                         mat2.deep_clear_copy(ops[OpElement(OpNames.D, (m, ))])
                         product(ops[OpElement(OpNames.B, (m, m, 0))], ops[OpElement(OpNames.D, (m, ))],
                                 mat2, self.site_state_info[m][0], 1.0)
-                        tensor_scale_add_no_trans(self.v[i, m, m, m], mat2, mat)
+                        tensor_scale_add_no_trans(v_immm[i], mat2, mat)
                         mat2.deallocate()
                         ops[OpElement(OpNames.R, (i, ))] = mat
                     
@@ -869,19 +984,19 @@ class BlockHamiltonian:
                         mat = StackSparseMatrix()
                         mat.deep_copy(ops[OpElement(OpNames.C, (m, ))])
                         assert mat.fermion
-                        tensor_scale(self.t[i, m] * np.sqrt(2) * 0.25, mat)
+                        tensor_scale(t_im[i] * np.sqrt(2) * 0.25, mat)
                         mat.delta_quantum = VectorSpinQuantum([BlockSymmetry.to_spin_quantum(self.one_site_q[m])])
 
                         mat2 = StackSparseMatrix()
                         mat2.deep_clear_copy(ops[OpElement(OpNames.C, (m, ))])
                         product(ops[OpElement(OpNames.C, (m, ))], ops[OpElement(OpNames.B, (m, m, 0))],
                                 mat2, self.site_state_info[m][0], 1.0)
-                        tensor_scale_add_no_trans(self.v[i, m, m, m], mat2, mat)
+                        tensor_scale_add_no_trans(v_immm[i], mat2, mat)
                         mat2.deallocate()
                         ops[OpElement(OpNames.RD, (i, ))] = mat
                 
                 if self.spatial_syms[m] != self.spatial_syms[i]:
-                    assert np.isclose(self.t[m, i], 0.0)
+                    assert np.isclose(t_im[i], 0.0)
             
             for s in [0, 1]:
                 for i in range(0, self.n_sites):
@@ -891,13 +1006,13 @@ class BlockHamiltonian:
                             if OpElement(OpNames.P, (i, k, s)) not in op_set:
                                 continue
                             
-                            if np.isclose(self.v[i, m, k, m], 0):
+                            if np.isclose(v_imkm[i, k], 0):
                                 ops[OpElement(OpNames.P, (i, k, s))] = 0
                             else:
                                 mat = StackSparseMatrix()
                                 mat.deep_copy(ops[OpElement(OpNames.AD, (m, m, s))])
                                 assert not mat.fermion
-                                tensor_scale(self.v[i, m, k, m], mat)
+                                tensor_scale(v_imkm[i, k], mat)
                                 mat.delta_quantum = VectorSpinQuantum([BlockSymmetry.to_spin_quantum(-self.two_site_plus_q[i, k][s])])
                                 ops[OpElement(OpNames.P, (i, k, s))] = mat
             
@@ -909,13 +1024,13 @@ class BlockHamiltonian:
                             if OpElement(OpNames.PD, (i, k, s)) not in op_set:
                                 continue
                             
-                            if np.isclose(self.v[i, m, k, m], 0):
+                            if np.isclose(v_imkm[i, k], 0):
                                 ops[OpElement(OpNames.PD, (i, k, s))] = 0
                             else:
                                 mat = StackSparseMatrix()
                                 mat.deep_copy(ops[OpElement(OpNames.A, (m, m, s))])
                                 assert not mat.fermion
-                                tensor_scale(self.v[i, m, k, m], mat)
+                                tensor_scale(v_imkm[i, k], mat)
                                 mat.delta_quantum = VectorSpinQuantum([BlockSymmetry.to_spin_quantum(self.two_site_plus_q[i, k][s])])
                                 ops[OpElement(OpNames.PD, (i, k, s))] = mat
             
@@ -926,13 +1041,13 @@ class BlockHamiltonian:
                         if OpElement(OpNames.Q, (i, j, 0)) not in op_set:
                             continue
                         
-                        if np.isclose(2 * self.v[i, j, m, m] -  self.v[i, m, m, j], 0):
+                        if np.isclose(2 * v_ijmm[i, j] -  v_immj[i, j], 0):
                             ops[OpElement(OpNames.Q, (i, j, 0))] = 0
                         else:
                             mat = StackSparseMatrix()
                             mat.deep_copy(ops[OpElement(OpNames.B, (m, m, 0))])
                             assert not mat.fermion
-                            tensor_scale(2 * self.v[i, j, m, m] -  self.v[i, m, m, j], mat)
+                            tensor_scale(2 * v_ijmm[i, j] -  v_immj[i, j], mat)
                             mat.delta_quantum = VectorSpinQuantum([BlockSymmetry.to_spin_quantum(self.two_site_minus_q[i, j][0])])
                             ops[OpElement(OpNames.Q, (i, j, 0))] = mat
                     
@@ -943,13 +1058,13 @@ class BlockHamiltonian:
                         if OpElement(OpNames.Q, (i, j, 1)) not in op_set:
                             continue
                         
-                        if np.isclose(self.v[i, m, m, j], 0):
+                        if np.isclose(v_immj[i, j], 0):
                             ops[OpElement(OpNames.Q, (i, j, 1))] = 0
                         else:
                             mat = StackSparseMatrix()
                             mat.deep_copy(ops[OpElement(OpNames.B, (m, m, 1))])
                             assert not mat.fermion
-                            tensor_scale(self.v[i, m, m, j], mat)
+                            tensor_scale(v_immj[i, j], mat)
                             mat.delta_quantum = VectorSpinQuantum([BlockSymmetry.to_spin_quantum(self.two_site_minus_q[i, j][1])])
                             ops[OpElement(OpNames.Q, (i, j, 1))] = mat
         
@@ -991,6 +1106,24 @@ class BlockHamiltonian:
                 
                 return ops
 
+            # integrals coupling site m to the other sites, gathered at once
+            # for each distinct integral array
+            sites = np.arange(self.n_sites)
+            gathered = {}
+            for x in [self.ta, self.tb, self.vaa, self.vab, self.vba, self.vbb]:
+                if id(x) in gathered:
+                    continue
+                if isinstance(x, VInt):
+                    gathered[id(x)] = {
+                        'immm': x.gather(sites, m, m, m),
+                        'imkm': x.gather(sites[:, None], m, sites[None, :], m),
+                        'ijmm': x.gather(sites[:, None], sites[None, :], m, m),
+                        'immj': x.gather(sites[:, None], m, m, sites[None, :])
+                    }
+                else:
+                    gathered[id(x)] = x.gather(sites, m)
+            g = lambda x: gathered[id(x)]
+            
             mat = StackSparseMatrix()
             mat.fermion = False
             mat.delta_quantum = VectorSpinQuantum([BlockSymmetry.to_spin_quantum(self.empty)])
@@ -1082,7 +1215,7 @@ class BlockHamiltonian:
                     if i == m:
                         continue
                     
-                    if np.isclose(tx[i, m], 0) and np.isclose(vxa[i, m, m, m], 0) and np.isclose(vxb[i, m, m, m], 0):
+                    if np.isclose(g(tx)[i], 0) and np.isclose(g(vxa)['immm'][i], 0) and np.isclose(g(vxb)['immm'][i], 0):
                         
                         if OpElement(OpNames.R, (i, s)) in op_set:
                             ops[OpElement(OpNames.R, (i, s))] = 0
@@ -1097,7 +1230,7 @@ class BlockHamiltonian:
                             mat = StackSparseMatrix()
                             mat.deep_copy(ops[OpElement(OpNames.D, (m, s))])
                             assert mat.fermion
-                            tensor_scale(tx[i, m] * 0.5, mat)
+                            tensor_scale(g(tx)[i] * 0.5, mat)
                             mat.delta_quantum = VectorSpinQuantum([BlockSymmetry.to_spin_quantum(dq)])
 
                             mat2 = StackSparseMatrix()
@@ -1105,7 +1238,7 @@ class BlockHamiltonian:
                                 mat2.deep_clear_copy(ops[OpElement(OpNames.D, (m, s))])
                                 product(ops[OpElement(OpNames.B, (m, m, sp, sp))], ops[OpElement(OpNames.D, (m, s))],
                                         mat2, self.site_state_info[m][0], 1.0)
-                                tensor_scale_add_no_trans(vxx[i, m, m, m], mat2, mat)
+                                tensor_scale_add_no_trans(g(vxx)['immm'][i], mat2, mat)
                             mat2.deallocate()
                             ops[OpElement(OpNames.R, (i, s))] = mat
                         
@@ -1114,7 +1247,7 @@ class BlockHamiltonian:
                             mat = StackSparseMatrix()
                             mat.deep_copy(ops[OpElement(OpNames.C, (m, s))])
                             assert mat.fermion
-                            tensor_scale(tx[i, m] * 0.5, mat)
+                            tensor_scale(g(tx)[i] * 0.5, mat)
                             mat.delta_quantum = VectorSpinQuantum([BlockSymmetry.to_spin_quantum(cq)])
 
                             mat2 = StackSparseMatrix()
@@ -1122,12 +1255,12 @@ class BlockHamiltonian:
                                 mat2.deep_clear_copy(ops[OpElement(OpNames.C, (m, s))])
                                 product(ops[OpElement(OpNames.C, (m, s))], ops[OpElement(OpNames.B, (m, m, sp, sp))],
                                         mat2, self.site_state_info[m][0], 1.0)
-                                tensor_scale_add_no_trans(vxx[i, m, m, m], mat2, mat)
+                                tensor_scale_add_no_trans(g(vxx)['immm'][i], mat2, mat)
                             mat2.deallocate()
                             ops[OpElement(OpNames.RD, (i, s))] = mat
                     
                     if self.spatial_syms[m] != self.spatial_syms[i]:
-                        assert np.isclose(tx[m, i], 0.0)
+                        assert np.isclose(g(tx)[i], 0.0)
             
             for (sl, sr), pq, vxx in zip(ss, pqs, vss):
                 for i in range(0, self.n_sites):
@@ -1137,13 +1270,13 @@ class BlockHamiltonian:
                             if OpElement(OpNames.P, (i, k, sl, sr)) not in op_set:
                                 continue
                             
-                            if np.isclose(vxx[i, m, k, m], 0):
+                            if np.isclose(g(vxx)['imkm'][i, k], 0):
                                 ops[OpElement(OpNames.P, (i, k, sl, sr))] = 0
                             else:
                                 mat = StackSparseMatrix()
                                 mat.deep_copy(ops[OpElement(OpNames.AD, (m, m, sl, sr))])
                                 assert not mat.fermion
-                                tensor_scale(vxx[i, m, k, m], mat)
+                                tensor_scale(g(vxx)['imkm'][i, k], mat)
                                 mat.delta_quantum = VectorSpinQuantum([BlockSymmetry.to_spin_quantum(-pq[i, k])])
                                 ops[OpElement(OpNames.P, (i, k, sl, sr))] = mat
             
@@ -1155,13 +1288,13 @@ class BlockHamiltonian:
                             if OpElement(OpNames.PD, (i, k, sl, sr)) not in op_set:
                                 continue
                             
-                            if np.isclose(vxx[i, m, k, m], 0):
+                            if np.isclose(g(vxx)['imkm'][i, k], 0):
                                 ops[OpElement(OpNames.PD, (i, k, sl, sr))] = 0
                             else:
                                 mat = StackSparseMatrix()
                                 mat.deep_copy(ops[OpElement(OpNames.A, (m, m, sl, sr))])
                                 assert not mat.fermion
-                                tensor_scale(vxx[i, m, k, m], mat)
+                                tensor_scale(g(vxx)['imkm'][i, k], mat)
                                 mat.delta_quantum = VectorSpinQuantum([BlockSymmetry.to_spin_quantum(pq[i, k])])
                                 ops[OpElement(OpNames.PD, (i, k, sl, sr))] = mat
 
@@ -1176,25 +1309,25 @@ class BlockHamiltonian:
                             if sl == sr:
                                 vxa, vxb = [(self.vaa, self.vab), (self.vba, self.vbb)][sl]
                             
-                            if np.isclose(vxx[i, m, m, j], 0) and (sl != sr or (np.isclose(vxa[i, j, m, m], 0) and np.isclose(vxb[i, j, m, m], 0))):
+                            if np.isclose(g(vxx)['immj'][i, j], 0) and (sl != sr or (np.isclose(g(vxa)['ijmm'][i, j], 0) and np.isclose(g(vxb)['ijmm'][i, j], 0))):
                                 ops[OpElement(OpNames.Q, (i, j, sl, sr))] = 0
                             else:
                                 mat = StackSparseMatrix()
                                 mat.deep_copy(ops[OpElement(OpNames.B, (m, m, sr, sl))])
                                 assert not mat.fermion
-                                tensor_scale(-vxx[i, m, m, j], mat)
+                                tensor_scale(-g(vxx)['immj'][i, j], mat)
                                 mat.delta_quantum = VectorSpinQuantum([BlockSymmetry.to_spin_quantum(-mq[i, j])])
 
                                 if sl == sr:
                                     mat2 = StackSparseMatrix()
                                     mat2.deep_copy(ops[OpElement(OpNames.B, (m, m, 0, 0))])
                                     assert not mat2.fermion
-                                    tensor_scale_add_no_trans(vxa[i, j, m, m], mat2, mat)
+                                    tensor_scale_add_no_trans(g(vxa)['ijmm'][i, j], mat2, mat)
                                     mat2.deallocate()
                                     mat2 = StackSparseMatrix()
                                     mat2.deep_copy(ops[OpElement(OpNames.B, (m, m, 1, 1))])
                                     assert not mat2.fermion
-                                    tensor_scale_add_no_trans(vxb[i, j, m, m], mat2, mat)
+                                    tensor_scale_add_no_trans(g(vxb)['ijmm'][i, j], mat2, mat)
                                     mat2.deallocate()
                                 
                                 ops[OpElement(OpNames.Q, (i, j, sl, sr))] = mat
@@ -24,6 +24,8 @@ FCIDUMP file and storage of integrals.
 """
 
 import numpy as np
+import struct
+import os
 
 
 # one-electron integrals
@@ -43,16 +45,68 @@ class TInt:
 
     @staticmethod
     def find_index(i, j):
-        """Find linear index from full indices (i, j)."""
-        if i < j:
-            i, j = j, i
+        """
+        Find linear index from full indices (i, j).
+        The indices may also be integer arrays, which are broadcast against each other.
+        """
+        if np.ndim(i) == 0 and np.ndim(j) == 0:
+            if i < j:
+                i, j = j, i
+            return i * (i + 1) // 2 + j
+        i, j = np.maximum(i, j), np.minimum(i, j)
         return i * (i + 1) // 2 + j
 
     def __getitem__(self, idx):
         return self.data[self.__class__.find_index(*idx)]
 
     def __setitem__(self, idx, val):
+        self._full = None
         self.data[self.__class__.find_index(*idx)] = val
+
+    def gather(self, *idx):
+        """
+        Elements for arrays of full indices, broadcast against each other.
+        For example ``t.gather(np.arange(n), m)`` is the column :math:`T_{im}`.
+        """
+        return self.data[self.__class__.find_index(*[np.asarray(x) for x in idx])]
+
+    def unpack(self):
+        """
+        The full rank-2 (or rank-4) array. It is built once and kept until an
+        element is set; the returned array is read-only.
+        """
+        if getattr(self, '_full', None) is None:
+            ix = np.ix_(*[np.arange(self.n)] * (4 if isinstance(self, VInt) else 2))
+            self._full = self.data[self.__class__.find_index(*ix)]
+            self._full.flags.writeable = False
+        return self._full
+
+    def nonzero(self, sites=None, cutoff=1E-13):
+        """
+        Screened non-zero elements with all indices in ``sites``.
+        
+        Args:
+            sites : list(int) or None
+                Site partition; all sites if None.
+            cutoff : float
+                Elements with absolute value not above ``cutoff`` are dropped.
+        
+        Returns:
+            (i, j, value) for TInt, (i, j, k, l, value) for VInt : tuple(numpy.ndarray)
+                One entry for each symmetry-unique element, with
+                :math:`i \\ge j` (and :math:`k \\ge l`, :math:`(ij) \\ge (kl)`).
+        """
+        sites = np.arange(self.n) if sites is None else np.unique(np.asarray(sites, dtype=int))
+        i, j = np.tril_indices(len(sites))
+        i, j = sites[i], sites[j]
+        if isinstance(self, VInt):
+            p, q = np.tril_indices(len(i))
+            idx = (i[p], j[p], i[q], j[q])
+        else:
+            idx = (i, j)
+        val = self.gather(*idx)
+        mask = np.abs(val) > cutoff
+        return tuple(x[mask] for x in idx) + (val[mask], )
     
     def __eq__(self, other):
         return self.n == other.n and np.allclose(self.data, other.data)
@@ -102,14 +156,111 @@ class VInt(TInt):
                 for k in rk(i) for l in rl(i, j, k)].__repr__()
 
 
+def _parse_namelist(pars):
+    """Parse the namelist part (before ``/`` or ``&END``) of an FCIDUMP file."""
+    cont = ','.join(pars.split()[1:])
+    cont = cont.split(',')
+    cont_dict = {}
+    p_key = None
+    for c in cont:
+        if '=' in c or p_key is None:
+            p_key, b = c.split('=')
+            cont_dict[p_key.strip().lower()] = b.strip()
+        elif len(c.strip()) != 0:
+            if len(cont_dict[p_key.strip().lower()]) != 0:
+                cont_dict[p_key.strip().lower()] += ',' + c.strip()
+            else:
+                cont_dict[p_key.strip().lower()] = c.strip()
+
+    for k, v in cont_dict.items():
+        if ',' in v:
+            v = cont_dict[k] = v.split(',')
+    return cont_dict
+
+
+# binary integral cache, same format as src/io/integralcache.h
+CACHE_MAGIC = b'BLKFCI01'
+CACHE_HEADER = struct.Struct('<8sqqqQd16x')
+
+
+def _checksum(data, start=0):
+    """Position weighted sum (modulo :math:`2^{64}`) of the 64 bit words of ``data``."""
+    words = np.ascontiguousarray(data, dtype=np.float64).view(np.uint64)
+    s = 0
+    chunk = 1 << 22
+    for st in range(0, len(words), chunk):
+        w = words[st:st + chunk]
+        pos = np.arange(start + st, start + st + len(w), dtype=np.uint64) * np.uint64(2) + np.uint64(1)
+        s = (s + int(np.sum(w * pos, dtype=np.uint64))) % (1 << 64)
+    return s
+
+
+def write_integral_cache(filename, t, v, e, source):
+    """
+    Write integrals to a binary cache file that belongs to the FCIDUMP file ``source``.
+    
+    Args:
+        filename : str
+        t, v, e : TInt, VInt, float
+        source : str
+            The cache is only valid for this file with its current size and modification time.
+    """
+    st = os.stat(source)
+    checksum = (_checksum(t.data) + _checksum(v.data, len(t.data))) % (1 << 64)
+    header = CACHE_HEADER.pack(CACHE_MAGIC, t.n, st.st_size, int(st.st_mtime), checksum, e)
+    tmp = filename + '.tmp'
+    with open(tmp, 'wb') as f:
+        f.write(header)
+        f.write(np.ascontiguousarray(t.data, dtype='<f8').tobytes())
+        f.write(np.ascontiguousarray(v.data, dtype='<f8').tobytes())
+    os.replace(tmp, filename)
+
+
+def read_integral_cache(filename, source):
+    """
+    Map integrals from a binary cache file written for the FCIDUMP file ``source``.
+    The data of the returned arrays is a read-only ``numpy.memmap`` (use ``copy()`` to modify).
+    
+    Returns:
+        (t, v, e) : (TInt, VInt, float), or None if the cache is missing or does not belong to ``source``.
+    """
+    if not os.path.isfile(filename):
+        return None
+    with open(filename, 'rb') as f:
+        header = f.read(CACHE_HEADER.size)
+    if len(header) != CACHE_HEADER.size:
+        return None
+    magic, n, size, mtime, checksum, e = CACHE_HEADER.unpack(header)
+    st = os.stat(source)
+    if magic != CACHE_MAGIC or size != st.st_size or mtime != int(st.st_mtime):
+        return None
+    nt = n * (n + 1) // 2
+    nv = nt * (nt + 1) // 2
+    if os.path.getsize(filename) != CACHE_HEADER.size + 8 * (nt + nv):
+        return None
+    data = np.memmap(filename, dtype='<f8', mode='r', offset=CACHE_HEADER.size, shape=(nt + nv, ))
+    if _checksum(data) != checksum:
+        return None
+    t = TInt.__new__(TInt)
+    v = VInt.__new__(VInt)
+    t.n = v.n = n
+    t.data = data[:nt]
+    v.data = data[nt:]
+    return t, v, e
+
+
 # read FCIDUMP file
 # return : options, (1-e array, 2-e array, const energy term)
-def read_fcidump(filename):
+def read_fcidump(filename, cache=False):
     """
     Read FCI options and integrals from FCIDUMP file.
     
     Args:
         filename : str
+        cache : bool
+            If True, the integrals are taken from the binary cache ``filename + '.cache'``
+            when it is valid, otherwise they are read from the text and the cache is written.
+            The cache is shared with the ``integral_cache`` option of the C++ code.
     
     Returns:
         cont_dict : dict
@@ -117,29 +268,26 @@ def read_fcidump(filename):
         (t, v, e) : (TInt, VInt, float)
             One- and two-electron integrals and const energy.
     """
+    cache_file = filename + '.cache'
+    if cache:
+        ints = read_integral_cache(cache_file, filename)
+        if ints is not None:
+            pars = ''
+            with open(filename, 'r') as f:
+                for l in f:
+                    ll = l.lower()
+                    if '/' in ll or '&end' in ll:
+                        pars += ll.split('/' if '/' in ll else '&end')[0]
+                        break
+                    pars += ll
+            return _parse_namelist(pars), ints
     with open(filename, 'r') as f:
         ff = f.read().lower()
         if '/' in ff:
             pars, ints = ff.split('/')
         elif '&end' in ff:
             pars, ints = ff.split('&end')
-        cont = ','.join(pars.split()[1:])
-        cont = cont.split(',')
-        cont_dict = {}
-        p_key = None
-        for c in cont:
-            if '=' in c or p_key is None:
-                p_key, b = c.split('=')
-                cont_dict[p_key.strip().lower()] = b.strip()
-            elif len(c.strip()) != 0:
-                if len(cont_dict[p_key.strip().lower()]) != 0:
-                    cont_dict[p_key.strip().lower()] += ',' + c.strip()
-                else:
-                    cont_dict[p_key.strip().lower()] = c.strip()
-        
-        for k, v in cont_dict.items():
-            if ',' in v:
-                v = cont_dict[k] = v.split(',')
+        cont_dict = _parse_namelist(pars)
 
         n = int(cont_dict['norb'])
         t = TInt(n)
@@ -158,4 +306,6 @@ def read_fcidump(filename):
                 t[i - 1, j - 1] = d
             else:
                 v[i - 1, j - 1, k - 1, l - 1] = d
+    if cache:
+        write_integral_cache(cache_file, t, v, e, filename)
     return cont_dict, (t, v, e)
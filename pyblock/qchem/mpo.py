@@ -24,6 +24,7 @@ Matrix Product Operator for quantum chemistry calculations.
 """
 
 from .operator import OpElement, OpSum, OpNames
+from .cache import cache_key, hamiltonian_key, load_cache, save_cache
 from ..tensor.tensor import Tensor, TensorNetwork
 import numpy as np
 
@@ -85,13 +86,74 @@ class DualOperatorTensor(Tensor):
 
 
 class MPOInfo:
-    def __init__(self, hamil, cache_contraction=True):
+    """
+    Operator names of the contracted MPO at each site.
+    
+    Args:
+        hamil : BlockHamiltonian
+            The Hamiltonian.
+        cache_contraction : bool
+            If True, simplified expressions of contracted MPO are kept in :attr:`cached_exprs`.
+        cache_dir : str or None
+            If not None, operator names and :attr:`cached_exprs` are also cached in this directory
+            (see :mod:`pyblock.qchem.cache`), so that later runs with the same Hamiltonian can skip
+            the symbolic setup.
+    """
+    def __init__(self, hamil, cache_contraction=True, cache_dir=None):
         self.hamil = hamil
         self.n_sites = hamil.n_sites
         self.middle_operators = None
-        self._init_operator_names()
+        self.cache_dir = cache_dir
+        self.cache_key = None
+        if cache_dir is not None:
+            self.cache_key = hamiltonian_key(hamil, self.__class__.__name__, *self._cache_key_extra())
+        names = load_cache(cache_dir, 'mpo-info', self.cache_key)
+        if names is not None:
+            self.left_operator_names, self.right_operator_names, self.middle_operators = names
+        else:
+            self._init_operator_names()
+            save_cache(cache_dir, 'mpo-info', self.cache_key,
+                       (self.left_operator_names, self.right_operator_names, self.middle_operators))
         self.cache_contraction = cache_contraction
         self.cached_exprs = {}
+        self.n_saved_exprs = 0
+        # sites whose MPO tensor is the identity, with the same operator names
+        # as the block they are added to (ancilla sites)
+        self.identity_sites = set()
+    
+    def _cache_key_extra(self):
+        """Parts of the cache key from the constructor arguments of derived classes."""
+        return ()
+    
+    def _exprs_key(self, tag):
+        return cache_key(self.cache_key, tag) if self.cache_key is not None else None
+    
+    def load_cached_exprs(self, tag):
+        """
+        Read :attr:`cached_exprs` written by an earlier run.
+        
+        Args:
+            tag : str
+                Description of the simplifier and parallelizer that built the expressions.
+        
+        Returns:
+            n_exprs : int
+                Number of expressions read.
+        """
+        if not self.cache_contraction:
+            return 0
+        exprs = load_cache(self.cache_dir, 'exprs', self._exprs_key(tag))
+        if exprs is not None:
+            exprs.update(self.cached_exprs)
+            self.cached_exprs = exprs
+            self.n_saved_exprs = len(exprs)
+        return len(self.cached_exprs)
+    
+    def save_cached_exprs(self, tag):
+        """Write :attr:`cached_exprs` if new expressions were added since the last save."""
+        if len(self.cached_exprs) != self.n_saved_exprs:
+            save_cache(self.cache_dir, 'exprs', self._exprs_key(tag), self.cached_exprs)
+            self.n_saved_exprs = len(self.cached_exprs)
     
     def _init_operator_names(self):
         if self.hamil.spin_adapted:
@@ -271,12 +333,41 @@ class MPOInfo:
 
 
 class MPO(TensorNetwork):
-    def __init__(self, hamil, iprint=False):
+    """
+    Quantum chemistry MPO.
+    
+    Args:
+        hamil : BlockHamiltonian
+            The Hamiltonian.
+        iprint : bool
+            If True, print progress of construction.
+        cache_dir : str or None
+            If not None, the symbolic MPO tensors are cached in this directory and only
+            the numeric site operators are rebuilt when the cache is valid.
+    """
+    def __init__(self, hamil, iprint=False, cache_dir=None):
         self.n_sites = hamil.n_sites
         self.hamil = hamil
-        tensors = self._init_mpo_tensors(iprint=iprint)
+        key = None
+        if cache_dir is not None:
+            key = hamiltonian_key(hamil, self.__class__.__name__, *self._cache_key_extra())
+        mats = load_cache(cache_dir, 'mpo', key)
+        if mats is not None:
+            tensors = []
+            for m, mat in enumerate(mats):
+                [mat], ops = self._post_check_mpo_operators([mat], m)
+                tensors.append(OperatorTensor(mat=mat, tags={m}, ops=ops))
+        else:
+            tensors = self._init_mpo_tensors(iprint=iprint)
+            # only plain site tensors can be rebuilt from the symbolic matrices
+            if all(type(ts) is OperatorTensor and ts.tags == {m} for m, ts in enumerate(tensors)):
+                save_cache(cache_dir, 'mpo', key, [ts.mat for ts in tensors])
         super().__init__(tensors)
     
+    def _cache_key_extra(self):
+        """Parts of the cache key from the constructor arguments of derived classes."""
+        return ()
+    
     def _init_mpo_tensors(self, *args, **kwargs):
         """Generate :attr:`tensors`."""
         if self.hamil.spin_adapted:
@@ -759,6 +850,9 @@ class SquareMPOInfo(MPOInfo):
         self.opsq_name = opsq_name
         super().__init__(hamil, **kwargs)
     
+    def _cache_key_extra(self):
+        return (self.op_name, self.opsq_name)
+    
     def _init_operator_names(self):
         self.left_operator_names = [None] * self.n_sites
         self.right_operator_names = [None] * self.n_sites
@@ -781,6 +875,9 @@ class SquareMPO(MPO):
         self.op_name = op_name
         self.opsq_name = opsq_name
         super().__init__(hamil, **kwargs)
+    
+    def _cache_key_extra(self):
+        return (self.op_name, self.opsq_name)
 
     def _init_mpo_tensors(self, iprint):
         tensors = []
@@ -804,6 +901,9 @@ class LocalMPOInfo(MPOInfo):
         self.op_name = op_name
         super().__init__(hamil, **kwargs)
     
+    def _cache_key_extra(self):
+        return (self.op_name, )
+    
     def _init_operator_names(self):
         self.left_operator_names = [None] * self.n_sites
         self.right_operator_names = [None] * self.n_sites
@@ -825,6 +925,9 @@ class LocalMPO(MPO):
         self.op_name = op_name
         super().__init__(hamil, **kwargs)
     
+    def _cache_key_extra(self):
+        return (self.op_name, )
+    
     def _init_mpo_tensors(self, iprint):
         tensors = []
         iop = OpElement(OpNames.I, (), q_label=self.hamil.empty)
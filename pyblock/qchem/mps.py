@@ -24,7 +24,8 @@ Matrix Product State for quantum chemistry calculations.
 """
 
 from block import VectorInt, VectorVectorInt, VectorMatrix, Matrix
-from block.symmetry import state_tensor_product
+from block.symmetry import state_tensor_product, pickle_state_infos, unpickle_state_infos
+from block.symmetry import VectorStateInfo
 from block.operator import Wavefunction
 
 from ..symmetry.symmetry import DirectProdGroup
@@ -206,11 +207,26 @@ class MPSInfo:
         self._init_state_info()
     
     def __getstate__(self):
-        return (self.lcp, self.n_sites, self.basis, self.left_block_basis, self.right_block_basis)
+        # the StateInfo objects go as one buffer, with the links between them,
+        # so that a copy does not build them again
+        sis = VectorStateInfo(self.left_state_info + self.right_state_info
+                              + self.left_state_info_no_trunc + self.right_state_info_no_trunc)
+        return (self.lcp, self.n_sites, self.basis, self.left_block_basis, self.right_block_basis,
+                pickle_state_infos(sis))
     
     def __setstate__(self, state):
-        self.lcp, self.n_sites, self.basis, self.left_block_basis, self.right_block_basis = state
-        self._init_state_info()
+        self.lcp, self.n_sites, self.basis, self.left_block_basis, self.right_block_basis = state[:5]
+        if len(state) == 5:
+            self._init_state_info()
+            return
+        # also holds the StateInfo objects the left and right pointers refer to
+        self._state_infos = unpickle_state_infos(state[5])
+        n = self.n_sites
+        sis = [self._state_infos[i] for i in range(4 * n)]
+        self.left_state_info = sis[:n]
+        self.right_state_info = sis[n:2 * n]
+        self.left_state_info_no_trunc = sis[2 * n:3 * n]
+        self.right_state_info_no_trunc = sis[3 * n:]
     
     def _init_state_info(self):
         """Generate StateInfo objects."""
@@ -335,6 +351,7 @@ class MPSInfo:
             j = bisect.bisect_left(right.quanta, q)
             if j != len(right.quanta) and right.quanta[j] == q:
                 right.old_to_new_state[j].append(ii)
+        right.build_collected_index()
         collected = uncollected.copy()
         collected.collect_quanta()
         return right, collected
@@ -359,6 +376,7 @@ class MPSInfo:
             j = bisect.bisect_left(left.quanta, q)
             if j != len(left.quanta) and left.quanta[j] == q:
                 left.old_to_new_state[j].append(ii)
+        left.build_collected_index()
         collected = uncollected.copy()
         collected.collect_quanta()
         return left, collected
@@ -447,13 +465,15 @@ class MPSInfo:
         Args:
             i : int
                 Site index.
-            rot : VectorMatrix
+            rot : VectorMatrix or [numpy.ndarray]
                 Rotation matrix, defining the transformation
                 from untruncated (but collected) basis to truncated basis.
+                A list of arrays is what ``load_rotation_matrix_arrays`` returns.
         
         Returns:
             tensor : class:`Tensor`
         """
+        rot = [r if isinstance(r, np.ndarray) else r.ref for r in rot]
         collected = self.left_state_info_no_trunc[i]
         l = self.left_state_info[i].left_state_info
         r = self.left_state_info[i].right_state_info
@@ -465,7 +485,7 @@ class MPSInfo:
         
         blocks = []
         for k, js in enumerate(otn):
-            if rot[k].cols == 0:
+            if rot[k].shape[1] == 0:
                 continue
             idx_rot = 0
             for j in js:
@@ -474,10 +494,10 @@ class MPSInfo:
                 q_labels = tuple(BlockSymmetry.from_spin_quantum(sq) for sq in sqs)
                 red_shape = (l.n_states[lr_idl[j]], r.n_states[lr_idr[j]], -1)
                 rot_l_sh = red_shape[0] * red_shape[1]
-                reduced = np.array(rot[k].ref[idx_rot:idx_rot + rot_l_sh, :])
+                reduced = np.array(rot[k][idx_rot:idx_rot + rot_l_sh, :])
                 idx_rot += rot_l_sh
                 blocks.append(SubTensor(q_labels, reduced.reshape(red_shape)))
-            assert idx_rot == rot[k].rows
+            assert idx_rot == rot[k].shape[0]
         t = Tensor(blocks)
         t.sort()
         return t
@@ -489,13 +509,15 @@ class MPSInfo:
         Args:
             i : int
                 Site index.
-            rot : VectorMatrix
+            rot : VectorMatrix or [numpy.ndarray]
                 Rotation matrix, defining the transformation
                 from untruncated (but collected) basis to truncated basis.
+                A list of arrays is what ``load_rotation_matrix_arrays`` returns.
         
         Returns:
             tensor : class:`Tensor`
         """
+        rot = [r if isinstance(r, np.ndarray) else r.ref for r in rot]
         collected = self.right_state_info_no_trunc[i]
         l = self.right_state_info[i].left_state_info
         r = self.right_state_info[i].right_state_info
@@ -507,7 +529,7 @@ class MPSInfo:
         
         blocks = []
         for k, js in enumerate(otn):
-            if rot[k].cols == 0:
+            if rot[k].shape[1] == 0:
                 continue
             idx_rot = 0
             for j in js:
@@ -519,10 +541,10 @@ class MPSInfo:
                 assert isinstance(q_labels[2], DirectProdGroup)
                 red_shape = (-1, l.n_states[lr_idl[j]], r.n_states[lr_idr[j]])
                 rot_l_sh = red_shape[1] * red_shape[2]
-                reduced = np.array(rot[k].ref[idx_rot:idx_rot + rot_l_sh, :].T)
+                reduced = np.array(rot[k][idx_rot:idx_rot + rot_l_sh, :].T)
                 idx_rot += rot_l_sh
                 blocks.append(SubTensor(q_labels, reduced.reshape(red_shape)))
-            assert idx_rot == rot[k].rows
+            assert idx_rot == rot[k].shape[0]
         t = Tensor(blocks)
         t.sort()
         return t
@@ -566,12 +588,9 @@ class MPSInfo:
                     b = block.reduced.shape[2]
                     reduced = block.reduced.reshape((a, b))
                     red.append(reduced)
-            if len(red) == 0:
-                rot.append(Matrix())
-            else:
-                rot.append(Matrix(np.ascontiguousarray(np.concatenate(red, axis=0))))
+            rot.append(red)
         
-        return VectorMatrix(rot)
+        return _rotation_matrix_from_blocks(rot)
     
     def get_right_rotation_matrix(self, i, tensor):
         """
@@ -615,12 +634,28 @@ class MPSInfo:
                     b = block.reduced.shape[0]
                     reduced = block.reduced.reshape((b, a)).T
                     red.append(reduced)
-            if len(red) == 0:
-                rot.append(Matrix())
-            else:
-                rot.append(Matrix(np.ascontiguousarray(np.concatenate(red, axis=0))))
+            rot.append(red)
         
-        return VectorMatrix(rot)
+        return _rotation_matrix_from_blocks(rot)
+
+
+def _rotation_matrix_from_blocks(reds):
+    """
+    Rotation matrix (block code) from the row blocks of every collected quantum number.
+    Each matrix is allocated once and the blocks are copied straight into its storage.
+    """
+    rot = VectorMatrix()
+    for red in reds:
+        rot.append(Matrix())
+        if len(red) != 0:
+            mat = rot[len(rot) - 1]
+            mat.resize(sum(r.shape[0] for r in red), red[0].shape[1])
+            ref = mat.ref
+            idx = 0
+            for r in red:
+                ref[idx:idx + r.shape[0], :] = r
+                idx += r.shape[0]
+    return rot
 
                     
 class MPS(TensorNetwork):
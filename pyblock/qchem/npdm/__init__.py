@@ -4,3 +4,4 @@ N-particle density matrix.
 """
 
 from .mpo import PDM1MPOInfo, PDM1MPO
+from .tiles import NPDMTiles
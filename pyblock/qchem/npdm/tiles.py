@@ -0,0 +1,80 @@
+#
+#    pyblock: Spin-adapted quantum chemistry DMRG in MPO language (based on Block C++ code)
+#    Copyright (C) 2019-2020 Huanchen Zhai
+#
+#    Block 1.5.3: density matrix renormalization group (DMRG) algorithm for quantum chemistry
+#    Developed by Sandeep Sharma and Garnet K.-L. Chan, 2012
+#    Copyright (C) 2012 Garnet K.-L. Chan
+#
+#    This program is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License as published by
+#    the Free Software Foundation, either version 3 of the License, or
+#    (at your option) any later version.
+#
+#    This program is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+"""
+Reader for the tiled spatial 3PDM/4PDM files written by the ``npdm_tiles`` option.
+"""
+
+import numpy as np
+import struct
+
+TILE_MAGIC = b'BLKPDMT1'
+TILE_HEADER = struct.Struct('<8sqqqq24x')
+
+
+class NPDMTiles:
+    """
+    Random access to one ``spatial_threepdm.i.j.tiles`` or ``spatial_fourpdm.i.j.tiles`` file.
+    A tile holds all elements with the same leading ``order // 2`` indices,
+    and only the requested tiles are read from disk.
+    
+    Attributes:
+        order : int
+            Number of orbital indices of an element (6 for 3PDM, 8 for 4PDM).
+        n : int
+            Number of spatial orbitals.
+    """
+    def __init__(self, filename):
+        self.filename = filename
+        with open(filename, 'rb') as f:
+            magic, self.order, self.n, n_tiles, offset = TILE_HEADER.unpack(f.read(TILE_HEADER.size))
+        if magic != TILE_MAGIC:
+            raise ValueError('%s is not an NPDM tile file' % filename)
+        self.n_tiles = n_tiles
+        self.directory = np.fromfile(filename, dtype='<i8', count=2 * n_tiles, offset=offset).reshape((n_tiles, 2))
+    
+    @property
+    def tile_shape(self):
+        return (self.n, ) * (self.order // 2)
+    
+    def tile(self, *lead):
+        """Dense array of the elements with leading indices ``lead`` (``order // 2`` of them)."""
+        assert len(lead) == self.order // 2
+        t = int(np.ravel_multi_index(lead, self.tile_shape))
+        offset, count = self.directory[t]
+        if count == -1:
+            data = np.fromfile(self.filename, dtype='<f8', count=self.n_tiles, offset=offset)
+        else:
+            data = np.zeros((self.n_tiles, ))
+            if count != 0:
+                pos = np.fromfile(self.filename, dtype='<u4', count=count, offset=offset)
+                data[pos] = np.fromfile(self.filename, dtype='<f8', count=count, offset=offset + 4 * count)
+        return data.reshape(self.tile_shape)
+    
+    def tiles(self):
+        """Iterate over ``(lead, tile)`` for all nonzero tiles, one tile in memory at a time."""
+        for t in np.nonzero(self.directory[:, 1])[0]:
+            lead = np.unravel_index(t, self.tile_shape)
+            yield tuple(int(x) for x in lead), self.tile(*lead)
+    
+    def __getitem__(self, idx):
+        assert len(idx) == self.order
+        return self.tile(*idx[:self.order // 2])[tuple(idx[self.order // 2:])]
@@ -75,9 +75,15 @@ class OpElement(OpExpression):
             scalar factor.
         q_label : DirectProdGroup
             Quantum label of the operator.
+        id : int
+            Dense integer id, shared by all symbols that compare equal
+            (same name, site indices and factor).
+        hash_value : int
+            Precomputed hash.
     """
-    __slots__ = ['name', 'site_index', 'factor', 'q_label']
+    __slots__ = ['name', 'site_index', 'factor', 'q_label', 'id', 'hash_value']
     Cached = {}
+    Interned = {}
     def __init__(self, name, site_index, factor=1, q_label=None):
         assert isinstance(site_index, tuple)
         factor = float(factor)
@@ -88,6 +94,15 @@ class OpElement(OpExpression):
         self.site_index = site_index
         self.factor = factor
         self.q_label = q_label
+        self.id, self.hash_value = OpElement.intern(name, site_index, factor)
+    
+    @staticmethod
+    def intern(name, site_index, factor):
+        """Return (id, hash) of the symbol (name, site_index, factor), assigning a new id when first seen."""
+        key = (name, site_index, factor)
+        if key not in OpElement.Interned:
+            OpElement.Interned[key] = (len(OpElement.Interned), hash(key))
+        return OpElement.Interned[key]
     
     def __new__(cls, name, site_index, factor=1, q_label=None, *args, **kwargs):
         factor = float(factor)
@@ -96,6 +111,17 @@ class OpElement(OpExpression):
         else:
             return super().__new__(cls)
     
+    def __getnewargs__(self):
+        return (self.name, self.site_index, self.factor, self.q_label)
+    
+    # ids are only valid in this process, so they are assigned again when unpickled
+    def __getstate__(self):
+        return (self.name, self.site_index, self.factor, self.q_label)
+    
+    def __setstate__(self, state):
+        self.name, self.site_index, self.factor, self.q_label = state
+        self.id, self.hash_value = OpElement.intern(self.name, self.site_index, self.factor)
+    
     def __repr__(self):
         if self.factor != 1:
             return '(%10.5f %r)' % (self.factor, abs(self))
@@ -150,11 +176,12 @@ class OpElement(OpExpression):
         return OpElement(self.name, self.site_index, 1, self.q_label)
     
     def __eq__(self, other):
-        if not isinstance(other, OpElement):
+        if self is other:
+            return True
+        elif not isinstance(other, OpElement):
             return False
         else:
-            return self.name == other.name and self.site_index == other.site_index \
-                and self.factor == other.factor
+            return self.id == other.id
     
     def __lt__(self, other):
         if other == 0:
@@ -171,7 +198,7 @@ class OpElement(OpExpression):
             return False
     
     def __hash__(self):
-        return hash((self.name, self.site_index, self.factor))
+        return self.hash_value
     
     @staticmethod
     def parse_site_index(expr):
@@ -198,11 +225,21 @@ class OpString(OpExpression):
             A list of single operator symbols.
         sign : int (1 or -1)
             Sign factor. With SU(2) factor considered
+        ids : tuple(int..)
+            Interned ids of the operator symbols.
     """
-    __slots__ = ['ops', 'factor']
+    __slots__ = ['ops', 'factor', 'ids']
     def __init__(self, ops, factor=1):
         self.factor = np.prod([x.factor for x in ops]) * factor
         self.ops = [abs(x) for x in ops]
+        self.ids = tuple(x.id for x in self.ops)
+    
+    def __getstate__(self):
+        return (self.ops, self.factor)
+    
+    def __setstate__(self, state):
+        self.ops, self.factor = state
+        self.ids = tuple(x.id for x in self.ops)
     
     @property
     def op(self):
@@ -266,9 +303,10 @@ class OpString(OpExpression):
         if not isinstance(other, OpString):
             return False
         else:
-            return (len(other.ops) == len(self.ops) and
-                    self.factor == other.factor and
-                    all([pa == pb for pa, pb in zip(self.ops, other.ops)]))
+            return self.ids == other.ids and self.factor == other.factor
+    
+    def __hash__(self):
+        return hash((self.ids, self.factor))
     
 
 class OpSum(OpExpression):
@@ -329,4 +367,4 @@ class OpSum(OpExpression):
             return False
         else:
             return (len(other.strings) == len(self.strings) and
-                    all([sa == sb for sa, sb in zip(self.strings, other.strings)]))
+                    all(sa == sb for sa, sb in zip(self.strings, other.strings)))
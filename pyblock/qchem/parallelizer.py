@@ -26,6 +26,7 @@ MPI parallelization.
 from .operator import OpNames, OpElement, OpString, OpSum
 from .simplifier import OpCollection, OpShell
 from .fcidump import TInt
+from .cache import cache_key
 from block.operator import StackSparseMatrix, Wavefunction
 import contextlib
 import numpy as np
@@ -173,6 +174,149 @@ class ParaRule:
         else:
             return ParaProperty(TInt.find_index(*op.site_index[:2]) % self.size, False, False, False)
         
+class CostParaRule(ParaRule):
+    """
+    Parallelization rule balancing the estimated cost of operators at each site.
+    
+    The two-index operators of one orbital pair (A, AD, B, P, PD, Q) and the partial
+    R/RD operators of one orbital keep one owner for all sites, since their expressions
+    use the same operators of the previous site. Owners are chosen greedily, most
+    expensive unit first, on the rank for which the maximum load over all sites stays lowest.
+    The cost of an operator at a site is its number of expression terms times the square
+    of the block dimension.
+    
+    Args:
+        n_sites : int
+            Number of sites.
+        size : int
+            Number of MPI ranks.
+        lcp : LineCoupling or None
+            If not None, block dimensions are taken from its ``left_dims`` and ``right_dims``.
+            Otherwise the FCI dimension capped at ``bond_dim`` is used.
+        bond_dim : int
+            Bond dimension of the cost model when ``lcp`` is None.
+        costs : dict(OpElement -> float) or None
+            Measured total cost of operators, for example from :meth:`expression_costs`
+            of an earlier run. The cost of an orbital pair or orbital is then the sum of
+            its measured operators, distributed over the sites as in the cost model.
+    
+    Attributes:
+        pair_owners : dict(int -> int)
+            Owner of each orbital pair, by ``TInt.find_index(i, j)``.
+        r_owners : list(int)
+            Owner of R/RD operators of each orbital.
+        loads : numpy.ndarray
+            Estimated cost at each rank (first index) and site (second index).
+        cache_tag : str
+            Hash of the assignment, part of the key of cached expressions.
+    """
+    pair_names = [OpNames.A, OpNames.AD, OpNames.B, OpNames.P, OpNames.PD, OpNames.Q]
+    
+    def __init__(self, n_sites, size=mpi_size, lcp=None, bond_dim=500, costs=None):
+        self.size = size
+        self.n_sites = n_sites
+        n = n_sites
+        if lcp is not None:
+            dl = np.array([sum(lcp.left_dims[i].values()) for i in range(n)], dtype=float)
+            dr = np.array([sum(lcp.right_dims[i].values()) for i in range(n)], dtype=float)
+        else:
+            dl = np.array([min(4.0 ** (i + 1), 4.0 ** (n - i - 1), bond_dim) for i in range(n)])
+            dr = np.array([min(4.0 ** (n - i), 4.0 ** i, bond_dim) for i in range(n)])
+        # step i: left block of sites [0, i], right block of sites [i + 1, n)
+        wl = dl ** 2
+        wr = np.append(dr[1:], 0.0) ** 2
+        sites = np.arange(n)
+        units = {}
+        for j in range(n):
+            for k in range(j + 1):
+                # A, AD, B on the left of j; P, PD, Q on the right of j
+                c = np.where(sites >= j, wl, 0.0) + np.where(sites + 1 > j, wr, 0.0)
+                units[('P', TInt.find_index(j, k))] = c
+            # R_j on the left with one term per left site, on the right with one per right site
+            c = np.where(sites < j, (sites + 1) * wl, 0.0) + np.where(sites >= j, (n - 1 - sites) * wr, 0.0)
+            units[('R', j)] = c
+        if costs is not None:
+            measured = {}
+            for op, cost in costs.items():
+                u = self._unit(op)
+                if u is not None:
+                    measured[u] = measured.get(u, 0.0) + cost
+            for u, cost in measured.items():
+                if units[u].sum() != 0:
+                    units[u] = units[u] * (cost / units[u].sum())
+        self.loads = np.zeros((size, n))
+        owners = {}
+        for u, c in sorted(units.items(), key=lambda x: (-x[1].sum(), x[0])):
+            peak = np.max(self.loads + c[None, :], axis=1)
+            r = min(range(size), key=lambda r: (peak[r], self.loads[r].sum(), r))
+            self.loads[r] += c
+            owners[u] = r
+        self.pair_owners = {k: r for (t, k), r in owners.items() if t == 'P'}
+        self.r_owners = [owners[('R', j)] for j in range(n)]
+        self.cache_tag = cache_key(size, sorted(owners.items()))
+    
+    def _unit(self, op):
+        if op.name in [OpNames.R, OpNames.RD]:
+            return ('R', op.site_index[0])
+        elif op.name in self.pair_names:
+            return ('P', TInt.find_index(*op.site_index[:2]))
+        else:
+            return None
+    
+    def __call__(self, op):
+        u = self._unit(op)
+        if u is None:
+            return super().__call__(op)
+        elif u[0] == 'R':
+            return ParaProperty(self.r_owners[u[1]], False, False, True)
+        else:
+            return ParaProperty(self.pair_owners[u[1]], False, False, False)
+    
+    @property
+    def imbalance(self):
+        """Ratio of the largest to the average load at each site."""
+        mean = self.loads.mean(axis=0)
+        ratio = np.ones_like(mean)
+        nz = mean != 0
+        ratio[nz] = self.loads.max(axis=0)[nz] / mean[nz]
+        return ratio
+    
+    @staticmethod
+    def expression_costs(mpo_info, lcp=None):
+        """
+        Measure operator costs from the expressions cached in a sweep.
+        
+        Args:
+            mpo_info : MPOInfo
+                MPOInfo with :attr:`cached_exprs` filled by a sweep (``cache_contraction=True``).
+            lcp : LineCoupling or None
+                If not None, each term is weighted by the square of the block dimension.
+        
+        Returns:
+            costs : dict(OpElement -> float)
+                Number of expression terms of each operator summed over sites and ranks,
+                the same on all ranks.
+        """
+        costs = {}
+        for key, exprs in mpo_info.cached_exprs.items():
+            if len(key) != 2 or not isinstance(exprs, OpCollection):
+                continue
+            i, tag = key
+            w = 1.0
+            if lcp is not None:
+                w = float(sum((lcp.left_dims if tag == '_LEFT' else lcp.right_dims)[i].values())) ** 2
+            for op, expr in exprs.uniq_list:
+                if isinstance(expr, OpShell) or expr == 0:
+                    continue
+                nt = len(expr.strings) if isinstance(expr, OpSum) else 1
+                costs[abs(op)] = costs.get(abs(op), 0.0) + nt * w
+        total = {}
+        for c in comm.allgather(costs):
+            for op, v in c.items():
+                total[op] = total.get(op, 0.0) + v
+        return total
+
+
 class Parallelizer:
     def __init__(self, rule, rank=mpi_rank):
         self.rule = rule
@@ -26,6 +26,11 @@ Block-sparse tensor and tensor network.
 import numpy as np
 from itertools import accumulate, groupby
 
+try:
+    from block.rev import block_tensor_contract
+except ImportError:
+    block_tensor_contract = None
+
 
 class SubTensor:
     """
@@ -505,8 +510,9 @@ class Tensor:
         # then any S q-number operator contract with S=0 operator, the operator q-number index will not change
         # then only need to contract other state representation indices.
         # MPS indices contraction auto handled by CGC. Operator contraction need to specify target.
+        products = {}
+        out_cgs = {}
         if target_q_labels is None:
-            map_idx_out = {}
             for block_a in tsa.blocks:
                 subg = tuple(block_a.q_labels[id] for id in idxa)
                 if subg in map_idx_b:
@@ -514,16 +520,13 @@ class Tensor:
                     for block_b in map_idx_b[subg]:
                         outg = outga + \
                             tuple(block_b.q_labels[id] for id in out_idx_b)
-                        mat = np.tensordot(
-                            block_a.reduced, block_b.reduced, axes=(idxa, idxb))
-                        if outg not in map_idx_out:
-                            cgs = [np.tensordot(cga, cgb, axes=(idxa, idxb))
+                        if outg not in products:
+                            products[outg] = []
+                            out_cgs[outg] = [np.tensordot(cga, cgb, axes=(idxa, idxb))
                                    for cga, cgb in zip(block_a.cgs, block_b.cgs)] \
                                    if block_a.cgs is not None and block_b.cgs is not None else None
-                            map_idx_out[outg] = SubTensor(
-                                q_labels=outg, reduced=mat, cgs=cgs)
-                        else:
-                            map_idx_out[outg].reduced += mat
+                        products[outg].append((block_a.reduced, block_b.reduced))
+            mats = Tensor._tensordot_sum(products, idxa, idxb)
         # non-abelian case (operator blocking case)
         # can only contract one index at a time
         # a rank-3 operator contracted rank-3 operator, in operator q-number index
@@ -532,7 +535,6 @@ class Tensor:
             assert len(idxa) == 1 and len(idxb) == 1
             if not isinstance(target_q_labels, list):
                 target_q_labels = [target_q_labels]
-            map_idx_out = {}
             for target in target_q_labels:
                 for block_a in tsa.blocks:
                     a_rank = tuple(block_a.q_labels[id] for id in idxa)[0]
@@ -549,19 +551,77 @@ class Tensor:
                                     (target, ) + \
                                     tuple(block_b.q_labels[id]
                                           for id in out_idx_b)
-                                mat = np.tensordot(
-                                    block_a.reduced, block_b.reduced, axes=(idxa, idxb))
-                                mat = mat.reshape(
-                                    mat.shape[:len(a_out_ranks)] + (1, ) + mat.shape[len(a_out_ranks):])
-                                if outg not in map_idx_out:
-                                    cgs = [np.tensordot(cga, np.tensordot(cgt, cgb, axes=([1], idxb)), axes=(idxa, [0]))
+                                if outg not in products:
+                                    products[outg] = []
+                                    out_cgs[outg] = [np.tensordot(cga, np.tensordot(cgt, cgb, axes=([1], idxb)), axes=(idxa, [0]))
                                            for cga, cgb, cgt in zip(block_a.cgs, block_b.cgs, target_cgs)]
-                                    map_idx_out[outg] = SubTensor(
-                                        q_labels=outg, reduced=mat, cgs=cgs)
-                                else:
-                                    map_idx_out[outg].reduced += mat
+                                products[outg].append((block_a.reduced, block_b.reduced))
+            mats = Tensor._tensordot_sum(products, idxa, idxb)
+            n_out_a = len(out_idx_a)
+            mats = {outg: mat.reshape(mat.shape[:n_out_a] + (1, ) + mat.shape[n_out_a:])
+                    for outg, mat in mats.items()}
+        map_idx_out = {outg: SubTensor(q_labels=outg, reduced=mats[outg], cgs=out_cgs[outg])
+                       for outg in products}
         return Tensor(list(map_idx_out.values()))
     
+    @staticmethod
+    def _tensordot_sum(products, idxa, idxb):
+        """
+        Sum of block products of a contraction.
+        
+        Args:
+            products : dict(tuple(DirectProdGroup..) -> [(numpy.ndarray, numpy.ndarray)..])
+                For each output block, the list of reduced matrix pairs to be contracted.
+            idxa : list(int)
+                Contracted indices in the first matrix of each pair.
+            idxb : list(int)
+                Contracted indices in the second matrix of each pair.
+        
+        Returns:
+            mats : dict(tuple(DirectProdGroup..) -> numpy.ndarray)
+                For each output block, sum of ``np.tensordot(a, b, axes=(idxa, idxb))`` over its pairs.
+                With the native block.rev module, all products are done as batched GEMMs
+                in one call, different output blocks in parallel.
+        """
+        if block_tensor_contract is None:
+            mats = {}
+            for outg, pairs in products.items():
+                for a, b in pairs:
+                    mat = np.tensordot(a, b, axes=(idxa, idxb))
+                    if outg not in mats:
+                        mats[outg] = mat
+                    else:
+                        mats[outg] += mat
+            return mats
+        
+        def matrix(x, idx, contracted_first, cache):
+            # transposed to (out, idx) or (idx, out) and flattened to 2-d, once for each block
+            if id(x) not in cache:
+                out = [i for i in range(x.ndim) if i not in idx]
+                k = int(np.prod([x.shape[i] for i in idx]))
+                n = int(np.prod([x.shape[i] for i in out]))
+                perm = list(idx) + out if contracted_first else out + list(idx)
+                xm = np.ascontiguousarray(np.transpose(x, perm), dtype=float)
+                xm = xm.reshape((k, n) if contracted_first else (n, k))
+                cache[id(x)] = (len(mlist[contracted_first]), [x.shape[i] for i in out])
+                mlist[contracted_first].append(xm)
+            return cache[id(x)]
+        
+        mlist = {False: [], True: []}
+        cache_a, cache_b = {}, {}
+        mats, cmats, gemms = {}, [], []
+        for outg, pairs in products.items():
+            for a, b in pairs:
+                ia, shape_a = matrix(a, idxa, False, cache_a)
+                ib, shape_b = matrix(b, idxb, True, cache_b)
+                if outg not in mats:
+                    mats[outg] = np.zeros(tuple(shape_a + shape_b))
+                    cmats.append(mats[outg].reshape((mlist[False][ia].shape[0], mlist[True][ib].shape[1])))
+                # the pairs of one output are consecutive, so it is the last one
+                gemms.append((ia, ib, len(cmats) - 1))
+        block_tensor_contract(mlist[False], mlist[True], cmats, gemms)
+        return mats
+    
     def diag_eigs(self, k=-1, limit=None):
         assert self.rank == 2
         blocks = []
@@ -109,6 +109,28 @@ class TwoElectronArray // 2e integral, notation (12|12), symmetric matrix
   private:
     double *rep; //!< underlying storage enforcing real hermitian symmetry.
 
+    // screened storage, see Screen(). The integrals (n|m), m <= n, kept in
+    // row n are pairCol/pairVal[pairStart[n] .. pairStart[n + 1]), sorted by
+    // m. pairMax[n] is the largest kept |(n|m)| over all m.
+    bool screened;
+    std::vector<long> pairStart;
+    std::vector<int> pairCol;
+    std::vector<double> pairVal;
+    std::vector<double> pairMax;
+    // orbMax[i] is the largest pairMax of the pairs (i, k)
+    std::vector<double> orbMax;
+
+    // address of the kept (n|m), n >= m, or 0 if it was screened away
+    const double *FindScreened(long n, long m) const;
+
+    // locality of a model Hamiltonian, see BuildLocality(). The nonzero
+    // integrals operator()(i, j, k, l) of spin orbital i are the triples
+    // localIndex[3 p .. 3 p + 2] = j, k, l with values localVal[p] for p in
+    // [localStart[i], localStart[i + 1]).
+    std::vector<long> localStart;
+    std::vector<int> localIndex;
+    std::vector<double> localVal;
+
     friend class boost::serialization::access;
     template <class Archive>
     void serialize(Archive &ar, const unsigned int version) {
@@ -145,12 +167,12 @@ class TwoElectronArray // 2e integral, notation (12|12), symmetric matrix
 
   public:
     TwoElectronArray()
-        : dim(0), dummyZero(0.0), isCalcLCC(false), rhf(false), permSymm(true),
-          bin(false) {}
+        : screened(false), dim(0), dummyZero(0.0), isCalcLCC(false), rhf(false),
+          permSymm(true), bin(false) {}
 
     TwoElectronArray(bool pLCC, bool pisH0)
-        : dim(0), dummyZero(0.0), isCalcLCC(pLCC), isH0(pisH0), rhf(false),
-          permSymm(true), bin(false) {}
+        : screened(false), dim(0), dummyZero(0.0), isCalcLCC(pLCC),
+          isH0(pisH0), rhf(false), permSymm(true), bin(false) {}
 
     TwoElectronArray(TwoEType twoetype);
 
@@ -167,6 +189,34 @@ class TwoElectronArray // 2e integral, notation (12|12), symmetric matrix
 
     int MapIndices(int n);
 
+    // with compact, drops the integrals with |v| <= thresh and moves the rest
+    // to the pair compressed storage; rep is no longer used (the caller may
+    // release it) and writes through operator() to a dropped integral are
+    // discarded. Without compact only the pair bounds are built.
+    void Screen(double thresh, bool compact);
+    bool Screened() const { return screened; }
+    long StoredIntegrals() const { return pairVal.size(); }
+    bool HasPairBounds() const { return !pairMax.empty(); }
+    // upper bound of |(i k|j l)| over all j, l, for spin orbitals i, k
+    double PairBound(int i, int k) const;
+    // upper bound of |operator()(i, j, k, l)| over all j, k, l
+    double OrbitalBound(int i) const { return orbMax[rhf ? i / 2 : i]; }
+
+    // number of stored (n|m), m <= n, with |(n|m)| > thresh
+    long NonZeroPairs(double thresh) const;
+    // true if there are fewer nonzero (n|m) than pairs n, so that most pair
+    // densities interact with no other one, as for the on-site and near
+    // neighbour interactions of lattice models
+    bool ShortRanged() const { return NonZeroPairs(0.0) < matDim; }
+    // lists the nonzero integrals of every spin orbital, for the screening of
+    // the operators by the orbitals they touch (screen.C) instead of loops
+    // over all orbital triples. Only with permSymm.
+    void BuildLocality();
+    bool HasLocality() const { return !localStart.empty(); }
+    long LocalCount(int i) const { return localStart[i + 1] - localStart[i]; }
+    const int *LocalIndices(int i) const { return &localIndex[3 * localStart[i]]; }
+    const double *LocalValues(int i) const { return &localVal[localStart[i]]; }
+
     virtual void Load(std::string prefix, int index) {}
     virtual void Save(std::string prefix, int index) {}
     virtual double &operator()(int i, int j, int k, int l);
@@ -208,6 +258,10 @@ class PartialTwoElectronArray
 
     void Save(std::string prefix, int index = 0);
 
+    // the slices of OrbIndex from the ranks owning them, with
+    // distributed_integrals
+    void Fetch(int index = 0);
+
     double operator()(int i, int j, int k, int l) const;
 
     double &operator()(int i, int j, int k, int l);
@@ -297,6 +351,9 @@ class CCCCArray {
   private:
     double *rep;
     double dummyZero;
+    // leadMax[i * dim + j] is the largest |w_{ijkl}| over all k, l, for spin
+    // orbitals i, j; see BuildBounds
+    std::vector<double> leadMax;
 
     friend class boost::serialization::access;
     template <class Archive>
@@ -334,6 +391,18 @@ class CCCCArray {
     virtual double operator()(int i, int j, int k, int l) const;
     virtual void set(int i, int j, int k, int l, double value);
 
+    // the bounds of the screening of the BCS operators (screen.C), built
+    // once the integrals are read
+    void BuildBounds();
+    bool HasBounds() const { return !leadMax.empty(); }
+    // upper bound of |w_{ijkl}| over all k, l
+    double LeadBound(int i, int j) const { return leadMax[i * dim + j]; }
+    // over all j, k, l
+    double FirstBound(int i) const {
+        return *std::max_element(leadMax.begin() + i * dim,
+                                 leadMax.begin() + (i + 1) * dim);
+    }
+
     void ReadFromDumpFile(ifstream &dumpFile, int norbs) {
         cerr << "CCCCArray::ReadFromDumpFile not implemented yet!";
         abort();
@@ -372,6 +441,10 @@ class CCCDArray {
     // Matrix repA, repB;
     double *rep;
     double dummyZero;
+    // for spin orbitals, leadMax[i * dim + j] is the largest |w_{ijkl}| over
+    // all k, l, outerMax[i * dim + l] over all j, k, and firstMax[i] and
+    // lastMax[l] over the other three indices; see BuildBounds
+    std::vector<double> leadMax, outerMax, firstMax, lastMax;
 
     friend class boost::serialization::access;
     template <class Archive>
@@ -409,6 +482,17 @@ class CCCDArray {
     virtual double operator()(int i, int j, int k, int l) const;
     virtual void set(int i, int j, int k, int l, double value);
 
+    // the bounds of the screening of the BCS operators (screen.C), built
+    // once the integrals are read
+    void BuildBounds();
+    bool HasBounds() const { return !leadMax.empty(); }
+    // upper bounds of |w_{ijkl}| over all k, l; all j, k; all j, k, l and
+    // all i, j, k
+    double LeadBound(int i, int j) const { return leadMax[i * dim + j]; }
+    double OuterBound(int i, int l) const { return outerMax[i * dim + l]; }
+    double FirstBound(int i) const { return firstMax[i]; }
+    double LastBound(int l) const { return lastMax[l]; }
+
     void ReadFromDumpFile(ifstream &dumpFile, int norbs) {
         cerr << "CCCDArray::ReadFromDumpFile not implemented yet!";
         abort();
@@ -14,6 +14,7 @@ Sandeep Sharma and Garnet K.-L. Chan
 #include <newmatap.h>
 #include <iostream>
 #include <vector>
+#include <utility>
 #include <assert.h>
 #include <stdio.h>
 #include "blas_calls.h"
@@ -45,6 +46,7 @@ public:
   ObjectMatrix (void) : nrs (0), ncs (0), rep () {}
   ObjectMatrix (int s, int t) : nrs (s), ncs (t) { rep.resize (s * t); }
   ObjectMatrix (const ObjectMatrix<T>& m) : nrs (m.nrs), ncs (m.ncs) { rep = m.rep; }
+  ObjectMatrix (ObjectMatrix<T>&& m) noexcept : rep (std::move (m.rep)), nrs (m.nrs), ncs (m.ncs) { m.nrs = m.ncs = 0; }
   T& operator() (int s, int t) 
   { 
     assert ((s >= 0) && (t >= 0) && (s < nrs) && (t < ncs));
@@ -81,6 +83,14 @@ public:
       }
       return *this;
     }
+  ObjectMatrix<T>& operator= (ObjectMatrix<T>&& m) noexcept
+    {
+      if (this != &m) {
+	rep = std::move (m.rep); nrs = m.nrs; ncs = m.ncs;
+	m.rep.clear (); m.nrs = m.ncs = 0;
+      }
+      return *this;
+    }
 
   int ncols () const { return ncs; }
   int nrows () const { return nrs; }
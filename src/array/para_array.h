@@ -32,12 +32,17 @@ namespace SpinAdapted {
 #ifndef SERIAL
 extern boost::mpi::communicator calc;
 #endif
+// owner rank of each operator index, filled by BalanceOperatorDistribution;
+// indices beyond it are dealt round robin
+extern std::vector<int> operatorOwner;
 } // namespace SpinAdapted
 // utility functions for communication
 inline int processorindex(int i) {
 #ifdef SERIAL
     return 0;
 #else
+    if (i < SpinAdapted::operatorOwner.size())
+        return SpinAdapted::operatorOwner[i];
     int size = SpinAdapted::calc.size();
     return i % size;
 #endif
@@ -0,0 +1,245 @@
+#!/usr/bin/env python3
+"""
+Performance regression harness for the block executable.
+
+usage: regression.py --block <executable> [options]
+
+Runs the reference systems of tests/ that have a BLOCK input (hubbard-1d,
+n2-sto3g, c2-block) and synthetic Hubbard chains made from the pattern of
+HUBBARD-L16.FCIDUMP, for every bond dimension of --m and thread count of
+--threads. A run has a fixed schedule and a fixed number of sweeps, so that
+the work does not depend on the convergence. The profile and memory_report
+keywords are set; of every run the wall time, the time of the profiled
+phases (profile.rank0.json, the first two levels of the call tree of the
+main thread), the peak stack and data page memory over the phases
+(memory_report.csv), the peak resident memory and the final energy are kept.
+
+With --update the results are written to the baseline file. Otherwise they
+are compared with it: a run is a regression if its wall time or the time of
+a phase exceeds the baseline by more than --tolerance (relative) and
+--min-time (seconds), or its peak memory by more than --memory-tolerance.
+Runs without a baseline are only reported. The exit status is 1 if there
+was a regression or a run failed.
+
+The systems of tests/compress and tests/ancilla are pyblock scripts, not
+BLOCK inputs, and are not run.
+"""
+
+import argparse
+import csv
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import time
+
+TESTS = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..', 'tests')
+SYSTEMS = ['hubbard-1d', 'n2-sto3g', 'c2-block']
+# replaced by the harness, everything else of tests/<system>/input.txt is kept
+OWN_KEYWORDS = {'schedule', 'maxm', 'maxiter', 'sweep_tol', 'outputlevel', 'prefix',
+                'scratch', 'num_thrds', 'profile', 'memory_report', 'twodot', 'onedot',
+                'twodot_to_onedot'}
+
+
+def read_input(path):
+    """the lines of a BLOCK input without the keywords the harness sets"""
+    lines, in_schedule = [], False
+    for line in open(path):
+        words = line.split()
+        if in_schedule:
+            in_schedule = not (len(words) != 0 and words[0].lower() == 'end')
+            continue
+        if len(words) == 0 or words[0].startswith('#') or words[0].startswith('!'):
+            continue
+        key = words[0].lower()
+        if key == 'schedule':
+            in_schedule = len(words) == 1
+            continue
+        if key not in OWN_KEYWORDS:
+            lines.append(words)
+    return lines
+
+
+def hubbard_fcidump(norb, path):
+    """a chain of norb sites with U and t of HUBBARD-L16.FCIDUMP"""
+    u, t = 0.0, 0.0
+    pattern = os.path.join(TESTS, 'hubbard-1d', 'HUBBARD-L16.FCIDUMP')
+    for line in open(pattern):
+        words = line.split()
+        if len(words) != 5 or not re.match(r'^-?[0-9.]+$', words[0]):
+            continue
+        v, (i, j, k, l) = float(words[0]), map(int, words[1:])
+        if i == j == k == l != 0:
+            u = v
+        elif k == l == 0 and i != j:
+            t = v
+    with open(path, 'w') as f:
+        f.write(' &FCI NORB= %d,NELEC= %d,MS2= 0,\n' % (norb, norb))
+        f.write('  ORBSYM=%s\n' % ','.join(['1'] * norb))
+        f.write('  ISYM=1,\n /\n')
+        for i in range(1, norb + 1):
+            f.write(' %.2f %d %d %d %d\n' % (u, i, i, i, i))
+        for i in range(1, norb):
+            f.write(' %.2f %d %d 0 0\n' % (t, i, i + 1))
+        f.write(' 0.00 0 0 0 0\n')
+
+
+def make_cases(args):
+    """(name, input lines with absolute orbital files) of all systems"""
+    cases = []
+    for system in args.systems:
+        if system.startswith('hubbard-L'):
+            norb = int(system[len('hubbard-L'):])
+            fcidump = os.path.join(args.workdir, 'HUBBARD-L%d.FCIDUMP' % norb)
+            hubbard_fcidump(norb, fcidump)
+            lines = [['sym', 'c1'], ['orbitals', fcidump], ['nelec', str(norb)],
+                     ['spin', '0'], ['irrep', '1'], ['hf_occ', 'integral'], ['noreorder']]
+        else:
+            directory = os.path.join(TESTS, system)
+            lines = read_input(os.path.join(directory, 'input.txt'))
+            for words in lines:
+                if words[0].lower() in ('orbitals', 'fcidump') and len(words) > 1:
+                    words[1] = os.path.abspath(os.path.join(directory, words[1]))
+        cases.append((system, lines))
+    return cases
+
+
+def write_input(path, lines, m, threads, prefix, sweeps):
+    with open(path, 'w') as f:
+        for words in lines:
+            f.write(' '.join(words) + '\n')
+        # the same work in every run: a fixed M and no convergence exit
+        f.write('schedule\n0 %d 1e-5 1e-5\n2 %d 1e-8 0\nend\n' % (m, m))
+        f.write('twodot\nmaxiter %d\nsweep_tol 1e-14\n' % sweeps)
+        f.write('outputlevel 0\nnum_thrds %d\nprefix %s\n' % (threads, prefix))
+        f.write('profile\nmemory_report\n')
+
+
+def phase_times(profile):
+    """time of the first two levels of the call tree of the main thread"""
+    times = {}
+    with open(profile) as f:
+        summary = json.load(f)['summary']
+    if len(summary) == 0:
+        return times
+    for phase in summary[0]['calls']['children']:
+        times[phase['name']] = times.get(phase['name'], 0.0) + phase['time']
+        for sub in phase['children']:
+            name = phase['name'] + '/' + sub['name']
+            times[name] = times.get(name, 0.0) + sub['time']
+    return times
+
+
+def peak_memory(report):
+    peak = 0.0
+    with open(report) as f:
+        for row in csv.DictReader(f):
+            peak = max(peak, float(row['stackmem_gb']) + float(row['datapages_gb']))
+    return peak
+
+
+def run_case(args, name, lines, m, threads):
+    key = '%s/M%d/T%d' % (name, m, threads)
+    prefix = os.path.join(args.workdir, key.replace('/', '_'))
+    shutil.rmtree(prefix, ignore_errors=True)
+    os.makedirs(prefix)
+    conf = os.path.join(prefix, 'dmrg.conf')
+    write_input(conf, lines, m, threads, prefix, args.sweeps)
+    env = dict(os.environ, OMP_NUM_THREADS=str(threads))
+    start = time.time()
+    with open(os.path.join(prefix, 'dmrg.out'), 'w') as out:
+        proc = subprocess.Popen(args.launcher.split() + [args.block, conf], stdout=out,
+                                stderr=subprocess.STDOUT, cwd=prefix, env=env)
+        status, usage = os.wait4(proc.pid, 0)[1:]
+    result = {'wall': time.time() - start, 'rss_gb': usage.ru_maxrss / 1.e6}
+    if status != 0:
+        return key, None
+    energies = re.findall(r'Sweep Energy = *(-?[0-9.]+)', open(os.path.join(prefix, 'dmrg.out')).read())
+    result['energy'] = float(energies[-1]) if len(energies) != 0 else None
+    # the files of rank 0 are in its save prefix
+    result['phases'] = phase_times(os.path.join(prefix, 'node0', 'profile.rank0.json'))
+    result['stack_gb'] = peak_memory(os.path.join(prefix, 'node0', 'memory_report.csv'))
+    return key, result
+
+
+def slower(value, base, args):
+    return value > base * (1 + args.tolerance) and value - base > args.min_time
+
+
+def compare(key, result, base, args):
+    """the regressions of result against base, as lines of a report"""
+    report = []
+    if slower(result['wall'], base['wall'], args):
+        report.append('%s: wall time %.2f s, baseline %.2f s' % (key, result['wall'], base['wall']))
+    for phase, t in sorted(result['phases'].items()):
+        if phase in base['phases'] and slower(t, base['phases'][phase], args):
+            report.append('%s: %s %.2f s, baseline %.2f s' % (key, phase, t, base['phases'][phase]))
+    for mem in ('stack_gb', 'rss_gb'):
+        if result[mem] > base[mem] * (1 + args.memory_tolerance) and result[mem] - base[mem] > 1.e-3:
+            report.append('%s: %s %.4f, baseline %.4f' % (key, mem, result[mem], base[mem]))
+    if result['energy'] is not None and base.get('energy') is not None and \
+            abs(result['energy'] - base['energy']) > args.energy_tolerance:
+        report.append('%s: energy %.10f, baseline %.10f' % (key, result['energy'], base['energy']))
+    return report
+
+
+def main():
+    parser = argparse.ArgumentParser(description='performance regression harness')
+    parser.add_argument('--block', required=True, help='the block executable')
+    parser.add_argument('--launcher', default='', help='e.g. "mpirun -np 2"')
+    parser.add_argument('--workdir', default='benchmark')
+    parser.add_argument('--baseline', default=None, help='default: <workdir>/baseline.json')
+    parser.add_argument('--update', action='store_true', help='write the results as baseline')
+    parser.add_argument('--systems', default=','.join(SYSTEMS + ['hubbard-L24', 'hubbard-L32']),
+                        help='tests/ directories and hubbard-L<n> chains')
+    parser.add_argument('--m', default='100,250', help='bond dimensions')
+    parser.add_argument('--threads', default='1,%d' % min(4, os.cpu_count() or 1))
+    parser.add_argument('--sweeps', type=int, default=4)
+    parser.add_argument('--tolerance', type=float, default=0.2)
+    parser.add_argument('--min-time', type=float, default=0.5)
+    parser.add_argument('--memory-tolerance', type=float, default=0.1)
+    parser.add_argument('--energy-tolerance', type=float, default=1.e-6)
+    args = parser.parse_args()
+    args.block = os.path.abspath(args.block)
+    args.workdir = os.path.abspath(args.workdir)
+    args.systems = args.systems.split(',')
+    baseline_file = args.baseline or os.path.join(args.workdir, 'baseline.json')
+    os.makedirs(args.workdir, exist_ok=True)
+
+    results, failed = {}, []
+    for name, lines in make_cases(args):
+        for m in map(int, args.m.split(',')):
+            for threads in sorted(set(map(int, args.threads.split(',')))):
+                key, result = run_case(args, name, lines, m, threads)
+                if result is None:
+                    failed.append(key)
+                    print('%-28s failed' % key)
+                    continue
+                results[key] = result
+                print('%-28s %8.2f s %8.4f GB stack %8.4f GB rss  E = %s' % (
+                    key, result['wall'], result['stack_gb'], result['rss_gb'], result['energy']))
+
+    if args.update:
+        with open(baseline_file, 'w') as f:
+            json.dump(results, f, indent=1, sort_keys=True)
+        print('baseline written to %s' % baseline_file)
+        return 1 if len(failed) != 0 else 0
+
+    baseline = json.load(open(baseline_file)) if os.path.exists(baseline_file) else {}
+    report = []
+    for key, result in sorted(results.items()):
+        if key in baseline:
+            report += compare(key, result, baseline[key], args)
+        else:
+            print('%-28s has no baseline' % key)
+    for line in report:
+        print('REGRESSION ' + line)
+    for key in failed:
+        print('FAILED ' + key)
+    return 1 if len(report) + len(failed) != 0 else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
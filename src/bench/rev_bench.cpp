@@ -0,0 +1,245 @@
+// Micro-benchmark for the block2 operator kernels in rev/operator_functions.
+//
+// usage: block_bench <input file> [key=value ...]
+//
+// The input file is a regular BLOCK input (symmetry, spin adaptation,
+// memory and thread keywords are taken from it). The operators are
+// synthetic: StateInfos with nquanta quanta per block, the number of
+// states per quantum drawn uniformly from [states * (1 - spread),
+// states * (1 + spread)] with the given seed, and random operator entries.
+//
+// keys: nquanta (8), states (100), spread (0.5), repeat (5), seed (1)
+
+#include "global.h"
+#include "input.h"
+#include "SpinQuantum.h"
+#include "StateInfo.h"
+#include "StackBaseOperator.h"
+#include "Stackwavefunction.h"
+#include "enumerator.h"
+#include "newmat.h"
+#include "rev/data_page.hpp"
+#include "rev/operator_functions.hpp"
+#include <boost/shared_ptr.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace SpinAdapted;
+
+void ReadInput(char *conf);
+
+struct BenchResult {
+    double best, mean;
+};
+
+static double total_flops() {
+    double f = 0;
+    for (size_t i = 0; i < dmrginp.matmultFlops.size(); i++)
+        f += dmrginp.matmultFlops[i];
+    return f;
+}
+
+// run f once as a warm up, then repeat times
+static BenchResult run_kernel(const function<void()> &f, int repeat) {
+    f();
+    BenchResult r = {1E99, 0};
+    for (int i = 0; i < repeat; i++) {
+        auto start = chrono::steady_clock::now();
+        f();
+        double t = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        r.best = min(r.best, t);
+        r.mean += t / repeat;
+    }
+    return r;
+}
+
+// flops is the number of floating point operations of a single call. The
+// element-wise kernels (TensorProduct, TensorTrace, TensorProductDiagonal)
+// do not go through MatrixMultiply, for them one multiply-add per output
+// element is assumed. bytes is the operator data read and written once.
+static void report(const string &name, const BenchResult &r, double flops, double bytes) {
+    printf("%-26s %12.4f %12.4f %10.3f %10.3f\n", name.c_str(), r.best * 1E3,
+           r.mean * 1E3, flops / r.best * 1E-9, bytes / r.best * 1E-9);
+}
+
+static void fill_random(double *data, long n, mt19937 &gen) {
+    uniform_real_distribution<double> dist(-1.0, 1.0);
+    for (long i = 0; i < n; i++)
+        data[i] = dist(gen);
+}
+
+static boost::shared_ptr<StateInfo> make_block(int nquanta, int states, double spread,
+                                             mt19937 &gen) {
+    vector<SpinQuantum> q;
+    vector<int> qs;
+    int lower = max(1, (int)(states * (1 - spread)));
+    int upper = max(lower, (int)(states * (1 + spread)));
+    uniform_int_distribution<int> dist(lower, upper);
+    // particle number n with 2S = n % 2 and n % 2 + 2
+    for (int n = 0; (int)q.size() < nquanta; n++)
+        for (int s = n % 2; s <= n % 2 + 2 && s <= n && (int)q.size() < nquanta; s += 2) {
+            q.push_back(SpinQuantum(n, SpinSpace(s), IrrepSpace(0)));
+            qs.push_back(dist(gen));
+        }
+    return boost::shared_ptr<StateInfo>(new StateInfo(q.size(), &q[0], &qs[0]));
+}
+
+static boost::shared_ptr<StateInfo> make_site() {
+    vector<SpinQuantum> q;
+    q.push_back(SpinQuantum(0, SpinSpace(0), IrrepSpace(0)));
+    q.push_back(SpinQuantum(1, SpinSpace(1), IrrepSpace(0)));
+    if (!dmrginp.spinAdapted())
+        q.push_back(SpinQuantum(1, SpinSpace(-1), IrrepSpace(0)));
+    q.push_back(SpinQuantum(2, SpinSpace(0), IrrepSpace(0)));
+    vector<int> qs(q.size(), 1);
+    return boost::shared_ptr<StateInfo>(new StateInfo(q.size(), &q[0], &qs[0]));
+}
+
+// totally symmetric operator (same quanta as the hamiltonian)
+static void make_operator(StackSparseMatrix &op, const StateInfo &s, mt19937 &gen) {
+    op.set_deltaQuantum() = vector<SpinQuantum>(1, SpinQuantum(0, SpinSpace(0), IrrepSpace(0)));
+    op.set_initialised() = true;
+    op.set_fermion() = false;
+    op.allocate(s);
+    fill_random(op.get_data(), op.set_totalMemory(), gen);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        cerr << "usage: block_bench <input file> [nquanta=8] [states=100] "
+                "[spread=0.5] [repeat=5] [seed=1]" << endl;
+        abort();
+    }
+
+    map<string, double> opts;
+    opts["nquanta"] = 8, opts["states"] = 100, opts["spread"] = 0.5;
+    opts["repeat"] = 5, opts["seed"] = 1;
+    for (int i = 2; i < argc; i++) {
+        string arg = argv[i];
+        size_t eq = arg.find('=');
+        if (eq == string::npos || opts.count(arg.substr(0, eq)) == 0) {
+            cerr << "unknown benchmark option " << arg << endl;
+            abort();
+        }
+        opts[arg.substr(0, eq)] = atof(arg.substr(eq + 1).c_str());
+    }
+    const int nquanta = (int)opts["nquanta"], states = (int)opts["states"];
+    const int repeat = max(1, (int)opts["repeat"]);
+    mt19937 gen((unsigned int)opts["seed"]);
+
+    ReadInput(argv[1]);
+    dmrginp.setOutputlevel() = -1;
+    block2::init_data_pages(1);
+
+    // sys (x) site -> big (collected), sys (x) env -> superblock
+    boost::shared_ptr<StateInfo> sys = make_block(nquanta, states, opts["spread"], gen);
+    boost::shared_ptr<StateInfo> env = make_block(nquanta, states, opts["spread"], gen);
+    boost::shared_ptr<StateInfo> site = make_site();
+    boost::shared_ptr<StateInfo> big(new StateInfo());
+    TensorProduct(*sys, *site, *big, NO_PARTICLE_SPIN_NUMBER_CONSTRAINT);
+    big->CollectQuanta();
+
+    // the target has even particle number and zero spin, as required by
+    // TensorProductDiagonal
+    int nmax = sys->quanta.back().get_n() + env->quanta.back().get_n();
+    SpinQuantum target(nmax / 4 * 2, SpinSpace(0), IrrepSpace(0));
+    boost::shared_ptr<StateInfo> super(new StateInfo());
+    TensorProduct(*sys, *env, target, PARTICLE_SPIN_NUMBER_CONSTRAINT, *super);
+
+    // rotation keeping (at most) states per quantum of big
+    vector<SpinQuantum> newq(big->quanta);
+    vector<int> newqs(big->quantaStates);
+    boost::shared_ptr<vector<Matrix>> rot(new vector<Matrix>(big->quanta.size()));
+    for (int i = 0; i < big->quanta.size(); i++) {
+        newqs[i] = min(newqs[i], states);
+        (*rot)[i].ReSize(big->quantaStates[i], newqs[i]);
+        fill_random((*rot)[i].Store(), (*rot)[i].Storage(), gen);
+    }
+    boost::shared_ptr<StateInfo> newbig(new StateInfo(newq.size(), &newq[0], &newqs[0]));
+
+    StackSparseMatrix sysop, siteop, envop, bigop, bigc, newbigc;
+    make_operator(sysop, *sys, gen);
+    make_operator(siteop, *site, gen);
+    make_operator(envop, *env, gen);
+    make_operator(bigop, *big, gen);
+    make_operator(bigc, *big, gen);
+    make_operator(newbigc, *newbig, gen);
+
+    StackWavefunction c, v;
+    c.initialise(vector<SpinQuantum>(1, target), *sys, *env, true);
+    v.initialise(vector<SpinQuantum>(1, target), *sys, *env, true);
+    fill_random(c.get_data(), c.set_totalMemory(), gen);
+    fill_random(v.get_data(), v.set_totalMemory(), gen);
+    DiagonalMatrix diag(super->totalStates);
+
+    vector<boost::shared_ptr<StateInfo>> big_info(1, big), super_info(1, super);
+    vector<boost::shared_ptr<StateInfo>> rot_info;
+    rot_info.push_back(big), rot_info.push_back(newbig);
+    vector<boost::shared_ptr<vector<Matrix>>> rot_mats(1, rot);
+    const SpinQuantum op_q(0, SpinSpace(0), IrrepSpace(0));
+    const double d = sizeof(double);
+
+    printf("nquanta = %d states = %d spread = %.2f repeat = %d seed = %d quanta_thrds = %d\n",
+           nquanta, states, opts["spread"], repeat, (int)opts["seed"], dmrginp.quanta_thrds());
+    printf("sys states = %d big states = %d superblock states = %d wavefunction size = %ld\n",
+           sys->totalStates, big->totalStates, super->totalStates, c.set_totalMemory());
+    printf("%-26s %12s %12s %10s %10s\n", "kernel", "best (ms)", "mean (ms)", "GFLOP/s", "GB/s");
+
+    BenchResult r;
+    double f0;
+
+    r = run_kernel([&]() { block2::TensorProduct(sysop, siteop, bigc, big_info); }, repeat);
+    report("TensorProduct", r, 2.0 * bigc.set_totalMemory(),
+           d * (sysop.set_totalMemory() + siteop.set_totalMemory() + 2 * bigc.set_totalMemory()));
+
+    r = run_kernel([&]() { block2::TensorTrace(sysop, bigc, big_info, true); }, repeat);
+    report("TensorTrace", r, 2.0 * bigc.set_totalMemory(),
+           d * (sysop.set_totalMemory() + 2 * bigc.set_totalMemory()));
+
+    f0 = total_flops();
+    r = run_kernel([&]() { block2::TensorRotate(bigop, newbigc, rot_info, rot_mats, 1.0); }, repeat);
+    report("TensorRotate", r, 2.0 * (total_flops() - f0) / (repeat + 1),
+           d * (bigop.set_totalMemory() + 2 * newbigc.set_totalMemory()));
+
+    f0 = total_flops();
+    r = run_kernel([&]() {
+        block2::TensorProductMultiply(sysop, envop, c, v, super_info, op_q, 1.0);
+    }, repeat);
+    report("TensorProductMultiply", r, 2.0 * (total_flops() - f0) / (repeat + 1),
+           d * (sysop.set_totalMemory() + envop.set_totalMemory() + c.set_totalMemory() +
+                2 * v.set_totalMemory()));
+
+    block2::TensorProductMultiplyPlan plan(sysop, envop, c, v, super_info, op_q);
+    f0 = total_flops();
+    r = run_kernel([&]() { plan.multiply(sysop, envop, c, v, 1.0); }, repeat);
+    report("TensorProductMultiplyPlan", r, 2.0 * (total_flops() - f0) / (repeat + 1),
+           d * (sysop.set_totalMemory() + envop.set_totalMemory() + c.set_totalMemory() +
+                2 * v.set_totalMemory()));
+
+    r = run_kernel([&]() {
+        block2::TensorProductDiagonal(sysop, envop, diag, super_info, 1.0);
+    }, repeat);
+    report("TensorProductDiagonal", r, 2.0 * super->totalStates,
+           d * (sysop.set_totalMemory() + envop.set_totalMemory() + 2 * super->totalStates));
+
+    v.deallocate();
+    c.deallocate();
+    newbigc.deallocate();
+    bigc.deallocate();
+    bigop.deallocate();
+    envop.deallocate();
+    siteop.deallocate();
+    sysop.deallocate();
+    block2::release_data_pages();
+    return 0;
+}
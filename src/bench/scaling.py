@@ -0,0 +1,236 @@
+#!/usr/bin/env python3
+"""
+Strong and weak scaling benchmark of the block executable over MPI ranks
+and threads.
+
+usage: scaling.py --block <executable> --fcidump <file> [options]
+
+Runs the system of the FCIDUMP for every combination of --ranks,
+--threads (num_thrds), --quanta-thrds and --mkl-thrds, with a fixed
+schedule and a fixed number of sweeps, so that every run does the same work.
+With --weak the bond dimension grows with the number of cores, as the cube
+root since the cost of a sweep step goes as M^3, so that the work per core
+stays the same.
+
+The profile keyword is set, and every rank writes its call tree to
+node<r>/profile.rank<r>.json. Of every configuration the report has
+ - the wall time and the speedup and parallel efficiency against the first
+   configuration of the grid,
+ - the time of the phases (the first two levels of the call tree of the main
+   thread) on the slowest rank and their imbalance, max / mean over ranks,
+ - the communication time (the distributedaccumulate and waitTransfers
+   scopes) and volume (the bytes counted by profileBytes) per rank,
+ - the peak stack memory of rank 0 (memory_report.csv).
+
+The report is written as json (--report) and as csv with one row per
+configuration next to it, for batch schedulers and plotting scripts.
+"""
+
+import argparse
+import csv
+import glob
+import itertools
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import time
+
+COMM_SCOPES = ('distributedaccumulate', 'waitTransfers')
+
+
+def fcidump_header(path):
+    """NORB, NELEC, MS2 and ISYM of the namelist of an FCIDUMP"""
+    header = ''
+    for line in open(path):
+        header += line
+        if '/' in line or '&END' in line.upper():
+            break
+    values = {}
+    for key in ('NORB', 'NELEC', 'MS2', 'ISYM'):
+        match = re.search(key + r'\s*=\s*(-?[0-9]+)', header, re.IGNORECASE)
+        values[key] = int(match.group(1)) if match else None
+    return values
+
+
+def write_input(path, args, m, config, prefix):
+    ranks, threads, quanta, mkl = config
+    header = fcidump_header(args.fcidump)
+    with open(path, 'w') as f:
+        f.write('sym %s\norbitals %s\n' % (args.sym, args.fcidump))
+        f.write('nelec %d\nspin %d\nirrep %d\n' % (header['NELEC'], header['MS2'] or 0,
+                                                    header['ISYM'] or 1))
+        f.write('hf_occ integral\n')
+        if args.extra_input:
+            f.write(open(args.extra_input).read().rstrip() + '\n')
+        # the same work in every run: a fixed M and no convergence exit
+        f.write('schedule\n0 %d 1e-8 0\nend\n' % m)
+        f.write('twodot\nmaxiter %d\nsweep_tol 1e-14\n' % args.sweeps)
+        f.write('outputlevel 0\nnum_thrds %d\nquanta_thrds %d\nmkl_thrds %d\n' %
+                (threads, quanta, mkl))
+        f.write('prefix %s\nprofile\nmemory_report\n' % prefix)
+
+
+def sum_tree(node, names):
+    """time and bytes of the nodes of the given names, not counted twice"""
+    if node['name'] in names:
+        return node['time'], node.get('bytes', 0.0)
+    t, b = 0.0, 0.0
+    for child in node['children']:
+        ct, cb = sum_tree(child, names)
+        t, b = t + ct, b + cb
+    return t, b
+
+
+def read_rank(profile):
+    """phase times, communication time and bytes of one rank"""
+    with open(profile) as f:
+        summary = json.load(f)['summary']
+    phases, comm_time, comm_bytes = {}, 0.0, 0.0
+    for thread in summary:
+        root = thread['calls']
+        comm_bytes += root.get('bytes', 0.0)
+        if thread['tid'] == 0:
+            comm_time = sum_tree(root, COMM_SCOPES)[0]
+            for phase in root['children']:
+                phases[phase['name']] = phases.get(phase['name'], 0.0) + phase['time']
+                for sub in phase['children']:
+                    name = phase['name'] + '/' + sub['name']
+                    phases[name] = phases.get(name, 0.0) + sub['time']
+    return phases, comm_time, comm_bytes
+
+
+def peak_memory(report):
+    peak = 0.0
+    if not os.path.exists(report):
+        return None
+    with open(report) as f:
+        for row in csv.DictReader(f):
+            peak = max(peak, float(row['stackmem_gb']) + float(row['datapages_gb']))
+    return peak
+
+
+def imbalance(values):
+    mean = sum(values) / len(values)
+    return max(values) / mean if mean > 0 else 1.0
+
+
+def run_config(args, m, config):
+    ranks, threads, quanta, mkl = config
+    key = 'R%d/T%d/Q%d/K%d/M%d' % (ranks, threads, quanta, mkl, m)
+    prefix = os.path.join(args.workdir, key.replace('/', '_'))
+    shutil.rmtree(prefix, ignore_errors=True)
+    os.makedirs(prefix)
+    conf = os.path.join(prefix, 'dmrg.conf')
+    write_input(conf, args, m, config, prefix)
+    env = dict(os.environ, OMP_NUM_THREADS=str(threads), MKL_NUM_THREADS=str(mkl))
+    launcher = args.launcher.format(ranks=ranks, threads=threads).split()
+    start = time.time()
+    with open(os.path.join(prefix, 'dmrg.out'), 'w') as out:
+        status = subprocess.call(launcher + [args.block, conf], stdout=out,
+                                 stderr=subprocess.STDOUT, cwd=prefix, env=env)
+    result = {'key': key, 'ranks': ranks, 'num_thrds': threads, 'quanta_thrds': quanta,
+              'mkl_thrds': mkl, 'cores': ranks * threads, 'm': m, 'wall': time.time() - start}
+    if status != 0:
+        result['failed'] = True
+        return result
+    energies = re.findall(r'Sweep Energy = *(-?[0-9.]+)', open(os.path.join(prefix, 'dmrg.out')).read())
+    result['energy'] = float(energies[-1]) if len(energies) != 0 else None
+
+    # the files of rank r are in its save prefix
+    ranks_found = []
+    for profile in glob.glob(os.path.join(prefix, 'node*', 'profile.rank*.json')):
+        ranks_found.append(read_rank(profile))
+    if len(ranks_found) == 0:
+        result['failed'] = True
+        return result
+    names = set()
+    for phases, _, _ in ranks_found:
+        names.update(phases)
+    result['phases'] = {}
+    for name in sorted(names):
+        times = [phases.get(name, 0.0) for phases, _, _ in ranks_found]
+        result['phases'][name] = {'max': max(times), 'imbalance': imbalance(times)}
+    comm_times = [c for _, c, _ in ranks_found]
+    comm_bytes = [b for _, _, b in ranks_found]
+    # the time of the top level phases outside communication
+    busy = [sum(t for n, t in phases.items() if '/' not in n) - c
+            for phases, c, _ in ranks_found]
+    result['comm_time_max'] = max(comm_times)
+    result['comm_gb_total'] = sum(comm_bytes) / 1.e9
+    result['comm_gb_max'] = max(comm_bytes) / 1.e9
+    result['imbalance'] = imbalance(busy)
+    result['stack_gb'] = peak_memory(os.path.join(prefix, 'node0', 'memory_report.csv'))
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description='MPI and OpenMP scaling benchmark')
+    parser.add_argument('--block', required=True, help='the block executable')
+    parser.add_argument('--fcidump', required=True)
+    parser.add_argument('--sym', default='c1', help='point group of the FCIDUMP')
+    parser.add_argument('--extra-input', default=None,
+                        help='file with more keywords for the input, e.g. memory')
+    parser.add_argument('--launcher', default='mpirun -np {ranks}',
+                        help='command before the executable, {ranks} and {threads} are replaced')
+    parser.add_argument('--workdir', default='scaling')
+    parser.add_argument('--report', default=None, help='default: <workdir>/scaling.json')
+    parser.add_argument('--ranks', default='1,2,4')
+    parser.add_argument('--threads', default='1', help='num_thrds')
+    parser.add_argument('--quanta-thrds', default='1')
+    parser.add_argument('--mkl-thrds', default='1')
+    parser.add_argument('--m', type=int, default=250, help='bond dimension (of the first configuration)')
+    parser.add_argument('--weak', action='store_true', help='grow M with the cube root of the cores')
+    parser.add_argument('--sweeps', type=int, default=2)
+    args = parser.parse_args()
+    args.block = os.path.abspath(args.block)
+    args.fcidump = os.path.abspath(args.fcidump)
+    args.workdir = os.path.abspath(args.workdir)
+    report = args.report or os.path.join(args.workdir, 'scaling.json')
+    os.makedirs(args.workdir, exist_ok=True)
+
+    grid = list(itertools.product(*[sorted(set(map(int, v.split(',')))) for v in
+                                    (args.ranks, args.threads, args.quanta_thrds, args.mkl_thrds)]))
+    grid.sort(key=lambda c: (c[0] * c[1], c))
+    results, base = [], None
+    for config in grid:
+        cores = config[0] * config[1]
+        m = args.m
+        if args.weak:
+            m = int(round(args.m * (float(cores) / (grid[0][0] * grid[0][1])) ** (1. / 3)))
+        result = run_config(args, m, config)
+        if not result.get('failed'):
+            if base is None:
+                base = result
+            result['speedup'] = base['wall'] / result['wall']
+            if args.weak:
+                result['efficiency'] = result['speedup']
+            else:
+                result['efficiency'] = result['speedup'] * base['cores'] / cores
+            print('%-24s %8.2f s  speedup %6.2f  efficiency %5.2f  imbalance %5.2f  '
+                  'comm %8.2f s %10.4f GB' % (result['key'], result['wall'], result['speedup'],
+                                                result['efficiency'], result['imbalance'],
+                                                result['comm_time_max'], result['comm_gb_total']))
+        else:
+            print('%-24s failed' % result['key'])
+        results.append(result)
+
+    with open(report, 'w') as f:
+        json.dump({'fcidump': args.fcidump, 'sweeps': args.sweeps, 'weak': args.weak,
+                   'runs': results}, f, indent=1, sort_keys=True)
+    columns = ['key', 'ranks', 'num_thrds', 'quanta_thrds', 'mkl_thrds', 'cores', 'm', 'wall',
+               'speedup', 'efficiency', 'imbalance', 'comm_time_max', 'comm_gb_total',
+               'comm_gb_max', 'stack_gb', 'energy', 'failed']
+    with open(os.path.splitext(report)[0] + '.csv', 'w') as f:
+        writer = csv.DictWriter(f, columns, extrasaction='ignore')
+        writer.writeheader()
+        for result in results:
+            writer.writerow(result)
+    print('report written to %s' % report)
+    return 1 if any(r.get('failed') for r in results) else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
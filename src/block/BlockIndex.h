@@ -0,0 +1,136 @@
+/*
+Developed by Sandeep Sharma and Garnet K.-L. Chan, 2012
+Copyright (c) 2012, Garnet K.-L. Chan
+
+This program is integrated in Molpro with the permission of
+Sandeep Sharma and Garnet K.-L. Chan
+*/
+
+#ifndef SPIN_BLOCK_INDEX_HEADER
+#define SPIN_BLOCK_INDEX_HEADER
+#include <algorithm>
+#include <boost/serialization/split_member.hpp>
+#include <boost/serialization/utility.hpp>
+#include <boost/serialization/vector.hpp>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+namespace SpinAdapted {
+
+// Index from the (row, col) quanta of a nonzero block to its position in
+// StackSparseMatrix::nonZeroBlocks, with the part of the std::map interface
+// used by the operators. Entries are kept in one flat array sorted by (row,
+// col), with CSR style row pointers: a lookup is a binary search within a
+// single row. Blocks are always created row by row, so insert is an append.
+class BlockIndex {
+  public:
+    typedef std::pair<std::pair<int, int>, int> value_type;
+    typedef std::vector<value_type>::const_iterator const_iterator;
+
+  private:
+    std::vector<value_type> elements;
+    // entries of row i are [row_start[i], row_start[i + 1])
+    std::vector<int> row_start;
+
+    friend class boost::serialization::access;
+    template <class Archive>
+    void save(Archive &ar, const unsigned int version) const {
+        ar &elements;
+    }
+    template <class Archive>
+    void load(Archive &ar, const unsigned int version) {
+        ar &elements;
+        build_rows();
+    }
+    BOOST_SERIALIZATION_SPLIT_MEMBER()
+
+    static bool col_less(const value_type &a, int j) {
+        return a.first.second < j;
+    }
+
+    void build_rows() {
+        row_start.clear();
+        if (elements.empty())
+            return;
+        row_start.assign(elements.back().first.first + 2, 0);
+        for (int k = 0; k < elements.size(); k++)
+            row_start[elements[k].first.first + 1]++;
+        for (int i = 1; i < row_start.size(); i++)
+            row_start[i] += row_start[i - 1];
+    }
+
+  public:
+    BlockIndex() {}
+    BlockIndex(const std::map<std::pair<int, int>, int> &m)
+        : elements(m.begin(), m.end()) {
+        build_rows();
+    }
+    operator std::map<std::pair<int, int>, int>() const {
+        return std::map<std::pair<int, int>, int>(elements.begin(),
+                                                  elements.end());
+    }
+
+    // position of (i, j) in elements, or -1
+    int find(int i, int j) const {
+        if (i < 0 || i + 1 >= (int)row_start.size())
+            return -1;
+        std::vector<value_type>::const_iterator p =
+            std::lower_bound(elements.begin() + row_start[i],
+                             elements.begin() + row_start[i + 1], j, col_less);
+        if (p == elements.begin() + row_start[i + 1] || p->first.second != j)
+            return -1;
+        return p - elements.begin();
+    }
+
+    const int &at(const std::pair<int, int> &k) const {
+        int p = find(k.first, k.second);
+        if (p == -1)
+            throw std::out_of_range("BlockIndex::at");
+        return elements[p].second;
+    }
+
+    // same as std::map::insert, an existing key is not overwritten
+    void insert(const value_type &v) {
+        const int i = v.first.first;
+        if (elements.empty() || elements.back().first < v.first) {
+            while ((int)row_start.size() < i + 1)
+                row_start.push_back(elements.size());
+            elements.push_back(v);
+            if ((int)row_start.size() == i + 1)
+                row_start.push_back(elements.size());
+            else
+                row_start.back() = elements.size();
+        } else if (find(i, v.first.second) == -1) {
+            elements.insert(std::lower_bound(elements.begin(), elements.end(),
+                                             value_type(v.first, -1)),
+                            v);
+            build_rows();
+        }
+    }
+
+    int &operator[](const std::pair<int, int> &k) {
+        int p = find(k.first, k.second);
+        if (p == -1) {
+            insert(value_type(k, 0));
+            p = find(k.first, k.second);
+        }
+        return elements[p].second;
+    }
+
+    int count(const std::pair<int, int> &k) const {
+        return find(k.first, k.second) != -1;
+    }
+    void clear() {
+        elements.clear();
+        row_start.clear();
+    }
+    int size() const { return elements.size(); }
+    bool empty() const { return elements.empty(); }
+    const_iterator begin() const { return elements.begin(); }
+    const_iterator end() const { return elements.end(); }
+    const std::vector<value_type> &get_elements() const { return elements; }
+};
+
+} // namespace SpinAdapted
+#endif
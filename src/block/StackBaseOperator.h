@@ -9,6 +9,7 @@ Sandeep Sharma and Garnet K.-L. Chan
 #ifndef SPIN_STACKBASEOPERATOR_HEADER
 #define SPIN_STACKBASEOPERATOR_HEADER
 #include "StackMatrix.h"
+#include "BlockIndex.h"
 #include "ObjectMatrix.h"
 #include "csf.h"
 #include "StateInfo.h"
@@ -54,6 +55,11 @@ template<class T> class Baseoperator  // The abstract class of an operator
 };
 
 
+// order of the nonzero blocks in the data of an operator. The kernels of
+// operatorfunctions.C go through an operator along its columns
+// (getActiveRows), which COLUMN_BLOCK_LAYOUT keeps contiguous
+enum BlockLayout { ROW_BLOCK_LAYOUT, COLUMN_BLOCK_LAYOUT };
+
 class StackSparseMatrix : public Baseoperator<StackMatrix>  // the sparse matrix representation of the operator
 {
  private:
@@ -102,26 +108,54 @@ class StackSparseMatrix : public Baseoperator<StackMatrix>  // the sparse matrix
   std::vector<std::vector<int> > rowCompressedForm;  //the ith vector corresponds to all the non zero blocks in the ith row
   std::vector<std::vector<int> > colCompressedForm;  //the ith vector corresponds to all the non zero blocks in the ith column
   std::vector< std::pair<std::pair<int, int>, StackMatrix> > nonZeroBlocks; //all the nonzero blocks, the first pair is the row and col index
-  std::map< std::pair<int, int>, int> mapToNonZeroBlocks; //the pair of indices will give the element of the nonzeroBlocks with the same pair
+  BlockIndex mapToNonZeroBlocks; //the pair of indices will give the element of the nonzeroBlocks with the same pair
+  mutable double norm; //Frobenius norm of data, valid while normData == data
+  mutable const double* normData;
 
  public:
     double symm_scale;
- StackSparseMatrix() : totalMemory(0), data(0), fermion(false), orbs(2), initialised(false), built(false), built_on_disk(false), Sign(1), conj('n'), symm_scale(1) {};
+ StackSparseMatrix() : totalMemory(0), data(0), fermion(false), orbs(2), initialised(false), built(false), built_on_disk(false), Sign(1), conj('n'), symm_scale(1), norm(0), normData(0) {};
  StackSparseMatrix(const StackSparseMatrix& a) : 
   orbs(a.get_orbs()), deltaQuantum(a.get_deltaQuantum()), fermion(a.get_fermion()), quantum_ladder(a.quantum_ladder), build_pattern(a.build_pattern),
     initialised(a.get_initialised()), allowedQuantaMatrix(a.get_allowedQuantaMatrix()), 
     Sign(a.get_sign()), totalMemory(a.totalMemory), data(a.data), conj('n'), built(a.built),
     rowCompressedForm(a.rowCompressedForm), built_on_disk(a.built_on_disk),
-    colCompressedForm(a.colCompressedForm), nonZeroBlocks(a.nonZeroBlocks), mapToNonZeroBlocks(a.mapToNonZeroBlocks), filename(a.filename), symm_scale(1) {};
+    colCompressedForm(a.colCompressedForm), nonZeroBlocks(a.nonZeroBlocks), mapToNonZeroBlocks(a.mapToNonZeroBlocks), filename(a.filename), symm_scale(1), norm(a.norm), normData(a.normData) {};
+ // as the copy, but taking the index lists of a, which is left without a shell
+ StackSparseMatrix(StackSparseMatrix&& a) noexcept :
+  orbs(std::move(a.orbs)), deltaQuantum(std::move(a.deltaQuantum)), fermion(a.fermion), quantum_ladder(std::move(a.quantum_ladder)), build_pattern(std::move(a.build_pattern)),
+    initialised(a.initialised), allowedQuantaMatrix(std::move(a.allowedQuantaMatrix)),
+    Sign(a.Sign), totalMemory(a.totalMemory), data(a.data), conj('n'), built(a.built),
+    rowCompressedForm(std::move(a.rowCompressedForm)), built_on_disk(a.built_on_disk),
+    colCompressedForm(std::move(a.colCompressedForm)), nonZeroBlocks(std::move(a.nonZeroBlocks)), mapToNonZeroBlocks(std::move(a.mapToNonZeroBlocks)), filename(std::move(a.filename)), symm_scale(1), norm(a.norm), normData(a.normData) {
+   if (a.conj != 'n')
+     for (int i = 0; i < deltaQuantum.size(); ++i)
+       deltaQuantum[i] = -deltaQuantum[i];
+   a.totalMemory = 0; a.data = 0; a.normData = 0;
+ };
 
- StackSparseMatrix(double* pData, long pTotalMemory) : totalMemory(pTotalMemory), data(pData), fermion(false), orbs(2), initialised(false), built(false), built_on_disk(false), Sign(1), conj('n'), symm_scale(1) {};
+ StackSparseMatrix(double* pData, long pTotalMemory) : totalMemory(pTotalMemory), data(pData), fermion(false), orbs(2), initialised(false), built(false), built_on_disk(false), Sign(1), conj('n'), symm_scale(1), norm(0), normData(0) {};
+  // the operator in the file of its filename, or with npdm_op_store under
+  // that key in the operator store
   void SaveThreadSafe() const;
   void LoadThreadSafe(bool allocate);
+  // everything but the data, with totalMemory at the end
+  void SaveShell(std::ostream& ofs) const;
+  void LoadShell(std::istream& ifs);
+  // the members of serialize as a flat metadata record (flatmeta.h) appended
+  // to buf, for the MPI transfers of the operator shells and, with
+  // flat_disk_format, SaveShell. UnpackFlat reads the record of n bytes at
+  // buf; filename and conj are only set with identity.
+  void PackFlat(std::vector<char>& buf) const;
+  void UnpackFlat(const char* buf, size_t n, bool identity = true);
   virtual long memoryUsed() const {return totalMemory;}
   void allocate (const StateInfo& s);
   void allocate (const StateInfo& sl, const StateInfo& sr);
   void allocate (const StateInfo& s, double* pData);
   double* allocate(const StateInfo& rowSI, const StateInfo& colSI, double* pData);
+  // with the blocks of the data in the given order, the other versions use
+  // the layout of the input (column_block_layout)
+  double* allocate(const StateInfo& rowSI, const StateInfo& colSI, double* pData, BlockLayout layout);
   void allocateShell(const StateInfo& rowSI, const StateInfo& colSI);
   void deallocate() ;
   double* allocateOperatorMatrix();
@@ -132,7 +166,10 @@ class StackSparseMatrix : public Baseoperator<StackMatrix>  // the sparse matrix
   double* get_data() {return data;}
   const double* get_data() const {return data;}
   long& set_totalMemory() {return totalMemory;}
-  void set_data(double* pData) {data = pData;}
+  void set_data(double* pData) {data = pData; normData = 0;}
+  // Frobenius norm of the operator, computed once and kept until the
+  // operator is given new memory or cleared
+  virtual double get_norm() const;
   virtual void shallowCopy(const StackSparseMatrix& o) ;
   virtual void deepCopy(const StackSparseMatrix& o) ;
   virtual void deepClearCopy(const StackSparseMatrix& o) ;
@@ -142,7 +179,7 @@ class StackSparseMatrix : public Baseoperator<StackMatrix>  // the sparse matrix
   std::vector<std::pair<std::pair<int, int>, StackMatrix> >& get_nonZeroBlocks() {return nonZeroBlocks;} 
 
   // added for pybind11
-  std::map< std::pair<int, int>, int>& get_mapToNonZeroBlocks() {return mapToNonZeroBlocks;}
+  BlockIndex& get_mapToNonZeroBlocks() {return mapToNonZeroBlocks;}
   const std::vector<std::pair<std::pair<int, int>, StackMatrix> >& get_nonZeroBlocks() const {return nonZeroBlocks;} 
   const std::vector<int>& getActiveRows(int i) const {return conj == 'n' ? colCompressedForm[i] : rowCompressedForm[i];}
   const std::vector<int>& getActiveCols(int i) const {return conj == 'n' ? rowCompressedForm[i] : colCompressedForm[i];}
@@ -201,6 +238,7 @@ class StackSparseMatrix : public Baseoperator<StackMatrix>  // the sparse matrix
 
   friend ostream& operator<<(ostream& os, const StackSparseMatrix& a);
   void operator=(const StackSparseMatrix& m);
+  void operator=(StackSparseMatrix&& m);
   void Randomise();
   void SymmetricRandomise();
   void Normalise(int* success);
@@ -285,7 +323,7 @@ class StackSparseMatrix : public Baseoperator<StackMatrix>  // the sparse matrix
   }
 
  
-  std::map< std::string, std::vector<SpinQuantum> >  get_quantum_ladder() const { return quantum_ladder; }
+  const std::map< std::string, std::vector<SpinQuantum> >& get_quantum_ladder() const { return quantum_ladder; }
   std::map< std::string, std::vector<SpinQuantum> >& set_quantum_ladder() { return quantum_ladder; }
   std::string  get_build_pattern() const { return build_pattern; }
   std::string& set_build_pattern() { return build_pattern; }
@@ -346,6 +384,7 @@ public:
     return q;
   }
   virtual long memoryUsed() const {return opdata->memoryUsed();}
+  virtual double get_norm() const {return opdata->get_norm();}
   const std::vector<int>& getActiveRows(int i) const {return opdata->getActiveCols(i);}
   const std::vector<int>& getActiveCols(int i) const {return opdata->getActiveRows(i);}
   std::vector<int>& getActiveRows(int i)  {return opdata->getActiveCols(i);}
@@ -388,6 +427,21 @@ const StackTransposeview Transpose(StackSparseMatrix& op);
 
 void assignloopblock(StackSpinBlock*& loopblock, StackSpinBlock*& otherblock, StackSpinBlock* leftBlock,
 		     StackSpinBlock* rightBlock);
+// The nonzero blocks of the operators of the deltaQuantum q between row and
+// column StateInfos of these quanta and quantaStates, which all operators of
+// the same quantum type on a block share. Offsets are those of allocate, with
+// the CACHEBUFFER after each block.
+struct StackSparsityPattern {
+  std::vector<std::vector<int> > rowCompressedForm, colCompressedForm;
+  ObjectMatrix<char> allowedQuantaMatrix;
+  std::vector<std::pair<std::pair<int, int>, StackMatrix> > nonZeroBlocks; // data not set
+  std::vector<long> offsets;
+  BlockIndex mapToNonZeroBlocks;
+  long totalMemory;
+};
+// the pattern of (sr, sc, q), made on first use and kept in a cache of the
+// calling thread
+boost::shared_ptr<const StackSparsityPattern> getSparsityPattern(const StateInfo& sr, const StateInfo& sc, const std::vector<SpinQuantum>& q, BlockLayout layout = ROW_BLOCK_LAYOUT);
 long getRequiredMemory(const StateInfo& sr, const StateInfo& sc, const std::vector<SpinQuantum>& q); 
 long getRequiredMemoryForWavefunction(const StateInfo& sr, const StateInfo& sc, const std::vector<SpinQuantum>& q); 
 long getRequiredMemory(const StackSpinBlock& b, const std::vector<SpinQuantum>& q); 
@@ -395,6 +449,10 @@ long getRequiredMemory(const StateInfo& s, const std::vector<SpinQuantum>& q);
 void Normalise(StackSparseMatrix& a, int* success = 0);
 void ScaleAdd(double d, const StackSparseMatrix& a, StackSparseMatrix& b);
 double DotProduct(const StackSparseMatrix& lhs, const StackSparseMatrix& rhs);
+// a and b have the same blocks at the same offsets, packed without gaps, so
+// DotProduct, ScaleAdd and the fused vector kernels of MatrixBLAS.h can work
+// on get_data() as one vector of memoryUsed() elements
+bool sameLayout(const StackSparseMatrix& a, const StackSparseMatrix& b);
 double trace(const StackSparseMatrix& lhs);
 void Scale(double d, StackSparseMatrix& a);
 //void copy(const ObjectMatrix<StackMatrix>& a, ObjectMatrix<StackMatrix>& b);
@@ -405,6 +463,12 @@ void copy(const StackMatrix& a, Matrix& b);
 void copy(const Matrix& a, StackMatrix& b);
 void copy(const Matrix& a, Matrix& b);
 double getStandAlonescaling(SpinQuantum opQ, SpinQuantum leftq, SpinQuantum rightq);
+// d(newQ, newQ') += left[Q]^T b(Q, Q') right[Q'] for every allowed block of d,
+// Q = lnewQuantaMap[newQ] and Q' = rnewQuantaMap[newQ']. The b right products
+// of all blocks go to a per-thread workspace in one batch, then the left
+// products in a second one.
+void RotateOperator(const std::vector<Matrix>& left, const std::vector<int>& lnewQuantaMap, StackSparseMatrix& b,
+		    const std::vector<Matrix>& right, const std::vector<int>& rnewQuantaMap, StackSparseMatrix& d);
 
 } ;
 
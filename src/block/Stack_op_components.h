@@ -32,6 +32,12 @@ Sandeep Sharma and Garnet K.-L. Chan
 namespace SpinAdapted {
 class StackSpinBlock;
 class StateInfo;
+
+// with access_ordered_blocks the operators handed out by the components
+// during the first multiplyH after a restore are recorded, in the order they
+// are asked for, to lay out the next block files (saveBlock.C)
+extern bool recordingOperatorAccess;
+void recordOperatorAccess(const StackSparseMatrix *op);
 //===========================================================================================================================================================
 // choose the type of array for different types of Operators
 
@@ -301,6 +307,17 @@ template <class Op> class StackOp_component : public StackOp_component_base {
     // Use for unique filename for NPDM disk-based operator storage
     static int nIDgenerator;
 
+    template <class V> static void noteAccess(const V &vec) {
+        if (recordingOperatorAccess)
+            for (int p = 0; p < vec.size(); p++)
+                recordOperatorAccess(vec[p].get());
+    }
+    template <class T>
+    static void noteAccess(const boost::shared_ptr<T> &op) {
+        if (recordingOperatorAccess)
+            recordOperatorAccess(op.get());
+    }
+
   public:
     StackOp_component() {
         m_deriv = false;
@@ -447,6 +464,7 @@ template <class Op> class StackOp_component : public StackOp_component_base {
             m_op(i, j, k, l).size());
         for (int p = 0; p < vec.size(); p++)
             vec[p] = m_op(i, j, k, l)[p];
+        noteAccess(vec);
         return vec;
     }
 
@@ -458,6 +476,7 @@ template <class Op> class StackOp_component : public StackOp_component_base {
             m_op(i, j, k, l).size());
         for (int p = 0; p < vec.size(); p++)
             vec[p] = m_op(i, j, k, l)[p];
+        noteAccess(vec);
         return vec;
     }
 
@@ -469,8 +488,10 @@ template <class Op> class StackOp_component : public StackOp_component_base {
         Op *o = 0;
         std::vector<boost::shared_ptr<Op>> &vec = m_op(i, j, k, l);
         for (int p = 0; p < vec.size(); p++) {
-            if (s == vec[p]->get_deltaQuantum())
+            if (s == vec[p]->get_deltaQuantum()) {
+                noteAccess(vec[p]);
                 return m_op(i, j, k, l)[p];
+            }
         }
         return boost::shared_ptr<Op>(o);
     }
@@ -483,8 +504,10 @@ template <class Op> class StackOp_component : public StackOp_component_base {
         Op *o = 0;
         const std::vector<boost::shared_ptr<Op>> &vec = m_op(i, j, k, l);
         for (int p = 0; p < vec.size(); p++)
-            if (s == vec[p]->get_deltaQuantum())
+            if (s == vec[p]->get_deltaQuantum()) {
+                noteAccess(vec[p]);
                 return m_op(i, j, k, l)[p];
+            }
         return boost::shared_ptr<Op>(o);
     }
 
@@ -496,8 +519,10 @@ template <class Op> class StackOp_component : public StackOp_component_base {
         Op *o = 0;
         std::vector<boost::shared_ptr<Op>> &vec = m_op(i, j, k, l);
         for (int p = 0; p < vec.size(); p++) {
-            if (s == vec[p]->get_quantum_ladder())
+            if (s == vec[p]->get_quantum_ladder()) {
+                noteAccess(vec[p]);
                 return m_op(i, j, k, l)[p];
+            }
         }
         return boost::shared_ptr<Op>(o);
     }
@@ -510,8 +535,10 @@ template <class Op> class StackOp_component : public StackOp_component_base {
         Op *o = 0;
         const std::vector<boost::shared_ptr<Op>> &vec = m_op(i, j, k, l);
         for (int p = 0; p < vec.size(); p++)
-            if (s == vec[p]->get_quantum_ladder())
+            if (s == vec[p]->get_quantum_ladder()) {
+                noteAccess(vec[p]);
                 return m_op(i, j, k, l)[p];
+            }
         return boost::shared_ptr<Op>(o);
     }
 };
@@ -47,9 +47,14 @@ public:
       }
     }
   }
+  // with expansion (the H psi of the roots on the root proc) the noise is
+  // built from these vectors instead of the renormalised operators
   void makedensitymatrix(std::vector<StackWavefunction>& wave_solutions, StackSpinBlock &big, const std::vector<double> &wave_weights,
-			 const double noise, const double additional_noise, bool warmup);
+			 const double noise, const double additional_noise, bool warmup,
+			 std::vector<StackWavefunction>* expansion = 0);
   void makedensitymatrix(StackWavefunction& wave_solutions, StackSpinBlock &big, const double &wave_weight);
+  // the weighted density matrices of the roots, in one pass when they share their blocks
+  void addRootDensities(std::vector<StackWavefunction>& wave_solutions, StackSpinBlock &big, const std::vector<double> &wave_weights);
   StackDensityMatrix& operator+=(const StackDensityMatrix& other);
 
   void build(const StackSpinBlock& b){};
@@ -94,6 +94,9 @@ class StackSpinBlock {
     double *data;
     long additionalMemory;
     double *additionaldata;
+    // start of the region of shared_operator_memory used by this block, -1
+    // if none
+    long sharedMark;
 
   public:
     StackSpinBlock(const StateInfo &s, int integralIndex);
@@ -103,6 +106,8 @@ class StackSpinBlock {
 
     // makes a shallow copy
     StackSpinBlock(const StackSpinBlock &b);
+    // the same, taking the StateInfos, sites and operators of b
+    StackSpinBlock(StackSpinBlock &&b) noexcept;
 
     // can only be called after the data has been initialized
     StackSpinBlock(int start, int finish, int integralIndex,
@@ -144,6 +149,8 @@ class StackSpinBlock {
     void sendcompOps(StackOp_component_base &opcomp, int I, int J, int optype,
                      int compsite);
     void recvcompOps(StackOp_component_base &opcomp, int I, int J, int optype);
+    // gives every rank the data of op, which rank fromproc holds
+    void replicateOperator(StackSparseMatrix &op, int fromproc);
 
     // simple functions
     const boost::shared_ptr<TwoElectronArray> get_twoInt() const {
@@ -158,6 +165,7 @@ class StackSpinBlock {
     StateInfo &set_braStateInfo() { return braStateInfo; }
     StateInfo &set_ketStateInfo() { return ketStateInfo; }
     static std::vector<int> make_complement(const std::vector<int> &sites);
+    int environmentCapacity(const std::vector<int> &complementary_sites) const;
     void printOperatorSummary();
     int size() const { return sites.size(); }
     int get_name() const { return name; }
@@ -256,7 +264,12 @@ class StackSpinBlock {
     double *getdata() { return data; }
     void moveToNewMemory(double *pData);
     void operator=(const StackSpinBlock &b);
+    void operator=(StackSpinBlock &&b);
     long build_iterators();
+    // with memory_pressure, keeps out of memory the operator classes needed
+    // to fit the core operators of memory doubles, see pressureOrder, and
+    // returns the memory of those left
+    long fit_operators(long memory);
     void build_operators(std::vector<Csf> &s,
                          std::vector<std::vector<Csf>> &ladders);
     void build_operators();
@@ -268,6 +281,12 @@ class StackSpinBlock {
                                          const StateInfo *bra,
                                          const std::vector<Matrix> &rightMat,
                                          const StateInfo *ket);
+    // as build_and_renormalise_operators, but each operator is rotated on
+    // its own and sent to a scratch file; the stack from pData up is then
+    // released and the operators are read back into it
+    void stream_renormalise_operators(const std::vector<Matrix> &rotateMatrix,
+                                      const StateInfo *newStateInfo,
+                                      double *pData);
     void renormalise_transform(const std::vector<Matrix> &rotateMatrix,
                                const StateInfo *stateinfo);
     void renormalise_transform(const std::vector<Matrix> &leftMat,
@@ -300,6 +319,9 @@ class StackSpinBlock {
     friend ostream &operator<<(ostream &os, const StackSpinBlock &b);
     void multiplyH(StackWavefunction &c, StackWavefunction *v,
                    int num_threads) const;
+    // H applied to a batch of vectors, v[k] = H c[k]
+    void multiplyH(std::vector<StackWavefunction *> &c,
+                   std::vector<StackWavefunction *> &v, int num_threads) const;
     void multiplyH_2index(StackWavefunction &c, StackWavefunction *v,
                           int num_threads) const;
     void multiplyOverlap(StackWavefunction &c, StackWavefunction *v,
@@ -322,7 +344,10 @@ class StackSpinBlock {
         const bool &warmUp, int sweepiter, int currenroot,
         std::vector<StackWavefunction> &lowerStates, StackDensityMatrix *d = 0);
 
-    void transform_operators(std::vector<Matrix> &rotateMatrix);
+    // with pData the new operators are streamed into the memory starting at
+    // pData, everything above which must be free to overwrite
+    void transform_operators(std::vector<Matrix> &rotateMatrix,
+                             double *pData = 0);
     void transform_operators(std::vector<Matrix> &leftrotateMatrix,
                              std::vector<Matrix> &rightrotateMatrix,
                              bool clearRightBlock = true,
@@ -333,11 +358,24 @@ class StackSpinBlock {
                                             bool implicitTranspose);
     // static StackSpinBlock buildBigEdgeBlock (int start, int finish, int
     // p_integralIndex, bool implicitTranspose);
+    // if mapped is true the operator data is mapped from the block file
+    // instead of being read into Stackmem (see also release_mapped)
     static void restore(
         bool forward, const vector<int> &sites, StackSpinBlock &b, int left,
         int right,
-        char *name = 0); // left and right are the bra and ket states and the
-                         // name is the type of the MPO (currently only H)
+        char *name = 0, // left and right are the bra and ket states and the
+                        // name is the type of the MPO (currently only H)
+        bool mapped = false);
+    // unmaps data if it was mapped by restore, returns false otherwise
+    static bool release_mapped(double *data);
+    // with scratch_gc, the block file restore would read is not read again
+    // and is removed at the next savestate
+    static void release_block(bool forward, const vector<int> &sites,
+                              int left, int right, int integralIndex);
+    // starts reading the block file that restore would read in the
+    // background, so that the following restore finds it in the page cache
+    static void prefetch(bool forward, const vector<int> &sites, int left,
+                         int right, int integralIndex);
     static void make_iterator(StackSpinBlock &b, opTypes op, int *data,
                               int oneIndex, int numIndices);
     static void
@@ -345,6 +383,16 @@ class StackSpinBlock {
           int right,
           char *name = 0); // left and right are the bra and ket states and the
                            // name is the type of the MPO (currently only H)
+    // waits until the blocks queued by store with write_behind are on disk
+    static void finish_writes();
+    // writes the blocks kept in memory by block_cache that are not on disk
+    // yet, they stay cached
+    static void flush_block_cache();
+    // with access_ordered_blocks, starts recording the operators that are
+    // used if a block was restored since the last record; true if it did
+    static bool start_access_record();
+    // keeps the order of the record for the next store of the restored blocks
+    static void finish_access_record();
     void Save(std::ofstream &ofs);
     void Load(std::ifstream &ifs);
 };
@@ -353,7 +401,15 @@ double makeRotateMatrix(StackDensityMatrix &tracedMatrix,
                         vector<Matrix> &rotateMatrix, const int &keptstates,
                         const int &keptqstates,
                         std::vector<DiagonalMatrix> *eigs = 0);
+// builds the dot block of every site once and moves its operators out of
+// Stackmem, so that the blocks stay valid across the steps and sweeps
 void initialiseSingleSiteBlocks(std::vector<StackSpinBlock> &stackblocks,
                                 int integralIndex);
+void freeSingleSiteBlocks();
+// the dot block of sites start to end: a copy sharing the operators of the
+// block in singleSiteBlocks if there is one for the site, built otherwise.
+// The operators of a shared block must not be changed.
+StackSpinBlock dotBlock(int start, int end, int integralIndex,
+                        bool implicitTranspose);
 } // namespace SpinAdapted
 #endif
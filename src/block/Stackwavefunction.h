@@ -29,15 +29,19 @@ private:
 public:
  StackWavefunction() : onedot(false), StackSparseMatrix(){}
  StackWavefunction(const StackWavefunction& wf) : StackSparseMatrix(wf), onedot(wf.onedot){}
+ StackWavefunction(StackWavefunction&& wf) noexcept : StackSparseMatrix(std::move(wf)), onedot(wf.onedot){}
 
   void copyData(const StackWavefunction& a);
   void operator=(const StackWavefunction& wf) {StackSparseMatrix::operator=(wf); onedot=wf.onedot;}
+  void operator=(StackWavefunction&& wf) {StackSparseMatrix::operator=(std::move(wf)); onedot=wf.onedot;}
   //ObjectMatrix<StackMatrix>& get_operatorMatrix() {return operatorMatrix;}
   //void OperatorMatrixReference(ObjectMatrix<StackMatrix*>& m, const std::vector<int>& oldToNewStateI, const std::vector<int>& oldToNewStateJ);
   //const ObjectMatrix<StackMatrix>& get_operatorMatrix() const {return operatorMatrix;}
   void initialise(const vector<SpinQuantum>& dQ, const StateInfo& sl, const StateInfo& sr, const bool &onedot_, double* pData, long ptotalMemory);  
   void initialise(const vector<SpinQuantum>& dQ, const StateInfo& sl, const StateInfo& sr, const bool &onedot_);  
   void initialise(const StackWavefunction& w);
+  // same structure as w on memory owned by the caller
+  void initialise(const StackWavefunction& w, double* pData);
 
   virtual void deepCopy(const StackWavefunction& o) ;
   virtual void deepClearCopy(const StackWavefunction& o) ;
@@ -56,13 +60,56 @@ public:
   static void ChangeLastSite(int newLast, int oldLast, int state);
   void LoadWavefunctionInfo (StateInfo &waveInfo, const std::vector<int>& sites, const int wave_num, bool allocateData=false);
   void SaveWavefunctionInfo (const StateInfo &waveInfo, const std::vector<int>& sites, const int wave_num);
+  // file based versions of the above, loading reads both formats
+  void LoadFromFile (const std::string& file, StateInfo &waveInfo, bool allocateData);
+  // with single the data is stored as floats, always in the flat format
+  void SaveToFile (const std::string& file, const StateInfo &waveInfo, bool flat, bool single=false) const;
+  // rewrites a wavefunction file in the flat format
+  static void ConvertFile (const std::string& file);
   double* allocateWfnOperatorMatrix();
 
   void UnCollectQuantaAlongRows(const StateInfo& sRow, const StateInfo& sCol);
   void CollectQuantaAlongRows(const StateInfo& sRow, const StateInfo& sCol); // FIXME what does this function do?
   void CollectQuantaAlongColumns(const StateInfo& sRow, const StateInfo& sCol);
   void UnCollectQuantaAlongColumns(const StateInfo& sRow, const StateInfo& sCol);
+  // w uncollected along the rows without copying it: the uncollected blocks
+  // are ranges of rows of the collected ones and point into the data of w,
+  // which this does not own and must not deallocate
+  void UnCollectedViewAlongRows(const StackWavefunction& w, const StateInfo& sRow, const StateInfo& sCol);
+  // w uncollected along the columns in new memory, gathered from w in one pass
+  void UnCollectedCopyAlongColumns(const StackWavefunction& w, const StateInfo& sRow, const StateInfo& sCol);
   StackWavefunction& operator+=(const StackWavefunction& other);
 };
+
+// the roots of a state averaged calculation, which share their blocks, stored
+// together as [sector][root]: each root's block is column major, so the blocks
+// of a sector form one rows x (nroots*cols) matrix and all the roots enter a
+// density matrix block in a single GEMM
+class StackMultiWavefunction
+{
+private:
+  int nroots;
+  std::vector<std::pair<int, int> > sectors;
+  std::vector<int> rows, cols;
+  std::vector<long> offsets;
+  std::vector<std::vector<int> > rowSectors, colSectors;
+  double* data;
+  long totalMemory;
+public:
+ StackMultiWavefunction() : nroots(0), data(0), totalMemory(0) {}
+
+  // true when the first nroots of roots have the same blocks
+  static bool shareSectors(const std::vector<StackWavefunction>& roots, int nroots);
+  // gathers the roots scaled by scale[i] on the stack of this thread
+  void initialise(const std::vector<StackWavefunction>& roots, const std::vector<double>& scale);
+  void deallocate();
+
+  int get_nroots() const {return nroots;}
+  long memoryUsed() const {return totalMemory;}
+  double* block(int sector, int root) {return data + offsets[sector] + (long)root*rows[sector]*cols[sector];}
+
+  // c += sum over the roots of a a^T
+  void addOwnTranspose(StackSparseMatrix& c) const;
+};
 }
 #endif
@@ -0,0 +1,32 @@
+/*
+Developed by Sandeep Sharma and Garnet K.-L. Chan, 2012
+Copyright (c) 2012, Garnet K.-L. Chan
+
+This program is integrated in Molpro with the permission of
+Sandeep Sharma and Garnet K.-L. Chan
+*/
+
+#ifndef SPIN_ELEMENTCACHE_HEADER_H
+#define SPIN_ELEMENTCACHE_HEADER_H
+
+namespace SpinAdapted {
+
+class StackMatrix;
+class StackSpinBlock;
+class StackSparseMatrix;
+
+// The operators that are not stored (memoryUsed() == 0) are built block by
+// block whenever a product needs them, which in Davidson is once per
+// iteration. With the keyword element_cache the blocks built while a
+// Davidson solver runs (between beginElementCache and endElementCache) are
+// kept, keyed by the operator, row and column, in at most that fraction of
+// the stack memory; the oldest ones are evicted first.
+void beginElementCache();
+void endElementCache();
+
+// m = the block (row, col) of op on b, built or taken from the cache
+void buildElement(const StackSparseMatrix &op, StackMatrix &m, int row,
+                  int col, const StackSpinBlock &b);
+
+} // namespace SpinAdapted
+#endif
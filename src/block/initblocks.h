@@ -24,6 +24,12 @@ void InitStartingBlock(
     const vector<SpinQuantum> &braquanta = vector<SpinQuantum>(),
     const vector<SpinQuantum> &ketquanta = vector<SpinQuantum>());
 
+// a warm-up guess of the system block of size sites that a sweep in this
+// direction passes, the Slater determinants of lowest energy in the quanta
+// that the rest of the lattice complements, as for the warm-up environment
+void InitGuessStartingBlock(StackSpinBlock &startingBlock, const bool &forward,
+                            const int &size, int integralIndex);
+
 void InitNewSystemBlock(StackSpinBlock &system, StackSpinBlock &systemDot,
                         StackSpinBlock &newSystem, int leftState,
                         int rightState, const int &sys_add, const bool &direct,
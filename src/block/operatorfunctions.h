@@ -11,6 +11,9 @@ Sandeep Sharma and Garnet K.-L. Chan
 
 #define TINY 1.e-20
 
+#include <mutex>
+#include <vector>
+
 class DiagonalMatrix;
 namespace SpinAdapted {
 class StackSpinBlock;
@@ -38,12 +41,12 @@ void TensorTrace(const StackSpinBlock *ablock, const StackSparseMatrix &a,
 // TENSOR TRACE A x I -> cD
 void TensorTrace(const StackSpinBlock *ablock, const StackSparseMatrix &a,
                  const StackSpinBlock *cblock, const StateInfo *cstateinfo,
-                 DiagonalMatrix *cDiagonal, double scale);
+                 DiagonalMatrix *cDiagonal, double scale, int num_thrds = 1);
 
 void TensorProduct(const StackSpinBlock *ablock, const StackSparseMatrix &a,
                    const StackSparseMatrix &b, const StackSpinBlock *cblock,
                    const StateInfo *cstateinfo, DiagonalMatrix *cDiagonal,
-                   double scale);
+                   double scale, int num_thrds = 1);
 
 //*****************************************************
 
@@ -72,6 +75,19 @@ void TensorMultiply(const StackSpinBlock *ablock, const StackSparseMatrix &a,
                     const StackSparseMatrix &b, const StackSpinBlock *cblock,
                     StackWavefunction &c, StackWavefunction *v,
                     const SpinQuantum opQ, double scale);
+
+// Screening of the operator pair TensorMultiply above by norms: between
+// beginNormScreening and endNormScreening a product scale (a x b) c with
+// |scale| |a| |b| |c| < tol is skipped. vectors are the wavefunctions c can
+// be, their norms are taken once here.
+void beginNormScreening(double tol,
+                        const std::vector<StackWavefunction *> &vectors);
+void endNormScreening();
+// the number of products seen and of those skipped since the last report,
+// summed over all processes, and the sum of |scale| |a| |b| of the skipped
+// ones averaged over the screened multiplications, which bounds their
+// contribution to the energy
+void takeNormScreeningReport(long &products, long &dropped, double &error);
 //***************************************
 
 //*****************WHEN LOOP BLOCK IS SPLIT*************
@@ -221,8 +237,12 @@ void OperatorScaleAdd(double scaleV, const StackSpinBlock &b,
                       const std::vector<int> &rows,
                       const std::vector<int> &cols);
 
+// c += scale a a^T, the diagonal blocks of c are built with dsyrk. With
+// sectorLocks (one per row quantum of c) several threads can accumulate into
+// the same c.
 void MultiplyWithOwnTranspose(const StackSparseMatrix &a, StackSparseMatrix &c,
-                              double scale);
+                              double scale,
+                              std::vector<std::mutex> *sectorLocks = 0);
 
 void braTensorMultiply(const StackSpinBlock *ablock, const StackSparseMatrix &a,
                        const StackSpinBlock *cblock, StackWavefunction &c,
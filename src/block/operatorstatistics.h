@@ -0,0 +1,38 @@
+/*
+Developed by Sandeep Sharma and Garnet K.-L. Chan, 2012
+Copyright (c) 2012, Garnet K.-L. Chan
+
+This program is integrated in Molpro with the permission of
+Sandeep Sharma and Garnet K.-L. Chan
+*/
+
+#ifndef SPIN_OPERATORSTATISTICS_HEADER_H
+#define SPIN_OPERATORSTATISTICS_HEADER_H
+#include <string>
+#include <vector>
+
+namespace SpinAdapted {
+
+class StackSpinBlock;
+class StackSparseMatrix;
+
+// Statistics of the operators of the blocks, kept with the keyword
+// operator_statistics. Every StackSpinBlock::printOperatorSummary adds a
+// record of the block on this rank: per operator type the operators, their
+// nonzero blocks and memory, and for the core operators the Frobenius norms
+// with a histogram of their decades. multiplyH adds to the latest record of
+// its system and environment how often the operators of each type were
+// applied, so a record is the block at one sweep position together with the
+// products it took part in.
+
+// adds a record of the operators of b
+void recordOperatorStatistics(StackSpinBlock &b);
+// adds uses applications of each of ops to the records of left and right
+void countOperatorUses(StackSpinBlock &left, StackSpinBlock &right,
+                       const std::vector<const StackSparseMatrix *> &ops,
+                       long uses);
+// writes the records as JSON, one line per record
+void writeOperatorStatistics(const std::string &file);
+
+} // namespace SpinAdapted
+#endif
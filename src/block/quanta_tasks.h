@@ -0,0 +1,61 @@
+/*
+Developed by Sandeep Sharma and Garnet K.-L. Chan, 2012
+Copyright (c) 2012, Garnet K.-L. Chan
+
+This program is integrated in Molpro with the permission of
+Sandeep Sharma and Garnet K.-L. Chan
+*/
+
+#ifndef SPIN_QUANTA_TASKS_HEADER_H
+#define SPIN_QUANTA_TASKS_HEADER_H
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace SpinAdapted {
+
+// The loop over the quanta blocks of an operator kernel, with up to threads
+// (quanta_thrds) parts running at once. body(i, slot) does block i, slot is
+// below threads and unique among the running parts, for the per thread
+// scratch that was indexed by the rank in the nested team.
+//
+// The kernels are mostly called from the operator loops of multiplyH and of
+// the blocking, where opening a nested team for each call costs more than the
+// few blocks it shares out. Inside such a region the loop runs inline with one
+// thread, and otherwise as tasks of the enclosing team that take the blocks
+// from one counter, so the threads already running pick them up when they are
+// idle. Only outside of a parallel region is a team forked for the loop.
+template <class Body>
+void parallelQuanta(int n, int threads, const Body &body) {
+#ifdef _OPENMP
+    if (threads > 1 && n > 1) {
+        if (!omp_in_parallel()) {
+#pragma omp parallel for schedule(dynamic) num_threads(threads)
+            for (int i = 0; i < n; i++)
+                body(i, omp_get_thread_num());
+            return;
+        }
+        int next = 0;
+        const int parts = std::min(threads, n);
+        for (int slot = 0; slot < parts; slot++) {
+#pragma omp task default(shared) firstprivate(slot)
+            while (true) {
+                int i;
+#pragma omp atomic capture
+                i = next++;
+                if (i >= n)
+                    break;
+                body(i, slot);
+            }
+        }
+#pragma omp taskwait
+        return;
+    }
+#endif
+    for (int i = 0; i < n; i++)
+        body(i, 0);
+}
+
+} // namespace SpinAdapted
+#endif
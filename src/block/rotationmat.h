@@ -9,6 +9,7 @@ Sandeep Sharma and Garnet K.-L. Chan
 
 #ifndef SPIN_ROTATION_MAT_HEADER
 #define SPIN_ROTATION_MAT_HEADER 
+#include <string>
 #include <vector>
 #include "multiarray.h"
 
@@ -18,8 +19,19 @@ namespace SpinAdapted{
   void UnCollectQuantaAlongRows(std::vector<Matrix>& rotation, const StateInfo&  sRow);
   void CollectQuantaAlongRows(std::vector<Matrix>& rotation, const StateInfo&  sRow);
 void SaveRotationMatrix (const std::vector<int>& sites, const std::vector<Matrix>& m1, int state =-1);
+// the same from row major blocks in memory owned by the caller, data[i] holds
+// shapes[i].first x shapes[i].second doubles; always in the flat format
+void SaveRotationMatrix (const std::vector<int>& sites, const std::vector<std::pair<int, int> >& shapes, const std::vector<const double*>& data, int state =-1);
 void LoadRotationMatrix (const std::vector<int>& sites, std::vector<Matrix>& m1, int state=-1);
+// the file the rotation matrix of sites and state is saved in on this rank
+std::string RotationMatrixFile (const std::vector<int>& sites, int state=-1);
+// rewrites a rotation matrix file in the flat format
+void ConvertRotationMatrixFile(const std::string& file);
 void diagonalise_dm(StackSparseMatrix& tracedMatrix, std::vector<DiagonalMatrix>& eigenMatrix);
+// largest nwanted eigenpairs of every sector of the traced matrix from a
+// randomised range finder, exact where it does not pay off; unresolved is the
+// weight of the spectrum that was not computed
+void randomised_diagonalise_dm(StackSparseMatrix& tracedMatrix, std::vector<DiagonalMatrix>& eigenMatrix, int nwanted, int oversampling, double& unresolved);
 void svd_densitymat(StackSparseMatrix& tracedMatrix, std::vector<DiagonalMatrix>& eigenMatrix);
 void svd_densitymat(StackSparseMatrix& tracedMatrix, std::vector<Matrix>& U, std::vector<DiagonalMatrix>& eigenMatrix, std::vector<Matrix>& V);
 void sort_weights(std::vector<DiagonalMatrix>& eigenMatrix, vector<pair<int, int> >& inorderwts, vector<vector<int> >& weightsbyquanta);
@@ -80,6 +80,24 @@ void transform_previous_wavefunction(StackWavefunction &trial,
                                      const bool &onedt,
                                      const bool &transpose_guess_wave,
                                      bool ket);
+// as transform_previous_wavefunction, with the wave file wave, rotated with the
+// rotation matrices of state
+void transform_saved_wavefunction(StackWavefunction &trial,
+                                  const StackSpinBlock &big, const int wave,
+                                  const int state, const bool &onedot,
+                                  const bool &transpose_guess_wave);
+
+// davidson_warm_vectors: the Ritz vectors next to the roots are saved with the
+// wavefunctions of the site, and at the next site guess_warm_vectors
+// transforms them the same way into solution[nroots], solution[nroots+1], ...,
+// which it allocates. Returns their number, 0 if the saved ones do not belong
+// to the previous site.
+void save_warm_vectors(std::vector<StackWavefunction> &warm,
+                       const StateInfo &waveInfo, const std::vector<int> &sites,
+                       int state);
+int guess_warm_vectors(std::vector<StackWavefunction> &solution, int nroots,
+                       const StackSpinBlock &big, const bool &onedot,
+                       const bool &transpose_guess_wave, int state);
 void transform_previous_wavefunction(StackWavefunction &trial,
                                      const StateInfo &stateInfo,
                                      const std::vector<int> &leftsites,
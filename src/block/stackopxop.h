@@ -20,7 +20,7 @@ namespace stackopxop
 
 
   void cdxcdcomp_d(const StackSpinBlock* otherblock, boost::shared_ptr<StackSparseMatrix> op1, const StackSpinBlock* b, DiagonalMatrix* e);
-  void ham_d(const StackSpinBlock* otherblock, boost::shared_ptr<StackSparseMatrix> op1, const StackSpinBlock* b, DiagonalMatrix* e, int proc);
+  void ham_d(const StackSpinBlock* otherblock, boost::shared_ptr<StackSparseMatrix> op1, const StackSpinBlock* b, DiagonalMatrix* e, int proc, int num_thrds=1);
   
  
   void cxcdcomp(const StackSpinBlock* otherblock, const std::vector< boost::shared_ptr<StackSparseMatrix> >& op1, const StackSpinBlock* b, int I, StackSparseMatrix* o, double factor);
@@ -37,6 +37,18 @@ namespace stackopxop
   void cdxcdcomp(const StackSpinBlock* otherblock, boost::shared_ptr<StackSparseMatrix> op1, const StackSpinBlock* b, StackWavefunction& c, StackWavefunction* v, const SpinQuantum& q);
   void ddxcccomp(const StackSpinBlock* otherblock, boost::shared_ptr<StackSparseMatrix> op1, const StackSpinBlock* b, StackWavefunction& c, StackWavefunction* v, const SpinQuantum& q); 
 
+  // one product factor * other x loop that cdxcdcomp or ddxcccomp applies, of
+  // the transposes if transpose is set
+  struct TwoIndexProduct {
+    boost::shared_ptr<StackSparseMatrix> loop, other;
+    double factor;
+    bool transpose;
+  };
+  // the products of op1 of the loop block, for other blocks without the
+  // DES_CRECOMP and CRE_CRECOMP operators
+  void cdxcdcompProducts(const StackSpinBlock* otherblock, boost::shared_ptr<StackSparseMatrix> op1, const StackSpinBlock* b, std::vector<TwoIndexProduct>& products);
+  void ddxcccompProducts(const StackSpinBlock* otherblock, boost::shared_ptr<StackSparseMatrix> op1, const StackSpinBlock* b, std::vector<TwoIndexProduct>& products);
+
   void CreonLeft(boost::shared_ptr<StackSparseMatrix> op1, int luncollectedQPrime, const StackSpinBlock* b, StackWavefunction& c, StackWavefunction* v, const SpinQuantum& q);
   void OverlaponLeft(boost::shared_ptr<StackSparseMatrix> op1, int luncollectedQPrime, const StackSpinBlock* b, StackWavefunction& c, StackWavefunction* v, const SpinQuantum& q);
   void CreDesonLeft(boost::shared_ptr<StackSparseMatrix> op1, int luncollectedQPrime, const StackSpinBlock* cblock, StackWavefunction& c, StackWavefunction* v, const SpinQuantum& q);
@@ -11,6 +11,8 @@ Sandeep Sharma and Garnet K.-L. Chan
 #include "math.h"
 //#include "global.h"
 #include <vector>
+#include <algorithm>
+#include <cstdlib>
 #include "newmatutils.h"
 #include <boost/archive/binary_iarchive.hpp>
 #include <boost/archive/binary_oarchive.hpp>
@@ -64,24 +66,79 @@ class ninejCoeffs{
 };
 
 
+// Tables of the Clebsch-Gordan and 6j coefficients for all 2j < maxj, built
+// once after the input is read (see ReadInput) and only read afterwards, so
+// the threads share them without locking. Arguments outside the tables go to
+// clebsch/six_j. Without spin adaptation the tables stay empty, since clebsch
+// then follows the Sz rule.
+class couplingTable {
+  private:
+    int maxj;
+    // offset of the (ma, mb) block of (ja, jb, jc)
+    vector<int> cgOffset;
+    vector<double> cgData;
+    // offset of the (c, f) block of (a, b, d, e)
+    vector<int> sixjOffset;
+    vector<double> sixjData;
+
+  public:
+    static couplingTable table;
+    couplingTable() : maxj(0) {}
+    void init(int maxj_);
+    int get_maxj() const { return maxj; }
+
+    double clebschGordan(int ja, int jb, int jc, int ma, int mb,
+                         int mc) const {
+        if (ja < 0 || jb < 0 || ja >= maxj || jb >= maxj)
+            return clebsch(ja, ma, jb, mb, jc, mc);
+        if (ma + mb != mc)
+            return 0.0;
+        const int jmin = abs(ja - jb);
+        if (jc < jmin || jc > ja + jb || (jc - jmin) % 2 != 0 ||
+            abs(ma) > ja || (ja + ma) % 2 != 0 || abs(mb) > jb ||
+            (jb + mb) % 2 != 0)
+            return clebsch(ja, ma, jb, mb, jc, mc);
+        return cgData[cgOffset[(ja * maxj + jb) * maxj + (jc - jmin) / 2] +
+                      (ja + ma) / 2 * (jb + 1) + (jb + mb) / 2];
+    }
+
+    // {a b c; d e f}: c couples a, b and d, e; f couples a, e and b, d
+    double sixjSymbol(int a, int b, int c, int d, int e, int f) const {
+        if (a < 0 || b < 0 || d < 0 || e < 0 || a >= maxj || b >= maxj ||
+            d >= maxj || e >= maxj)
+            return six_j(a, b, c, d, e, f);
+        const int cmin = max(abs(a - b), abs(d - e)),
+                  cmax = min(a + b, d + e);
+        const int fmin = max(abs(a - e), abs(b - d)),
+                  fmax = min(a + e, b + d);
+        if (c < cmin || c > cmax || (c - cmin) % 2 != 0 || f < fmin ||
+            f > fmax || (f - fmin) % 2 != 0)
+            return 0.0;
+        const int off = sixjOffset[((a * maxj + b) * maxj + d) * maxj + e];
+        if (off < 0)
+            return 0.0;
+        return sixjData[off + (c - cmin) / 2 * ((fmax - fmin) / 2 + 1) +
+                        (f - fmin) / 2];
+    }
+};
+
 inline double cg(int two_ja, int two_jb, int two_jc, int two_ma, int two_mb, int two_mc)
 {
   //double rval = cleb_(two_ja, two_ma, two_jb, two_mb, two_jc, two_mc);
-  double rval = clebsch(two_ja, two_ma, two_jb, two_mb, two_jc, two_mc);
-  return rval;
+  return couplingTable::table.clebschGordan(two_ja, two_jb, two_jc, two_ma, two_mb, two_mc);
 }
 
 
 inline double sixj(int two_ja, int two_jb, int two_jc, int two_jd, int two_je, int two_jf)
 {
   //return sixj_(two_ja, two_jb, two_jc, two_jd, two_je, two_jf);
-  return six_j(two_ja, two_jb, two_jc, two_jd, two_je, two_jf);
+  return couplingTable::table.sixjSymbol(two_ja, two_jb, two_jc, two_jd, two_je, two_jf);
 }
 
 
 inline double racah(int a, int b, int c, int d, int e, int f)
 {
-  double rval = pow(-1.0, static_cast<int>((a+b+c+d)/2))*sixj(a, b, e, d, c, f);
+  double rval = (((a+b+c+d)/2) % 2 == 0 ? 1.0 : -1.0)*sixj(a, b, e, d, c, f);
   return rval;
 }
 
@@ -14,6 +14,12 @@ Sandeep Sharma and Garnet K.-L. Chan
 #include <algorithm>
 #include <assert.h>
 
+// number of 64 bit words of an Orbstring, the largest number of spin
+// orbitals is 64*ORBSTRING_WORDS
+#ifndef ORBSTRING_WORDS
+#define ORBSTRING_WORDS 8
+#endif
+
 using namespace std;
 namespace SpinAdapted{
 
@@ -21,39 +27,51 @@ namespace SpinAdapted{
 class Orbstring
 {
 private:
-  std::vector<bool> occ_rep;
+  // spin orbital i is bit i%64 of word i/64, bits beyond nbits are zero
+  unsigned long long occ_words[ORBSTRING_WORDS];
+  int nbits;
   int sign;
   bool empty;
 
+  inline void resize (const int sz)
+  {
+    assert ((sz >= 0) && (sz <= max_size));
+    nbits = sz;
+    std::fill (occ_words, occ_words + ORBSTRING_WORDS, 0ULL);
+  }
+  inline int nwords () const { return (nbits + 63) / 64; }
+
 public:
+  static const int max_size = 64 * ORBSTRING_WORDS;
+
   static void init (const int o);
   Orbstring ();
   inline Orbstring (const std::vector<bool>& occ, const int sn = 1) 
-    : occ_rep (occ), sign (sn), empty (false)
+    : sign (sn), empty (false)
   {
-    // a little fix for IBMs xlC, see notes in Orbstring::distribute 
-    for (int i = 0; i < occ_rep.size (); ++i) occ_rep [i] = abs (occ_rep [i]);   
+    resize (occ.size ());
+    for (int i = 0; i < nbits; ++i) if (occ [i]) set (i, 1);
   }
   
   inline Orbstring (const bool* occ, const int sz, const int sn = 1) 
     : sign (sn), empty (false)
   {
-    occ_rep.resize (sz);
+    resize (sz);
     for (int i = 0; i < sz; ++i)
       {
 	assert ((occ[i] == 1) || (occ[i] == 0));
-	occ_rep [i] = occ [i];
+	if (occ [i]) set (i, 1);
       }
   }
 
   inline Orbstring (const int* occ, const int sz, const int sn = 1) 
     : sign (sn), empty (false)
   {
-    occ_rep.resize (sz);
+    resize (sz);
     for (int i = 0; i < sz; ++i)
       {
 	assert ((occ[i] == 1) || (occ[i] == 0));
-	occ_rep [i] = occ [i]? 0 : 1;
+	if (!occ [i]) set (i, 1);
       }
   }
 
@@ -70,17 +88,25 @@ public:
   inline Orbstring (const int sz, const int sn = 1)
     : sign (sn), empty (false)
   {
-    occ_rep.resize (sz);
+    resize (sz);
   }
 
-  const std::vector<bool> &get_occ_rep() const { return occ_rep; }
-  std::vector<bool> &get_occ_rep() { return occ_rep; }
-
-  Orbstring (const Orbstring& o) : sign (o.sign), empty (o.empty), occ_rep (o.occ_rep) {}
-  void operator= (const Orbstring& o) { if (this != &o) {sign = o.sign; empty = o.empty; occ_rep = o.occ_rep;} }
+  // unpacked copy of the occupations
+  std::vector<bool> get_occ_rep() const
+  {
+    std::vector<bool> occ (nbits);
+    for (int i = 0; i < nbits; ++i) occ [i] = (*this)[i];
+    return occ;
+  }
+  int occ_size () const { return nbits; }
 
-  inline vector<bool>::reference operator[] (int i) { return occ_rep[i]; }
-  inline bool operator[] (int i) const { return occ_rep[i]; }
+  inline bool operator[] (int i) const { return (occ_words [i >> 6] >> (i & 63)) & 1ULL; }
+  inline void set (int i, bool o)
+  {
+    assert ((i >= 0) && (i < nbits));
+    if (o) occ_words [i >> 6] |= 1ULL << (i & 63);
+    else occ_words [i >> 6] &= ~(1ULL << (i & 63));
+  }
 
   int size () const;
 
@@ -88,38 +114,79 @@ public:
   Orbstring& c (int i);
   Orbstring& d (int i);  // applies destruction operator i to ket
 
-  inline int parity (int i)
+  // number of occupied orbitals below i, and in the whole string
+  inline int count (int i) const
+  {
+    int p = 0;
+    for (int w = 0; w < (i >> 6); ++w) p += __builtin_popcountll (occ_words [w]);
+    if (i & 63) p += __builtin_popcountll (occ_words [i >> 6] & ((1ULL << (i & 63)) - 1));
+    return p;
+  }
+  inline int count () const
   {
     int p = 0;
-    for (int j = 0; j < i; j++)
-      if (occ_rep[j]) ++p;
-    return (p%2) ? -1 : 1;
+    for (int w = 0; w < nwords (); ++w) p += __builtin_popcountll (occ_words [w]);
+    return p;
+  }
+
+  inline int parity (int i) const
+  {
+    return (count (i) & 1) ? -1 : 1;
+  }
+
+  // same size and occupations, the sign and emptiness are not compared
+  inline bool same_occ (const Orbstring& s) const
+  {
+    if (nbits != s.nbits) return false;
+    for (int w = 0; w < nwords (); ++w)
+      if (occ_words [w] != s.occ_words [w]) return false;
+    return true;
   }
 
-  inline int trace (const Orbstring& s)
+  // orders by the highest orbital where the occupations differ
+  inline bool occ_less (const Orbstring& s) const
+  {
+    for (int w = std::max (nwords (), s.nwords ()) - 1; w >= 0; --w)
+      if (occ_words [w] != s.occ_words [w])
+	return occ_words [w] < s.occ_words [w];
+    return false;
+  }
+
+  inline std::size_t hash () const
+  {
+    std::size_t h = nbits;
+    for (int w = 0; w < nwords (); ++w)
+      h ^= occ_words [w] + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    return h;
+  }
+
+  // orbitals [begin, end) as a string of their own
+  Orbstring substring (int begin, int end) const;
+
+  inline int trace (const Orbstring& s) const
   {
     if (this->empty || s.empty)
       return 0;
     else
-      return this->sign * s.sign * (occ_rep == s.occ_rep);
+      return this->sign * s.sign * same_occ (s);
   }
 
   void clear ()
   {
     sign = 1;
-    for (int i = 0; i < occ_rep.size (); ++i) occ_rep [i] = 0;
+    std::fill (occ_words, occ_words + ORBSTRING_WORDS, 0ULL);
   }
 
   // returns a list of creation cv and destruction operators dv
   // to produce this state from s (with arbitrary parity)
   void connect (const Orbstring& s, std::vector<int>& cv, std::vector<int>& dv) const
   {
-    for (int i = 0; i < occ_rep.size(); ++i)
+    for (int w = 0; w < nwords (); ++w)
       {
-	if (occ_rep[i] && !s.occ_rep[i])
-	  cv.push_back(i);
-	else if (s.occ_rep[i] && !occ_rep[i])
-	  dv.push_back(i);
+	for (unsigned long long b = occ_words [w] & ~s.occ_words [w]; b; b &= b - 1)
+	  cv.push_back (64 * w + __builtin_ctzll (b));
+	for (unsigned long long b = s.occ_words [w] & ~occ_words [w]; b; b &= b - 1)
+	  dv.push_back (64 * w + __builtin_ctzll (b));
       }
   }
 
@@ -133,9 +200,9 @@ public:
 	else
 	  os << "-" << " ";
 	
-	for (int i = 0; i < s.occ_rep.size(); ++i)
+	for (int i = 0; i < s.nbits; ++i)
 	  {
-	    if (s.occ_rep[i])
+	    if (s[i])
 	      os << 1 << " ";
 	    else
 	      os << 0 << " ";
@@ -0,0 +1,29 @@
+/*
+Developed by Sandeep Sharma and Garnet K.-L. Chan, 2012
+Copyright (c) 2012, Garnet K.-L. Chan
+
+This program is integrated in Molpro with the permission of
+Sandeep Sharma and Garnet K.-L. Chan
+*/
+
+#ifndef SPIN_EXPECTATION_HEADER_H
+#define SPIN_EXPECTATION_HEADER_H
+#include <newmat.h>
+#include <vector>
+
+namespace SpinAdapted {
+
+// <psi|H_k|psi> / <psi|psi> of the stored states, one column for every
+// integral set k given to the orbitals keyword, with its core energy. The
+// states are read left canonical, from their rotation matrices and last
+// wavefunction: for every integral set the blocks are built once per site
+// for all the states, and there is no Davidson step or decimation.
+void calcExpectationValues(const std::vector<int> &states, Matrix &energies);
+
+// the expectation values for the nroots states, printed with their change
+// from the first integral set and written to expectation.e in the save
+// prefix, one line per state
+void expectationSweep();
+
+} // namespace SpinAdapted
+#endif
@@ -32,6 +32,7 @@ class MPS{
   StackWavefunction w; //the last wavefunction
 
   void Init(std::vector<bool>& occ);
+  void contractCoefficients(const std::vector< std::vector<bool> >& occs, std::vector<double>& coeffs) const;
  public:
   static int sweepIters;
   static bool spinAdapted;
@@ -48,11 +49,23 @@ class MPS{
   const StackWavefunction& getw() const {return w;}
   void scale(double r) {Scale(r, w);}
   void normalize() {int success; w.Normalise(&success);}
-  double get_coefficient(const vector<bool>& occ_strings);
+  // CI coefficient of the determinant occ (spin orbital occupations, alpha
+  // before beta of each orbital) in a non spin adapted MPS read from DMRG;
+  // it is evaluated on rank 0, where the rotation matrices are, and
+  // broadcast
+  double get_coefficient(const vector<bool>& occ_strings) const;
+  // the coefficients of many determinants: they are sorted so that the left
+  // contraction of a common prefix is done once, and the sorted list is
+  // split between the threads
+  void get_coefficients(const std::vector< std::vector<bool> >& occs, std::vector<double>& coeffs) const;
   void writeToDiskForDMRG(int state, bool writeStateAverage=false);
 };
 
 
+ // unpacks the occupations of a determinant given as length words, the
+ // first spin orbital is the highest bit of the first word
+ void OccupationsFromBits(const ulonglong* occnum, int length, std::vector<bool>& occ);
+
  //statea is multiplied with Operator O|Mpsa> and then we compress it to get stateb
  //void compressOperatorTimesMPS(const MPS& statea, MPS& stateb);
 
@@ -62,6 +75,14 @@ class MPS{
  //calculate hamiltonian matrix between a and b <Mpsa|H|Mpsb>
  void calcHamiltonianAndOverlap(int statea, int stateb, double& h, double& o, bool sameStates=false, int integralIndex=0) ;
 
+ //the hamiltonian and overlap matrices between all the states, in one sweep
+ //that carries the blocks of all pairs at once: the dot blocks, rotation
+ //matrices and wavefunctions are made or read once per site and state instead
+ //of once per pair. The memory is that of all the pair blocks together.
+ //With diagonal only the pairs of a state with itself are done and the
+ //other elements are left zero.
+ void calcHamiltonianAndOverlapMatrices(const std::vector<int>& states, Matrix& h, Matrix& o, int integralIndex=0, bool diagonal=false) ;
+
 
 
 }
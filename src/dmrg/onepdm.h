@@ -43,5 +43,17 @@ void load_pairmat_binary(Matrix& pairmat, const int &i, const int &j);
 void save_pairmat_text(const Matrix& onepdm, const int &i, const int &j);
 
 std::vector<int> distribute_procs(const int numprocs, const int numjobs);
+
+// onepdm_in_sweep: the onepdm of every root accumulated at the sites of a
+// one-dot DMRG sweep, from its blocks and optimized wavefunctions. The site
+// flags select the pieces of the first and last sites as in SweepOnepdm.
+void startSweepOnepdm(int nroots);
+bool sweepOnepdmActive();
+void setSweepOnepdmSite(bool first, bool last);
+void addSweepOnepdm(std::vector<StackWavefunction>& solutions, const StackSpinBlock& big);
+// saves the onepdm if all the positions of the sweep were done
+void finishSweepOnepdm(int positions);
+// true once a sweep saved the onepdm, the separate onepdm sweep is not needed
+bool sweepOnepdmDone();
 }
 #endif
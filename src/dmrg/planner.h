@@ -0,0 +1,29 @@
+/*
+Developed by Sandeep Sharma and Garnet K.-L. Chan, 2012
+Copyright (c) 2012, Garnet K.-L. Chan
+
+This program is integrated in Molpro with the permission of
+Sandeep Sharma and Garnet K.-L. Chan
+*/
+
+#ifndef SPIN_PLANNER_HEADER_H
+#define SPIN_PLANNER_HEADER_H
+
+namespace SpinAdapted {
+
+// The dry run of the keyword plan. The sweeps of the schedule are walked
+// with the blocks built as skeletons only: their StateInfos and operator
+// arrays, as BuildSumBlock makes them, but no operator is allocated or
+// built and nothing is written. The decimation is replaced by keeping the M
+// states of the schedule in proportion to the states of each quantum.
+//
+// Per sweep position it reports, for this number of ranks, the operators of
+// the new system and environment, the stack memory of the blocks and the
+// Davidson vectors, the size of the block file written, and the flops of
+// multiplyH and of the renormalisation; then the time of the sweeps at
+// plan_gflops GFLOP/s per thread, the disk and peak memory, and the memory,
+// ranks and num_thrds that would fit the largest position.
+void planCalculation();
+
+} // namespace SpinAdapted
+#endif
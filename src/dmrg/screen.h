@@ -36,6 +36,32 @@ std::vector<std::pair<int, int> > screened_dd_indices(const std::vector<int, std
 						      const TwoElectronArray& twoe, double thresh);
 
 
+/**
+ * the threshold for screened_cd_indices (dd false) or screened_dd_indices
+ * (dd true) of these indices and interactingix. It is the fixed
+ * twoindex_screen_tol, unless a twoindex_screen_budget is given: then the
+ * pairs whose largest integral times the operator norm recorded for the
+ * indices in the previous sweep is smallest are dropped, as long as the sum
+ * of these estimates stays below the share of one site in the budget.
+ * The fixed tolerance is the lower limit, and 0 turns the screening off.
+ */
+double twoindex_screen_tol(const std::vector<int, std::allocator<int> >& indices,
+			   const std::vector<int, std::allocator<int> >& interactingix,
+			   const TwoElectronArray& twoe, bool dd);
+
+/**
+ * the largest cd and dd operator norms of a block of these sites, for the
+ * estimates of twoindex_screen_tol; the largest over all the processes is
+ * kept, so this is called by all of them
+ */
+void record_twoindex_norms(const std::vector<int, std::allocator<int> >& sites, double cd, double dd);
+
+/**
+ * the pairs seen and dropped by the budget of twoindex_screen_tol since the
+ * last report, and the sum of their error estimates
+ */
+void takeTwoindexScreeningReport(long& pairs, long& dropped, double& error);
+
 /**
  * given two indices i and j, determine
  * whether we should build c+i dj
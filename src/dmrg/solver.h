@@ -20,7 +20,8 @@ namespace SpinAdapted{
   {
     void solve_wavefunction(std::vector<StackWavefunction>& solution, std::vector<double>& energies, StackSpinBlock& big, const double tol, 
 			    const guessWaveTypes& guesswavetype, const bool &onedot, const bool& dot_with_sys, const bool& warmUp, const bool& twoindex, 
-			    double additional_noise, int currentRoot, std::vector<StackWavefunction>& lowerStates);
+			    double additional_noise, int currentRoot, std::vector<StackWavefunction>& lowerStates,
+			    std::vector<double>* hpsi = 0, std::vector<double>* ritz = 0);
   };
 }
 #endif
@@ -23,9 +23,15 @@ namespace Sweep
   void Startup (SweepParams &sweepParams, StackSpinBlock& system, StackSpinBlock& newSystem);
   double do_one(SweepParams &sweepParams, const bool &warmUp, const bool &forward, const bool &restart, const int &restartSize);
   double do_one_partial(SweepParams &sweepParams, const bool &warmUp, const bool &forward, const bool &restart, const int &restartSize);
+  // realspace_segments: the loop of the groups other than 0, and its end
+  void segmentWorker();
+  void stopSegmentWorkers();
 
   void do_overlap(SweepParams &sweepParams, const bool &warmUp, const bool &forward, const bool &restart, const int &restartSize);
   void fullci(double sweep_tol);
+  // determinant full CI of fullci, in directci.C; false if the hamiltonian
+  // or the symmetry are not ones it handles
+  bool directci(std::vector<double>& energies, double tol);
   void tiny(double sweep_tol);
 
   void CanonicalizeWavefunctionPartialSweep(SweepParams &sweepParams, const bool &forward, int currentstate);
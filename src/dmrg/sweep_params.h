@@ -10,6 +10,10 @@ Sandeep Sharma and Garnet K.-L. Chan
 #define SPIN_SWEEP_PARAMS_HEADER
 #include "enumerator.h"
 #include <boost/serialization/serialization.hpp>
+#include <boost/serialization/version.hpp>
+#include <map>
+#include <string>
+#include <tuple>
 #include <vector>
 
 using namespace std;
@@ -26,6 +30,8 @@ class SweepParams {
         ar &keep_qstates &sys_add &env_add &noise &additional_noise
             &davidson_tol &lowest_energy &lowest_energy_spins &guesstype;
         ar &error &largest_dw &onedot &currentRoot;
+        if (version > 0)
+            ar &sweep_energy &sweep_energy_spins &sweep_error;
     }
 
     int restart_iter;
@@ -49,6 +55,32 @@ class SweepParams {
     vector<double> lowest_energy;
     vector<double> lowest_energy_spins;
     guessWaveTypes guesstype;
+    // the lowest energies (and their spins) and the largest discarded weight
+    // of the sweep up to block_iter, saved so that a restart in the middle
+    // of a sweep reports the same sweep energy as the run without it
+    vector<double> sweep_energy;
+    vector<double> sweep_energy_spins;
+    double sweep_error;
+    // for davidson_adaptive_tol: the last energy, its change from the visit
+    // before and the discarded weight, keyed by (root, direction, first site
+    // of the system dot); not saved, a restart starts from the schedule
+    std::map<std::tuple<int, bool, int>, std::vector<double>> site_history;
+    // for adaptive_schedule: the states, Davidson tolerance and noise chosen
+    // for the next sweep, the last sweep energy, the (states, energy,
+    // discarded weight) at the end of every stage of fixed states, the states
+    // per position and the decisions so far; not saved either
+    int adaptive_states;
+    double adaptive_tol, adaptive_noise, adaptive_energy;
+    bool adaptive_changed, adaptive_final;
+    std::vector<std::tuple<int, double, double>> adaptive_stages;
+    std::map<std::tuple<int, bool, int>, int> site_states;
+    std::vector<std::string> adaptive_schedule, adaptive_log;
+    void write_adaptive_schedule() const;
+    // for "twodot_to_onedot auto": wall time, Davidson time and sizes of the
+    // two-dot and one-dot wavefunctions summed over the positions of this
+    // sweep, and the energy of the last two-dot sweep; not saved either
+    double twodot_time, twodot_davidson_time, twodot_size, onedot_size;
+    double twodot_energy;
 
   public:
     SweepParams();
@@ -58,6 +90,14 @@ class SweepParams {
     void savestate(const bool &forward, const int &size);
     void restorestate(bool &forward, int &size);
     void calc_niter();
+    double site_davidson_tol(const bool &forward, const int &dot) const;
+    void update_site_history(const bool &forward, const int &dot);
+    int site_keep_states(const bool &forward, const int &dot) const;
+    void end_adaptive_sweep(const double &energy);
+    const bool &get_adaptive_changed() const { return adaptive_changed; }
+    void add_twodot_timing(double seconds, double davidson, double twodotSize,
+                           double onedotSize);
+    void end_twodot_sweep(const double &energy);
 
     const int &current_root() const { return currentRoot; }
     const bool &get_onedot() const { return onedot; }
@@ -85,6 +125,18 @@ class SweepParams {
         return lowest_energy_spins;
     }
     const guessWaveTypes &get_guesstype() const { return guesstype; }
+    const vector<double> &get_sweep_energy() const { return sweep_energy; }
+    const vector<double> &get_sweep_energy_spins() const {
+        return sweep_energy_spins;
+    }
+    const double &get_sweep_error() const { return sweep_error; }
+    void set_sweep_progress(const vector<double> &energy,
+                            const vector<double> &energy_spins,
+                            const double &error) {
+        sweep_energy = energy;
+        sweep_energy_spins = energy_spins;
+        sweep_error = error;
+    }
     const int &get_restart_iter() const { return restart_iter; }
 
     int &current_root() { return currentRoot; }
@@ -110,4 +162,7 @@ class SweepParams {
     guessWaveTypes &set_guesstype() { return guesstype; }
 };
 } // namespace SpinAdapted
+
+// version 1 saves the sweep progress, older state files restart without it
+BOOST_CLASS_VERSION(SpinAdapted::SweepParams, 1)
 #endif
@@ -12,6 +12,9 @@ extern "C" {
   void readMPSFromDiskAndInitializeStaticVariables(bool initializeDotBlocks=true);
   //void evaluateOverlapAndHamiltonian(unsigned long *occ, int length, double* o, double* h);
   void evaluateOverlapAndHamiltonian(int state1, int state2, double* o, double* h);
+  // coefficients of ndets determinants in the global MPS, each given by
+  // length words of occupations as in MPS(ulonglong*, int)
+  void evaluateCoefficients(unsigned long long* occ, int length, int ndets, double* coeffs);
   void intFromString(unsigned long &occ, char* s);
   void writeToDisk(unsigned long &occ, int length, int stateIndex);
   void test(char* infile);
@@ -62,7 +62,13 @@ enum WarmUpTypes { WILSON, LOCAL0, LOCAL2, LOCAL3, LOCAL4 };
 enum hamTypes { QUANTUM_CHEMISTRY, HUBBARD, BCS, HEISENBERG };
 enum solveTypes { LANCZOS, DAVIDSON, CONJUGATE_GRADIENT };
 enum algorithmTypes { ONEDOT, TWODOT, TWODOT_TO_ONEDOT, PARTIAL_SWEEP };
-enum noiseTypes { RANDOM, EXCITEDSTATE };
+enum noiseTypes { RANDOM, EXCITEDSTATE, SUBSPACE_EXPANSION };
+enum distributionTypes { ROUND_ROBIN, COST_BALANCED, NODE_BALANCED };
+// operator classes saved in single precision, see single_precision_ops
+enum singlePrecisionOps {
+    SINGLE_COMPLEMENTARY_OPS = 1,
+    SINGLE_TWO_INDEX_OPS = 2
+};
 enum calcType {
     DMRG,
     ONEPDM,
@@ -95,10 +101,11 @@ enum calcType {
     RESPONSEAAAV,
     RESPONSEAAAC,
     MPS_NEVPT,
-    RESTART_MPS_NEVPT
+    RESTART_MPS_NEVPT,
+    EXPECTATION
 };
 enum orbitalFormat { MOLPROFORM, DMRGFORM };
-enum reorderType { FIEDLER, GAOPT, MANUAL, NOREORDER };
+enum reorderType { FIEDLER, GAOPT, MANUAL, NOREORDER, COSTORDER };
 enum keywords {
     ORBS,
     LASTM,
@@ -152,6 +159,14 @@ enum {
                */
 };
 
+// kernels the npdm_contract option applies to the 3PDM / 4PDM elements as they
+// are computed (bit flags)
+enum NpdmContraction {
+    NPDM_CONTRACT_TRACE = 1,
+    NPDM_CONTRACT_DIAGONAL = 2,
+    NPDM_CONTRACT_ENERGY = 4
+};
+
 enum OnePerturbType { Va_1 = 0, Vi_1, Vai_1, OnePertEnd };
 enum TwoPerturbType {
     Va = 0,
@@ -28,6 +28,7 @@ namespace genetic
       ar & random_seed;
       ar & select;
       ar & fiedler;
+      ar & migration;
     }
 
   public:
@@ -41,6 +42,7 @@ namespace genetic
     double exponent;
     unsigned int random_seed;
     int fiedler;
+    int migration; // generations between migrations of the islands, 0 for none
     SELECT_TYPE select;
 
     GAInput(void);
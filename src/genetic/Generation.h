@@ -20,6 +20,8 @@ namespace genetic
     vector<double> m_prob;
 
     void ComputeProbability(void);
+    // evaluates genes[i] into cell i for i >= first, in parallel
+    void Create(const vector<Gene>& genes, int first);
 
     void BoltzmannProb(void);
     void GaussProb(void);
@@ -48,6 +50,9 @@ namespace genetic
 
     void AddFiedler(std::vector<int> fiedlerorder);
 
+    // replaces the worst cell by a migrant from another island if it is better
+    void Immigrate(const Cell& cell);
+
     friend ostream& operator<< (ostream& ost, const Generation& g){
       using std::setw;
       using std::endl;
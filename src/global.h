@@ -96,6 +96,7 @@ extern MPI_Comm Calc;
 namespace block2 {
 
 extern StackAllocator<double> *current_page;
+extern std::vector<StackAllocator<double>> DataPages;
     
 } // namespace block2
 #endif
@@ -1,7 +1,10 @@
 #ifndef STACK_ALLOCATOR
 #define STACK_ALLOCATOR
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <map>
 #include <vector>
 #include <stdlib.h>  
 #include <memory>
@@ -11,21 +14,77 @@
 
 void print_trace(int sig);
 
+// Budget shared by the thread stacks between SplitStackmem and MergeStackmem.
+// A stack takes it in chunks as its memused grows past what it was granted,
+// with a compare and swap on used, and gives back the whole chunks it no
+// longer needs when it shrinks, so that no lock is needed.
+struct StackPool
+{
+  std::atomic<std::size_t> used;
+  std::size_t size;
+  std::size_t chunk;
+  int members;
+ StackPool() : used(0), size(0), chunk(0), members(1) {}
+  // takes n elements, or at least need of them if fewer are left
+  std::size_t take(std::size_t n, std::size_t need) {
+    std::size_t u = used.load();
+    while (true) {
+      if (u + need > size) return 0;
+      std::size_t m = u + n > size ? size - u : n;
+      if (used.compare_exchange_weak(u, u + m)) return m;
+    }
+  }
+  void give(std::size_t n) { used.fetch_sub(n); }
+  std::size_t left() const { std::size_t u = used.load(); return u < size ? size - u : 0; }
+};
+
 template<class T> class StackAllocator
 {
  public:
   std::size_t size;
   T* data ;
   std::size_t memused;
+  std::size_t peak; // high water mark of memused
+  // high water mark since the memory above memused was last given back to
+  // the system, see block2::set_data_page_pointer
+  std::size_t touched;
+  // if not 0, the allocators in arena share arena_size elements: an
+  // allocation fails if their memused would add up to more
+  const std::vector<StackAllocator> *arena;
+  std::size_t arena_size;
+  // if false, blocks freed out of order are kept in deferred and released
+  // once everything above them has been freed
+  bool strict;
+  std::map<std::size_t, std::size_t> deferred; // offset -> length
+  // if not 0, memused may only grow past granted with memory taken from pool,
+  // of which granted - pool_base has been taken
+  StackPool *pool;
+  std::size_t pool_base;
+  std::size_t granted;
 
 
- StackAllocator(T* data_ptr, std::size_t max_size): memused(0)  {size =max_size; data=data_ptr;}
+ StackAllocator(T* data_ptr, std::size_t max_size): memused(0), peak(0), touched(0), arena(0), arena_size(0), strict(true), pool(0), pool_base(0), granted(0)  {size =max_size; data=data_ptr;}
   
- StackAllocator() : size(0), data(0), memused(0) {}
-  void clear() {size = 0;data=0; memused=0;}
+ StackAllocator() : size(0), data(0), memused(0), peak(0), touched(0), arena(0), arena_size(0), strict(true), pool(0), pool_base(0), granted(0) {}
+  void clear() {size = 0;data=0; memused=0; peak=0; touched=0; arena=0; arena_size=0; deferred.clear(); pool=0; pool_base=0; granted=0;}
+  std::size_t arena_used() const {
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < arena->size(); i++)
+      n += (*arena)[i].memused;
+    return n;
+  }
+  // elements that can be allocated (of the pool, a fair share of what is left)
+  std::size_t available() const {
+    std::size_t n = size > memused ? size - memused : 0;
+    if (pool != 0) {
+      std::size_t mine = (granted > memused ? granted - memused : 0) + pool->left() / pool->members;
+      if (mine < n) n = mine;
+    }
+    return n;
+  }
   T* allocate(std::size_t n, const void* hint = 0) 
   {
-    if (memused+n >=size)
+    if (memused+n >=size || (arena != 0 && arena_used()+n > arena_size) || !grant(memused+n))
       {
 	std::cout << "exceeding allowed memory"<<std::endl;
 	print_trace(11);
@@ -34,17 +93,50 @@ template<class T> class StackAllocator
     else
       {
 	memused = memused+n;
+	if (memused > peak) peak = memused;
+	if (memused > touched) touched = memused;
 	return &data[memused-n];
       }
   }
   void deallocate(void* ptr, std::size_t n) {
     if (n == 0) return;
-    if (memused < n || ptr != &data[memused-n]) {
+    if (memused >= n && ptr == &data[memused-n]) {
+      memused = memused - n;
+      release_deferred();
+      if (pool != 0) shrink();
+    }
+    else if (!strict && (T*)ptr >= data && (T*)ptr + n <= data + memused) {
+      deferred[(T*)ptr - data] = n;
+    }
+    else {
       std::cout << "deallocation not happening in reverse order"<<std::endl;
       print_trace(11);
     }
-    else {
-      memused = memused - n;
+  }
+  // drops deferred blocks that are no longer below memused and frees those
+  // that have become the top of the stack
+  void release_deferred() {
+    deferred.erase(deferred.lower_bound(memused), deferred.end());
+    while (!deferred.empty()) {
+      typename std::map<std::size_t, std::size_t>::iterator it = --deferred.end();
+      if (it->first + it->second != memused) break;
+      memused = it->first;
+      deferred.erase(it);
+    }
+  }
+  // makes sure that memused can grow to n, false if the pool is exhausted
+  bool grant(std::size_t n) {
+    if (pool == 0 || n <= granted) return true;
+    std::size_t m = pool->take((n - granted + pool->chunk - 1) / pool->chunk * pool->chunk, n - granted);
+    granted += m;
+    return m != 0;
+  }
+  // gives back to the pool the memory more than a chunk above memused
+  void shrink() {
+    std::size_t keep = std::max(memused, pool_base) + pool->chunk;
+    if (granted > keep + pool->chunk) {
+      pool->give(granted - keep);
+      granted = keep;
     }
   }
   std::size_t max_size() const {return size;}
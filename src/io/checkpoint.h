@@ -0,0 +1,42 @@
+/*
+Developed by Sandeep Sharma and Garnet K.-L. Chan, 2012
+Copyright (c) 2012, Garnet K.-L. Chan
+
+This program is integrated in Molpro with the permission of
+Sandeep Sharma and Garnet K.-L. Chan
+*/
+
+#ifndef SPIN_CHECKPOINT_HEADER
+#define SPIN_CHECKPOINT_HEADER
+#include <string>
+
+namespace SpinAdapted {
+
+// Incremental checkpoints, keyword checkpoint_manifest. The block, rotation
+// matrix, wavefunction, state info and state files are written under a
+// temporary name, synced and renamed over the old file, so a killed job
+// always leaves either the old or the new complete file. At every savestate
+// the manifest checkpoint.<rank>.tmp lists all files written so far with
+// their size and modification time, and the sweep position; RESTART checks
+// it before resuming at that position. Text format:
+//
+//   BLOCK checkpoint 1
+//   position <sweep_iter> <block_iter> <forward> <size>
+//   file <bytes> <mtime> <path>          (one line per file)
+
+// the name to write file under; file itself without checkpoint_manifest
+std::string CheckpointPartName(const std::string &file);
+// part is complete: sync it, rename it to file and record file for the next
+// manifest. Nothing happens if part is file. Thread safe.
+void CheckpointCommit(const std::string &part, const std::string &file);
+// file is no longer part of the checkpoint, from the next manifest on
+void CheckpointForget(const std::string &file);
+// writes the manifest of this rank for the given sweep position
+void WriteCheckpoint(int sweepIter, int blockIter, bool forward, int size);
+// reads the manifest of this rank and aborts with the list of bad files if
+// one of them is missing or older than recorded; files newer than the
+// manifest are outputs of the position that was interrupted and are redone
+void VerifyCheckpoint();
+
+} // namespace SpinAdapted
+#endif
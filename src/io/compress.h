@@ -0,0 +1,28 @@
+/*
+Developed by Sandeep Sharma and Garnet K.-L. Chan, 2012
+Copyright (c) 2012, Garnet K.-L. Chan
+
+This program is integrated in Molpro with the permission of
+Sandeep Sharma and Garnet K.-L. Chan
+*/
+
+#ifndef SPIN_COMPRESS_HEADER
+#define SPIN_COMPRESS_HEADER
+#include <stdio.h>
+#include <vector>
+
+namespace SpinAdapted {
+
+// Writes data made of consecutive segments (one per operator). Segments
+// flagged in single are stored in single precision. If deflate is true and
+// zlib is available, each segment is byte shuffled and the whole stream is
+// deflated, otherwise the bytes are stored as they are.
+void writeCompressedData(FILE *fp, const double *data,
+                         const std::vector<long> &segments,
+                         const std::vector<char> &single, bool deflate);
+
+// reads n doubles written by writeCompressedData
+void readCompressedData(FILE *fp, double *data, long n);
+
+} // namespace SpinAdapted
+#endif
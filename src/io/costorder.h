@@ -0,0 +1,33 @@
+/*
+Developed by Sandeep Sharma and Garnet K.-L. Chan, 2012
+Copyright (c) 2012, Garnet K.-L. Chan
+
+This program is integrated in Molpro with the permission of
+Sandeep Sharma and Garnet K.-L. Chan
+*/
+
+#ifndef SPIN_COSTORDER_HEADER_H
+#define SPIN_COSTORDER_HEADER_H
+#include "integralcache.h"
+#include <vector>
+
+namespace SpinAdapted {
+
+// Orbital ordering against a model of the cost of a sweep, reorder keyword
+// costorder. Fiedler and the genetic algorithm minimize the distance of
+// strongly exchange coupled orbitals; the model instead looks at every cut
+// of the chain. The orbitals on the smaller side that share an integral of
+// at least thresh with an orbital on the other side are the ones whose
+// complementary two-index operators survive screening, so their number m
+// squared is the operator count of the cut. The exchange integrals crossing
+// the cut, relative to their mean over the cuts of the start order, stand
+// in for the entanglement and so the number of states the cut needs. A cut
+// costs m^2 (1 + e)^2, and orbitals of the start order are moved to other
+// positions as long as that lowers the total cost.
+std::vector<int> costorder_reorder(int norb,
+                                   const std::vector<IntegralLine> &lines,
+                                   const std::vector<int> &start,
+                                   double thresh);
+
+} // namespace SpinAdapted
+#endif
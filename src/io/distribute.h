@@ -17,15 +17,56 @@ Sandeep Sharma and Garnet K.-L. Chan
 #include <boost/mpi/communicator.hpp>
 #include <boost/mpi.hpp>
 #endif
+#include <algorithm>
 #include <vector>
 
 class DiagonalMatrix;
 namespace SpinAdapted
 {
   class StackSparseMatrix;
+  class StackWavefunction;
+  class TwoElectronArray;
   
   void SplitStackmem();
   void MergeStackmem();
+
+  // assigns the operator indices to the mpi ranks greedily by an integral
+  // count estimate of their cost, largest first, and reports the imbalance
+  void BalanceOperatorDistribution();
+
+  // distributed_integrals: the slice (p i|j k) over all spatial orbitals
+  // i, j, k of spatial orbital p, laid out as in PartialTwoElectronArray, is
+  // kept only by rank p % size of MPI_COMM_WORLD. DistributeIntegralSlices is
+  // called by all ranks, with the integrals v2 of the n spatial orbitals on
+  // rank 0 only. GetIntegralSlice copies the slice of p of integral set index
+  // into out, with a one-sided get from its owner, and returns n.
+  void DistributeIntegralSlices(const TwoElectronArray& v2, int n, int index);
+  int GetIntegralSlice(int index, int p, std::vector<double>& out);
+  void FreeIntegralSlices();
+
+  // wait_report: the time the master thread of this rank spends in an MPI
+  // collective, from the construction of a WaitScope to its destruction, is
+  // blocked time, and the rest of a sweep position compute time. Scopes
+  // inside another one are not counted again. The metrics count it too.
+  class WaitScope {
+  private:
+    double start;
+    bool counted;
+  public:
+    WaitScope();
+    ~WaitScope();
+  };
+  // the blocked time of this rank in all the scopes so far
+  double waitBlockedTotal();
+  // a sweep starts; the first call writes the operator indices each rank
+  // owns to operator_owners.txt
+  void waitReportStart();
+  // the compute and blocked time of every rank of Calc since the last call
+  // are gathered on rank 0, which appends them to wait_report.csv and prints
+  // the imbalance of the position. Called by all the ranks of Calc.
+  void waitPositionReport(int sweepIter, int blockIter, int sites);
+  // the imbalance of all the positions so far
+  void waitReportSummary();
   
   template<class T> void initiateMultiThread(T* op, T* &op_array, int MAX_THRD)
   {
@@ -41,26 +82,97 @@ namespace SpinAdapted
   }
   
   
+  // the copies made by initiateMultiThread have the layout of op, so they are
+  // summed as flat arrays: each thread adds all copies for its own stripes,
+  // in the same order as a serial sum over the copies
   template <class T> void accumulateMultiThread(T* op, T* &op_array, int MAX_THRD)
   {
     if ( MAX_THRD == 1)
       return;
     else {  //only multithreaded
-      for (int i=MAX_THRD-1; i>0; i--) {
-	ScaleAdd(1.0, op_array[i], op_array[0]);
-	op_array[i].deallocate();
+      const long n = op_array[0].memoryUsed(), stripe = 8192;
+      double* sum = op_array[0].get_data();
+#pragma omp parallel for schedule(static) num_threads(MAX_THRD)
+      for (long start = 0; start < n; start += stripe) {
+	const long end = std::min(n, start + stripe);
+	for (int i=MAX_THRD-1; i>0; i--) {
+	  const double* part = op_array[i].get_data();
+	  for (long j = start; j < end; j++)
+	    sum[j] += part[j];
+	}
       }
+      for (int i=MAX_THRD-1; i>0; i--)
+	op_array[i].deallocate();
       delete [] op_array;
     }
   }
 
+  // accumulateMultiThread of the sigma vectors v[k], whose thread copies are
+  // v_array[k], followed by their sum over Calc unless deferred_sigma_sum is
+  // set. The sum is done in segments, each started (non-blocking) as soon as
+  // the threads have summed it, so that it runs during the summation of the
+  // rest. With deferred_sigma_sum and targets set by setSigmaScatter, the
+  // segments are reduce-scattered into the ranges of their owners instead.
+  void accumulateSigma(std::vector<StackWavefunction*>& v, std::vector<StackWavefunction*>& v_array, int MAX_THRD);
+
 #ifndef SERIAL
   void distributedaccumulate(DiagonalMatrix& component);
   void distributedaccumulate(SpinAdapted::StackSparseMatrix& component);
+  // the sum over Calc only on root
+  void distributedreduce(DiagonalMatrix& component, int root);
+
+  // the next sigma vectors summed by accumulateSigma go to out[k], of which
+  // rank i holds [displs[i], displs[i] + counts[i]) of the full vector.
+  // finishSigmaScatter drops the targets and returns how many of them were
+  // not filled (by a multiply that does not use accumulateSigma).
+  void setSigmaScatter(const std::vector<double*>& out, const std::vector<int>& counts, const std::vector<int>& displs);
+  int finishSigmaScatter();
+
+  // ranks of Calc on this node, the first rank of every node (MPI_COMM_NULL
+  // elsewhere), and the rank in the latter of the node holding Calc rank r
+  MPI_Comm nodeCommunicator();
+  MPI_Comm nodeLeaderCommunicator();
+  int nodeLeaderOf(int r);
+  // MPI_Bcast of n doubles on Calc; with hierarchical_bcast the data crosses
+  // the network once per node, from the root's node leader to the others
+  void hierarchicalBcast(double* data, long n, int root);
+
+  // node shared memory of n doubles for the operators replicated on all ranks,
+  // see shared_operator_memory
+  void InitSharedOperatorMemory(long n);
+  void FreeSharedOperatorMemory();
+  // n doubles in the region of a block, which starts at mark (-1 opens a new
+  // one); 0 when the memory is off or full. Every rank of a node has to make
+  // the same calls.
+  double* sharedOperatorAllocate(long n, long& mark);
+  void sharedOperatorRelease(long& mark);
+
+  // realspace_segments: Calc becomes the group of this rank, and
+  // segmentCommunicator() the ranks of all the groups
+  void SplitSweepSegments(int n);
+  void FreeSweepSegments();
+  MPI_Comm segmentCommunicator();
 #else
   void distributedaccumulate(DiagonalMatrix& component) ;
   void distributedaccumulate(SpinAdapted::StackSparseMatrix& component);
+  void distributedreduce(DiagonalMatrix& component, int root);
 #endif
+  // the group of this rank and the number of groups, 0 and 1 without segments
+  int sweepSegment();
+  int sweepSegments();
+
+  // nevpt_groups: Calc becomes the group of this rank while the perturbers
+  // of MPS-NEVPT2 run, false if the ranks are not split; Join puts it back
+  bool SplitPerturberGroups(int n);
+  void JoinPerturberGroups();
+  // the perturbers 0 .. ntasks-1 of a round are shared out over the groups,
+  // Next returns one of them for the group of this rank or -1 once they are
+  // all taken. Both are called by all the ranks of a group.
+  void StartPerturberTasks();
+  int NextPerturberTask(int ntasks);
+  // x of the rank 0 of every group summed, on all the ranks
+  double SumOverPerturberGroups(double x);
+  int perturberGroup();
 
 }
 
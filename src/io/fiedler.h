@@ -11,6 +11,12 @@ Garnet K.-L. Chan
 
 class SymmetricMatrix;
 
-std::vector<int> fiedler_reorder(const SymmetricMatrix& m);
+// orbitals sorted by the Fiedler vector of the graph of |m|. Couplings below
+// threshold times the largest are dropped; graphs beyond FIEDLER_DENSE_SIZE
+// are solved by Lanczos on the sparse Laplacian, started from the Fiedler
+// vectors of coarsened graphs with multilevel
+std::vector<int> fiedler_reorder(const SymmetricMatrix& m, double threshold=0., bool multilevel=false);
+
+const int FIEDLER_DENSE_SIZE = 64;
 
 #endif
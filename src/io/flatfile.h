@@ -0,0 +1,71 @@
+/*
+Developed by Sandeep Sharma and Garnet K.-L. Chan, 2012
+Copyright (c) 2012, Garnet K.-L. Chan
+
+This program is integrated in Molpro with the permission of
+Sandeep Sharma and Garnet K.-L. Chan
+*/
+
+#ifndef SPIN_FLATFILE_HEADER
+#define SPIN_FLATFILE_HEADER
+#include <string>
+#include <vector>
+
+namespace SpinAdapted {
+
+// Flat files for the rotation matrices and the wavefunctions, which do not
+// depend on the boost serialization version for their bulk data. Layout,
+// little endian:
+//
+//   0   char[8]  "BLKFLT01"
+//   8   int32    version
+//   12  int32    kind, see FlatFileKind
+//   16  int64    number of sections n
+//   24  int64[5] reserved
+//   64  n x { int64 offset, int64 length in bytes, int64 rows, int64 cols }
+//
+// followed by the sections, each starting on a 64 byte boundary so that a
+// mapped file can be used in place. Matrices are stored row major.
+enum FlatFileKind { FLAT_ROTATION = 1, FLAT_WAVEFUNCTION = 2 };
+
+struct FlatSection {
+    long long offset, length, rows, cols;
+};
+
+// true if file exists and starts with the flat file magic
+bool IsFlatFile(const std::string &file);
+
+// writes the sections, data[i] holds sections[i].length bytes; the offsets
+// are filled in. Aborts if the file cannot be written.
+void WriteFlatFile(const std::string &file, int kind,
+                   std::vector<FlatSection> &sections,
+                   const std::vector<const void *> &data);
+
+// read only mapping of a flat file
+class FlatFile {
+  private:
+    void *map;
+    size_t length;
+    FlatFile(const FlatFile &);
+    FlatFile &operator=(const FlatFile &);
+
+  public:
+    std::vector<FlatSection> sections;
+
+    FlatFile() : map(0), length(0) {}
+    ~FlatFile() { Close(); }
+
+    // maps file, aborts unless it is a complete flat file of the given kind
+    void Open(const std::string &file, int kind);
+    void Close();
+    const char *Data(int i) const {
+        return (const char *)map + sections[i].offset;
+    }
+};
+
+// rewrites the rotation matrices and wavefunctions in directory dir that are
+// still in the boost archive format as flat files
+void ConvertToFlatFiles(const std::string &dir);
+} // namespace SpinAdapted
+
+#endif
@@ -0,0 +1,167 @@
+/*
+Developed by Sandeep Sharma and Garnet K.-L. Chan, 2012
+Copyright (c) 2012, Garnet K.-L. Chan
+
+This program is integrated in Molpro with the permission of
+Sandeep Sharma and Garnet K.-L. Chan
+*/
+
+#ifndef SPIN_FLATMETA_HEADER
+#define SPIN_FLATMETA_HEADER
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace SpinAdapted {
+
+// Flat records of the metadata of StateInfo and of the operator shells, for
+// the block files and the MPI transfers, in place of boost serialization.
+// A record is
+//
+//   0   char[8]  "BLKMETA1"
+//   8   int32    version
+//   12  int32    kind, see FlatMetaKind
+//   16  int64    length of the body in bytes
+//
+// followed by the body. Scalars and vectors of trivially copyable types are
+// copied as bytes (a vector as its int64 size and its elements), a vector of
+// vectors as one CSR block: the number of rows, the row offsets and all the
+// elements, so that reading one is a few memcpy's whatever its size.
+enum FlatMetaKind { FLAT_META_STATEINFO = 1, FLAT_META_OPERATOR = 2 };
+
+const int FlatMetaVersion = 1;
+const size_t FlatMetaHeaderSize = 24;
+
+// true if the n bytes at data start with a flat metadata record
+inline bool IsFlatMeta(const char *data, size_t n) {
+    return n >= FlatMetaHeaderSize && memcmp(data, "BLKMETA1", 8) == 0;
+}
+
+class FlatWriter {
+  private:
+    std::vector<char> &buf;
+    size_t start;
+
+    void append(const void *p, size_t n) {
+        if (n == 0)
+            return;
+        size_t k = buf.size();
+        buf.resize(k + n);
+        memcpy(&buf[k], p, n);
+    }
+
+  public:
+    // appends the header of a record of this kind to b
+    FlatWriter(std::vector<char> &b, int kind) : buf(b), start(b.size()) {
+        int version = FlatMetaVersion;
+        long long length = 0;
+        append("BLKMETA1", 8);
+        append(&version, sizeof(version));
+        append(&kind, sizeof(kind));
+        append(&length, sizeof(length));
+    }
+    // writes the length of the body into the header
+    void finish() {
+        long long length = buf.size() - start - FlatMetaHeaderSize;
+        memcpy(&buf[start + 16], &length, sizeof(length));
+    }
+
+    template <class T> void put(const T &x) {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "flat metadata needs trivially copyable types");
+        append(&x, sizeof(T));
+    }
+    template <class T> void put(const std::vector<T> &v) {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "flat metadata needs trivially copyable types");
+        put((long long)v.size());
+        append(v.data(), v.size() * sizeof(T));
+    }
+    void put(const std::string &s) {
+        put((long long)s.size());
+        append(s.data(), s.size());
+    }
+    template <class T> void put(const std::vector<std::vector<T>> &v) {
+        std::vector<long long> offsets(v.size() + 1, 0);
+        for (size_t i = 0; i < v.size(); i++)
+            offsets[i + 1] = offsets[i] + v[i].size();
+        put(offsets);
+        for (size_t i = 0; i < v.size(); i++)
+            append(v[i].data(), v[i].size() * sizeof(T));
+    }
+};
+
+class FlatReader {
+  private:
+    const char *p, *end;
+
+    void take(void *x, size_t n) {
+        if (n > (size_t)(end - p)) {
+            std::cerr << "flat metadata record is truncated" << std::endl;
+            abort();
+        }
+        if (n != 0)
+            memcpy(x, p, n);
+        p += n;
+    }
+
+  public:
+    // checks the header of the record of this kind at data, of n bytes up
+    // to its end; aborts if it is not one
+    FlatReader(const char *data, size_t n, int kind) : p(data), end(data + n) {
+        int version, k;
+        long long length;
+        if (!IsFlatMeta(data, n)) {
+            std::cerr << "not a flat metadata record" << std::endl;
+            abort();
+        }
+        memcpy(&version, data + 8, sizeof(version));
+        memcpy(&k, data + 12, sizeof(k));
+        memcpy(&length, data + 16, sizeof(length));
+        if (version != FlatMetaVersion || k != kind ||
+            length > (long long)(n - FlatMetaHeaderSize)) {
+            std::cerr << "flat metadata record of version " << version
+                      << " and kind " << k << " cannot be read as kind "
+                      << kind << std::endl;
+            abort();
+        }
+        p = data + FlatMetaHeaderSize;
+        end = p + length;
+    }
+    // the length of the whole record at data, which has a valid header
+    static size_t RecordSize(const char *data) {
+        long long length;
+        memcpy(&length, data + 16, sizeof(length));
+        return FlatMetaHeaderSize + length;
+    }
+
+    template <class T> void get(T &x) { take(&x, sizeof(T)); }
+    template <class T> void get(std::vector<T> &v) {
+        long long n;
+        get(n);
+        v.resize(n);
+        take(v.data(), n * sizeof(T));
+    }
+    void get(std::string &s) {
+        long long n;
+        get(n);
+        s.resize(n);
+        take(&s[0], n);
+    }
+    template <class T> void get(std::vector<std::vector<T>> &v) {
+        std::vector<long long> offsets;
+        get(offsets);
+        v.resize(offsets.empty() ? 0 : offsets.size() - 1);
+        for (size_t i = 0; i < v.size(); i++) {
+            v[i].resize(offsets[i + 1] - offsets[i]);
+            take(v[i].data(), v[i].size() * sizeof(T));
+        }
+    }
+};
+
+} // namespace SpinAdapted
+
+#endif
@@ -48,6 +48,84 @@ class Input {
     bool m_performResponseSolution;
     int m_permSymm;
     bool m_lowMemoryAlgorithm;
+    bool m_batched_gemm;
+    bool m_mmap_blocks;
+    bool m_prefetch_blocks;
+    std::size_t m_write_behind_memory;
+    bool m_compress_blocks;
+    double m_compress_threshold;
+    bool m_relaxed_stack;
+    bool m_equal_thread_memory;
+    bool m_memory_report;
+    bool m_profile;
+    bool m_profile_counters;
+    bool m_wait_report;
+    // machine balance of profile_counters: peak GFLOP/s and GB/s of a rank
+    double m_profile_peak_gflops, m_profile_peak_bandwidth;
+    double m_integral_screen_tol;
+    int m_model_hamiltonian;
+    bool m_integral_cache;
+    double m_mixed_precision_tol;
+    bool m_davidson_disk_subspace;
+    double m_davidson_adaptive_tol;
+    bool m_lanczos_reorth;
+    bool m_davidson_block_roots;
+    bool m_davidson_distributed_subspace;
+    bool m_gpu_davidson;
+    bool m_checkpoint_manifest;
+    bool m_hierarchical_bcast;
+    bool m_prune_quanta;
+    bool m_cache_dot_blocks;
+    int m_small_gemm_size;
+    bool m_hugepage_stack;
+    int m_single_precision_ops;
+    bool m_adaptive_threads;
+    bool m_npdm_op_store;
+    bool m_onepdm_single_sweep;
+    bool m_onepdm_in_sweep;
+    bool m_twopdm_with_onepdm;
+    int m_onepdm_binary;
+    bool m_onepdm_text;
+    double m_npdm_screen_tol;
+    bool m_npdm_norm_screen;
+    std::vector<double> m_response_frequencies;
+    int m_nevpt_groups;
+    int m_buffered_output;
+    bool m_operator_statistics;
+    double m_adaptive_schedule;
+    bool m_twodot_to_onedot_auto;
+    double m_onedot_switch_energy;
+    double m_onedot_switch_dw;
+    std::size_t m_block_cache_memory;
+    std::string m_local_scratch;
+    std::size_t m_local_scratch_size;
+    std::vector<std::string> m_stripe_dirs;
+    std::size_t m_pipeline_memory;
+    bool m_access_ordered_blocks;
+    int m_restore_threads;
+    bool m_restore_direct;
+    bool m_scratch_gc;
+    double m_memory_pressure;
+    bool m_plan;
+    double m_plan_gflops;
+    int m_dm_oversampling;
+    bool m_flat_disk_format;
+    bool m_convert_disk_format;
+    bool m_single_precision_waves;
+    bool m_column_block_layout;
+    double m_element_cache;
+    bool m_save_single_waves;
+    bool m_stream_renormalisation;
+    double m_operator_screen_tol;
+    bool m_term_fusion;
+    int m_davidson_warm_vectors;
+    bool m_jacobi_davidson;
+    int m_jacobi_inner, m_jacobi_sector_size;
+    distributionTypes m_operator_distribution;
+    double m_shared_operator_memory;
+    int m_realspace_segments;
+    bool m_parallel_warmup;
+    double m_gpu_gemm_size;
     std::size_t m_memory;
     bool m_useSharedMemory;
     double *m_IntegralMemoryStart;
@@ -72,6 +150,7 @@ class Input {
     vector<int> m_baseState;
     vector<int> m_projectorState;
     int m_targetState;
+    std::vector<int> m_targetStates;
     int m_guessState;
 
     std::vector<int> m_hf_occupancy;
@@ -91,6 +170,7 @@ class Input {
     int m_maxM;
     int m_bra_M;
     int m_integral_disk_storage_thresh;
+    bool m_distributed_integrals;
     int m_num_Integrals;
 
     bool m_do_diis;
@@ -115,6 +195,8 @@ class Input {
     bool m_store_spinpdm;
     bool m_spatpdm_disk_dump;
     bool m_pdm_unsorted;
+    bool m_npdm_tiles;
+    int m_npdm_contract;
     bool m_store_nonredundant_pdm;
     bool m_npdm_intermediate;
     std::vector<int> m_specificpdm;
@@ -123,6 +205,7 @@ class Input {
     int m_maxiter;
     double m_oneindex_screen_tol;
     double m_twoindex_screen_tol;
+    double m_twoindex_screen_budget;
     bool m_no_transform;
     bool m_add_noninteracting_orbs;
 
@@ -154,6 +237,8 @@ class Input {
     bool m_backward;
     bool m_fullrestart;
     bool m_restart_warm;
+    int m_warm_restart_sweeps;
+    std::string m_restart_from;
     bool m_reset_iterations;
     bool m_implicitTranspose;
 
@@ -180,6 +265,10 @@ class Input {
     std::vector<int>
         m_reorder; // this can be manual, fiedler, gaopt or noreorder
     string m_gaconffile;
+    // couplings below this fraction of the largest are left out of the
+    // Fiedler graph, and multilevel starts its eigensolver from coarser graphs
+    double m_fiedler_threshold;
+    bool m_fiedler_multilevel;
 
     bool m_calc_ri_4pdm;
     bool m_store_ripdm_readable;
@@ -193,9 +282,44 @@ class Input {
     void serialize(Archive &ar, const unsigned int version) {
         ar &m_lowMemoryAlgorithm &m_memory &m_mkl_thrds &m_quanta_thrds
             &m_thrds_per_node &m_spinAdapted &m_Bogoliubov &m_stateSpecific
-                &m_implicitTranspose &m_num_Integrals;
+                &m_implicitTranspose &m_num_Integrals &m_batched_gemm
+                &m_mmap_blocks &m_prefetch_blocks &m_write_behind_memory
+                &m_compress_blocks &m_compress_threshold &m_relaxed_stack
+                &m_equal_thread_memory
+                &m_memory_report &m_profile &m_profile_counters
+                &m_profile_peak_gflops &m_profile_peak_bandwidth &m_wait_report
+                &m_integral_screen_tol
+                &m_model_hamiltonian
+                &m_integral_cache &m_mixed_precision_tol
+                &m_davidson_disk_subspace &m_davidson_adaptive_tol
+                &m_lanczos_reorth &m_davidson_block_roots \
+                &m_davidson_distributed_subspace &m_dm_oversampling \
+                &m_flat_disk_format &m_convert_disk_format \
+                &m_single_precision_waves &m_column_block_layout \
+                &m_element_cache \
+                &m_stream_renormalisation &m_operator_screen_tol &m_term_fusion \
+                &m_davidson_warm_vectors &m_jacobi_davidson &m_jacobi_inner \
+                &m_jacobi_sector_size \
+                &m_operator_distribution &m_shared_operator_memory \
+                &m_realspace_segments &m_gpu_gemm_size &m_gpu_davidson \
+                &m_checkpoint_manifest &m_hierarchical_bcast &m_prune_quanta \
+                &m_cache_dot_blocks &m_small_gemm_size \
+                &m_hugepage_stack &m_single_precision_ops &m_adaptive_threads \
+                &m_npdm_op_store &m_operator_statistics \
+                &m_adaptive_schedule &m_twodot_to_onedot_auto \
+                &m_onedot_switch_energy &m_onedot_switch_dw \
+                &m_block_cache_memory &m_local_scratch &m_local_scratch_size \
+                &m_stripe_dirs &m_pipeline_memory &m_access_ordered_blocks \
+                &m_restore_threads &m_restore_direct \
+                &m_scratch_gc &m_memory_pressure &m_plan &m_plan_gflops \
+                &m_parallel_warmup \
+                &m_onepdm_single_sweep &m_onepdm_in_sweep &m_onepdm_binary \
+                &m_onepdm_text &m_twopdm_with_onepdm \
+                &m_npdm_screen_tol &m_npdm_norm_screen &m_response_frequencies \
+                &m_nevpt_groups &m_buffered_output;
         ar &m_norbs &m_partialSweep &m_alpha &m_beta &m_sweep_type &m_solve_type
-            &m_Sz &m_set_Sz &m_baseState &m_projectorState &m_targetState;
+            &m_Sz &m_set_Sz &m_baseState &m_projectorState &m_targetState
+            &m_targetStates;
         ar &m_spin_vector &m_spin_orbs_symmetry &m_guess_permutations &m_nroots
             &m_weights &m_hf_occ_user &m_hf_occupancy;
         ar &m_sweep_iter_schedule &m_sweep_state_schedule
@@ -216,17 +340,18 @@ class Input {
         ar &m_do_pdm &m_do_npdm_ops &m_do_npdm_in_core &m_npdm_generate
             &m_new_npdm_code &m_specificpdm &m_transition_diff_spatial_irrep
                 &m_occupied_orbitals;
-        ar &m_store_spinpdm &m_spatpdm_disk_dump &m_pdm_unsorted
-            &m_npdm_intermediate &m_npdm_multinode;
+        ar &m_store_spinpdm &m_spatpdm_disk_dump &m_pdm_unsorted &m_npdm_tiles
+            &m_npdm_contract &m_npdm_intermediate &m_npdm_multinode;
         ar &m_maxj &m_ninej &m_maxiter &m_do_deriv &m_oneindex_screen_tol
-            &m_twoindex_screen_tol &m_quantaToKeep &m_noise_type;
+            &m_twoindex_screen_tol &m_twoindex_screen_budget &m_quantaToKeep
+                &m_noise_type;
         ar &m_sweep_tol &m_restart &m_backward &m_fullrestart &m_restart_warm
-            &m_reset_iterations &m_calc_type &m_ham_type &m_warmup;
+            &m_warm_restart_sweeps &m_restart_from &m_reset_iterations &m_calc_type &m_ham_type &m_warmup;
         ar &m_do_diis &m_diis_error &m_start_diis_iter &m_diis_keep_states
             &m_diis_error_tol &m_num_spatial_orbs;
         ar &m_spatial_to_spin &m_spin_to_spatial &m_maxM &m_bra_M
             &m_schedule_type_backward &m_schedule_type_default
-                &m_integral_disk_storage_thresh;
+                &m_integral_disk_storage_thresh &m_distributed_integrals;
         ar &n_twodot_noise &m_twodot_noise &m_twodot_gamma &m_guessState
             &m_useSharedMemory;
         ar &m_calc_ri_4pdm &m_store_ripdm_readable &m_nevpt2
@@ -242,11 +367,16 @@ class Input {
 
   public:
     // Input() : m_ninej(ninejCoeffs::getinstance()){}
-    Input() {}
+    Input() : single_precision_gemm(false), deferred_sigma_sum(false) {}
     Input(const std::string &config_name, const std::string &contents = "");
     // ROA
     int matmultNum;
     vector<double> matmultFlops;
+    // set by block_davidson while the products of MatrixMultiply use sgemm
+    bool single_precision_gemm;
+    // set by block_davidson when it sums the sigma vectors of multiplyH over
+    // the ranks itself
+    bool deferred_sigma_sum;
     void initCumulTimer() {
         getreqMem = boost::shared_ptr<cumulTimer>(new cumulTimer());
         ddscreen = boost::shared_ptr<cumulTimer>(new cumulTimer());
@@ -308,6 +438,8 @@ class Input {
 #endif
     void performSanityTest();
     void generateDefaultSchedule();
+    double *mapSharedIntegrals(long size);
+    void broadcastIntegrals(double *data, long size, bool shared);
     void readorbitalsfile(string &dumpFile, OneElectronArray &v1,
                           TwoElectronArray &v2, double &coreEnergy,
                           int integralIndex);
@@ -328,6 +460,8 @@ class Input {
     std::vector<int> getgaorder_bcs(ifstream &gaconfFile, string &orbitalfile,
                                     std::vector<int> &fiedlerorder);
     std::vector<int> get_fiedler(string &dumpname);
+    // the Fiedler order improved against the cost model of costorder.h
+    std::vector<int> get_costorder(string &dumpname);
     std::vector<int> get_fiedler_nevpt(string &dumpname, int nact);
     std::vector<int> get_fiedler_bcs(string &dumpname);
     void usedkey_error(string &key, string &line);
@@ -393,6 +527,9 @@ class Input {
     std::vector<int> &get_closedorbs() { return m_closedorbs; }
     const std::vector<int> &baseStates() const { return m_baseState; }
     const int &targetState() const { return m_targetState; }
+    // all the states of the targetState keyword, a compression of several
+    // targets onto the base state runs one after the other
+    const std::vector<int> &targetStates() const { return m_targetStates; }
     const int &guessState() const { return m_guessState; }
     int &setGuessState() { return m_guessState; }
     const std::vector<int> &projectorStates() const { return m_projectorState; }
@@ -422,9 +559,277 @@ class Input {
     const int &start_diis_iter() const { return m_start_diis_iter; }
     const int &diis_keep_states() const { return m_diis_keep_states; }
     bool get_lowMemoryAlgorithm() { return m_lowMemoryAlgorithm; }
+    const bool &batched_gemm() const { return m_batched_gemm; }
+    bool &batched_gemm() { return m_batched_gemm; }
+    const bool &mmap_blocks() const { return m_mmap_blocks; }
+    bool &mmap_blocks() { return m_mmap_blocks; }
+    const bool &prefetch_blocks() const { return m_prefetch_blocks; }
+    bool &prefetch_blocks() { return m_prefetch_blocks; }
+    // in doubles, 0 means blocks are stored synchronously
+    const std::size_t &write_behind_memory() const {
+        return m_write_behind_memory;
+    }
+    // in doubles, blocks stored while they fit stay in memory, 0 means every
+    // block goes to disk
+    const std::size_t &block_cache_memory() const {
+        return m_block_cache_memory;
+    }
+    // directory for the block files on node-local storage, empty if they
+    // are written to the prefix (see scratch.h)
+    const std::string &local_scratch() const { return m_local_scratch; }
+    // in bytes, 0 means no limit
+    const std::size_t &local_scratch_size() const {
+        return m_local_scratch_size;
+    }
+    // directories, one per device, the data of the uncompressed block files
+    // is striped over; empty if it is in the block file. A restart needs the
+    // same directories in the same order.
+    const std::vector<std::string> &stripe_dirs() const {
+        return m_stripe_dirs;
+    }
+    // in doubles, the largest next environment block that is loaded while
+    // the current step runs, 0 if it is only prefetched into the page cache
+    const std::size_t &pipeline_memory() const { return m_pipeline_memory; }
+    // the operators of a block file are written in the order the first
+    // multiplyH after its last restore used them
+    const bool &access_ordered_blocks() const {
+        return m_access_ordered_blocks;
+    }
+    // threads reading the data of a plain or ordered block file with pread,
+    // 0 if restore reads it with fread. With restore_direct the pieces whose
+    // memory and file offsets are equally aligned bypass the page cache.
+    const int &restore_threads() const { return m_restore_threads; }
+    const bool &restore_direct() const { return m_restore_direct; }
+    // the environment block files are removed once the sweep has read them
+    const bool &scratch_gc() const { return m_scratch_gc; }
+    // a new block whose core operators would take more than this share of
+    // the free stack keeps some operator classes out of memory, built on the
+    // fly by multiplyH as in direct mode; 0 is off
+    double memory_pressure() const { return m_memory_pressure; }
+    // only plan the calculation: the block sizes, memory, disk and flops of
+    // the sweeps, at plan_gflops GFLOP/s per thread for the time
+    const bool &plan() const { return m_plan; }
+    double plan_gflops() const { return m_plan_gflops; }
+    const bool &compress_blocks() const { return m_compress_blocks; }
+    bool &compress_blocks() { return m_compress_blocks; }
+    // operators with a smaller norm are saved in single precision
+    const double &compress_threshold() const { return m_compress_threshold; }
+    double &compress_threshold() { return m_compress_threshold; }
+    // singlePrecisionOps classes whose operators are all saved in single
+    // precision, whatever their norm
+    const int &single_precision_ops() const { return m_single_precision_ops; }
+    int &single_precision_ops() { return m_single_precision_ops; }
+    // allow Stackmem to be freed out of order
+    const bool &relaxed_stack() const { return m_relaxed_stack; }
+    bool &relaxed_stack() { return m_relaxed_stack; }
+    const bool &equal_thread_memory() const { return m_equal_thread_memory; }
+    bool &equal_thread_memory() { return m_equal_thread_memory; }
+    const bool &memory_report() const { return m_memory_report; }
+    bool &memory_report() { return m_memory_report; }
+    const bool &profile() const { return m_profile; }
+    bool &profile() { return m_profile; }
+    const bool &profile_counters() const { return m_profile_counters; }
+    double profile_peak_gflops() const { return m_profile_peak_gflops; }
+    double profile_peak_bandwidth() const { return m_profile_peak_bandwidth; }
+    // compute and blocked time of the ranks per sweep position, see
+    // WaitScope
+    const bool &wait_report() const { return m_wait_report; }
+    // two electron integrals with |v| <= this are dropped, 0 keeps them all
+    const double &integral_screen_tol() const { return m_integral_screen_tol; }
+    double &integral_screen_tol() { return m_integral_screen_tol; }
+    // screening of the operators by the locality of the integrals: 1 on, 0
+    // off, -1 if the two electron integrals are short ranged
+    const int &model_hamiltonian() const { return m_model_hamiltonian; }
+    int &model_hamiltonian() { return m_model_hamiltonian; }
+    // keep the integrals of the FCIDUMP in a binary <FCIDUMP>.cache
+    const bool &integral_cache() const { return m_integral_cache; }
+    bool &integral_cache() { return m_integral_cache; }
+    // Davidson uses sgemm products until the residual is below this, 0 is off
+    const double &mixed_precision_tol() const { return m_mixed_precision_tol; }
+    double &mixed_precision_tol() { return m_mixed_precision_tol; }
+    // keep the Davidson basis and sigma vectors in a mapped scratch file
+    const bool &davidson_disk_subspace() const {
+        return m_davidson_disk_subspace;
+    }
+    bool &davidson_disk_subspace() { return m_davidson_disk_subspace; }
+    // factor of the site Davidson tolerance from the previous energy change
+    // and discarded weight at that position, 0 is off
+    const double &davidson_adaptive_tol() const {
+        return m_davidson_adaptive_tol;
+    }
+    double &davidson_adaptive_tol() { return m_davidson_adaptive_tol; }
+    // the lanczos solver also orthogonalises against its restart vector
+    const bool &lanczos_reorth() const { return m_lanczos_reorth; }
+    bool &lanczos_reorth() { return m_lanczos_reorth; }
+    // Davidson expands the subspace with the residuals of all unconverged
+    // roots in every iteration
+    const bool &davidson_block_roots() const { return m_davidson_block_roots; }
+    bool &davidson_block_roots() { return m_davidson_block_roots; }
+    // every rank keeps only its sectors of the Davidson subspace vectors, the
+    // full vectors are only assembled for multiplyH
+    const bool &davidson_distributed_subspace() const {
+        return m_davidson_distributed_subspace;
+    }
+    bool &davidson_distributed_subspace() {
+        return m_davidson_distributed_subspace;
+    }
+    // oversampling of the randomised density matrix decimation, 0 for the
+    // full decomposition of every sector
+    const int &dm_oversampling() const { return m_dm_oversampling; }
+    int &dm_oversampling() { return m_dm_oversampling; }
+    // rotation matrices and wavefunctions are saved as flat files
+    const bool &flat_disk_format() const { return m_flat_disk_format; }
+    bool &flat_disk_format() { return m_flat_disk_format; }
+    // the boost archives in the load directory are converted to flat files
+    // at startup
+    const bool &convert_disk_format() const { return m_convert_disk_format; }
+    bool &convert_disk_format() { return m_convert_disk_format; }
+    // the wavefunctions of the sweeps before the last stage of the schedule
+    // are saved in single precision, they only serve as guesses
+    const bool &single_precision_waves() const {
+        return m_single_precision_waves;
+    }
+    // the blocks of the operators are laid out column after column
+    // (StackSparseMatrix::allocate)
+    const bool &column_block_layout() const { return m_column_block_layout; }
+    // the blocks of the operators built on the fly in Davidson are kept in
+    // up to this fraction of the stack memory (elementcache.h)
+    double element_cache() const { return m_element_cache; }
+    // set by Sweep::do_one for the sweep in progress
+    const bool &save_single_waves() const { return m_save_single_waves; }
+    bool &save_single_waves() { return m_save_single_waves; }
+    // the rotated operators go through scratch files, so that the old block
+    // is released before the new one is allocated
+    const bool &stream_renormalisation() const {
+        return m_stream_renormalisation;
+    }
+    bool &stream_renormalisation() { return m_stream_renormalisation; }
+    // operator products in H psi whose norm bound is below this are
+    // skipped, 0 applies all of them
+    const double &operator_screen_tol() const { return m_operator_screen_tol; }
+    double &operator_screen_tol() { return m_operator_screen_tol; }
+    // the two index products of a small loop block are fused into fewer
+    // products where the cost model of multiplyH finds it pays
+    const bool &term_fusion() const { return m_term_fusion; }
+    // the Ritz vectors next to the roots that Davidson keeps at a site and
+    // transforms into the initial subspace of the next one, 0 for none
+    const int &davidson_warm_vectors() const { return m_davidson_warm_vectors; }
+    // Davidson expands the subspace with the Jacobi-Davidson correction,
+    // from jacobi_inner GMRES steps on a block-diagonal model of H whose
+    // sectors of at most jacobi_sector_size elements are solved exactly
+    const bool &jacobi_davidson() const { return m_jacobi_davidson; }
+    const int &jacobi_inner() const { return m_jacobi_inner; }
+    const int &jacobi_sector_size() const { return m_jacobi_sector_size; }
+    // how the distributed operator indices are assigned to the mpi ranks
+    const distributionTypes &operator_distribution() const {
+        return m_operator_distribution;
+    }
+    distributionTypes &operator_distribution() {
+        return m_operator_distribution;
+    }
+    // GB per node of mpi shared memory that holds one copy of the operators
+    // replicated on every rank, 0 keeps a copy per rank
+    const double &shared_operator_memory() const {
+        return m_shared_operator_memory;
+    }
+    double &shared_operator_memory() { return m_shared_operator_memory; }
+    // number of rank groups that optimise segments of the two-dot sweeps at
+    // the same time, 1 for the usual sweeps
+    const int &realspace_segments() const { return m_realspace_segments; }
+    int &realspace_segments() { return m_realspace_segments; }
+    // the groups of realspace_segments also share the warm-up sweep, each
+    // starting its range from a guess block
+    const bool &parallel_warmup() const { return m_parallel_warmup; }
+    bool &parallel_warmup() { return m_parallel_warmup; }
+    // products of at least this many multiply-adds run on the gpu (builds
+    // with CUDA), 0 keeps all of them on the cpu
+    const double &gpu_gemm_size() const { return m_gpu_gemm_size; }
+    double &gpu_gemm_size() { return m_gpu_gemm_size; }
+    // keep the Davidson vectors on the gpu and do all vector operations
+    // there, needs gpu_gemm_size
+    const bool &gpu_davidson() const { return m_gpu_davidson; }
+    bool &gpu_davidson() { return m_gpu_davidson; }
+    // files are replaced atomically and every sweep position writes a
+    // manifest of them that restart checks, see checkpoint.h
+    const bool &checkpoint_manifest() const { return m_checkpoint_manifest; }
+    bool &checkpoint_manifest() { return m_checkpoint_manifest; }
+    // blocks keep only the sectors the complementary sites can still complete
+    // to the target quantum; blocks, rotation matrices and wavefunctions of a
+    // calculation and its restarts have to use the same value
+    const bool &prune_quanta() const { return m_prune_quanta; }
+    bool &prune_quanta() { return m_prune_quanta; }
+    // the single site dot blocks are built once before the sweeps and shared
+    // by all steps, see initialiseSingleSiteBlocks
+    const bool &cache_dot_blocks() const { return m_cache_dot_blocks; }
+    bool &cache_dot_blocks() { return m_cache_dot_blocks; }
+    // products with all dimensions up to this size use the small gemm
+    // kernels instead of dgemm, 0 is off; at most SMALL_GEMM_MAX
+    const int &small_gemm_size() const { return m_small_gemm_size; }
+    int &small_gemm_size() { return m_small_gemm_size; }
+    // huge pages for the stack memory, first touched by every thread in its
+    // share, see AllocateStackMemory
+    const bool &hugepage_stack() const { return m_hugepage_stack; }
+    bool &hugepage_stack() { return m_hugepage_stack; }
+    // quanta_thrds x mkl_thrds is split anew for every Davidson solve and
+    // renormalisation from the block sizes, see ThreadSplit
+    const bool &adaptive_threads() const { return m_adaptive_threads; }
+    bool &adaptive_threads() { return m_adaptive_threads; }
+    // the disk based NPDM operators go to one indexed and compressed store
+    // per operator array, see SaveStoredOperator
+    const bool &npdm_op_store() const { return m_npdm_op_store; }
+    bool &npdm_op_store() { return m_npdm_op_store; }
+    // the onepdm of every state, or with transition densities of every pair
+    // of states, from one sweep in the state-averaged basis
+    const bool &onepdm_single_sweep() const { return m_onepdm_single_sweep; }
+    bool &onepdm_single_sweep() { return m_onepdm_single_sweep; }
+    // the onepdm of every state accumulated during the one-dot sweeps of the
+    // last schedule stage, in place of the separate onepdm sweep
+    const bool &onepdm_in_sweep() const { return m_onepdm_in_sweep; }
+    bool &onepdm_in_sweep() { return m_onepdm_in_sweep; }
+    // the twopdm sweep also saves the onepdm, from the same blocks and operators
+    const bool &twopdm_with_onepdm() const { return m_twopdm_with_onepdm; }
+    bool &twopdm_with_onepdm() { return m_twopdm_with_onepdm; }
+    // the onepdm containers reduce over the ranks in place and write the spin
+    // and spatial densities to one file, 1 raw and 2 with a NumPy header; 0
+    // (the default) keeps the textual reduction
+    const int &onepdm_binary() const { return m_onepdm_binary; }
+    int &onepdm_binary() { return m_onepdm_binary; }
+    // the onepdm text files are written, with onepdm_binary only if asked
+    const bool &onepdm_text() const { return m_onepdm_text; }
+    bool &onepdm_text() { return m_onepdm_text; }
+    // 3- and 4-PDM elements below this are not stored, 0 keeps all of them
+    const double &npdm_screen_tol() const { return m_npdm_screen_tol; }
+    double &npdm_screen_tol() { return m_npdm_screen_tol; }
+    // with npdm_screen_tol, operator combinations whose norm product is below
+    // it are not contracted
+    const bool &npdm_norm_screen() const { return m_npdm_norm_screen; }
+    bool &npdm_norm_screen() { return m_npdm_norm_screen; }
+    // a response sweep solves (H - w) x = V psi for each of these w, one
+    // correction vector per state of targetState in the basis of the first
+    const std::vector<double> &response_frequencies() const {
+        return m_response_frequencies;
+    }
+    // counts, blocks, memory, norms and multiplyH uses of the operators of
+    // every printed block, see recordOperatorStatistics
+    const bool &operator_statistics() const { return m_operator_statistics; }
+    bool &operator_statistics() { return m_operator_statistics; }
+    // discarded weight the states of the schedule are raised to after each
+    // converged stage, 0 is off; see SweepParams::end_adaptive_sweep
+    const double &adaptive_schedule() const { return m_adaptive_schedule; }
+    double &adaptive_schedule() { return m_adaptive_schedule; }
+    const int &maxM() const { return m_maxM; }
+    // operator and wavefunction broadcasts go to the node leaders first and
+    // then within the nodes
+    const bool &hierarchical_bcast() const { return m_hierarchical_bcast; }
+    bool &hierarchical_bcast() { return m_hierarchical_bcast; }
     bool use_partial_two_integrals() const {
         return (m_norbs / 2 >= m_integral_disk_storage_thresh);
     }
+    // the integral slices of the dot blocks are spread over the ranks and
+    // fetched from their owners, see DistributeIntegralSlices
+    bool distributed_integrals() const {
+        return m_distributed_integrals && use_partial_two_integrals();
+    }
     int getPartialSweep() const { return m_partialSweep; }
     int &setPartialSweep() { return m_partialSweep; }
     bool &set_fullrestart() { return m_fullrestart; }
@@ -438,8 +843,15 @@ class Input {
     double &set_twodot_gamma() { return m_twodot_gamma; }
     const bool &get_restart() const { return m_restart; }
     const bool &get_restart_warm() const { return m_restart_warm; }
+    // sweeps after the blocks are regenerated with new integrals, 0 unless
+    // warm_restart_sweeps is given
+    const int &warm_restart_sweeps() const { return m_warm_restart_sweeps; }
+    // prefix of the calculation whose MPS the warm restart starts from,
+    // empty for the own prefix
+    const std::string &restart_from() const { return m_restart_from; }
     const bool &get_reset_iterations() const { return m_reset_iterations; }
     const ninejCoeffs &get_ninej() const { return m_ninej; }
+    int get_maxj() const { return m_maxj; }
     const hamTypes &hamiltonian() const { return m_ham_type; }
     const WarmUpTypes &warmup() const { return m_warmup; }
     const int &guess_permutations() const { return m_guess_permutations; }
@@ -447,6 +859,8 @@ class Input {
     std::vector<int> thrds_per_node() const { return m_thrds_per_node; }
     int mkl_thrds() const { return m_mkl_thrds; }
     int quanta_thrds() const { return m_quanta_thrds; }
+    int &set_mkl_thrds() { return m_mkl_thrds; }
+    int &set_quanta_thrds() { return m_quanta_thrds; }
     const calcType &calc_type() const { return m_calc_type; }
     calcType &set_calc_type() { return m_calc_type; }
     const solveTypes &solve_method() const { return m_solve_type; }
@@ -456,6 +870,17 @@ class Input {
     const algorithmTypes &algorithm_method() const { return m_algorithm_type; }
     algorithmTypes &set_algorithm_method() { return m_algorithm_type; }
     int twodot_to_onedot_iter() const { return m_twodot_to_onedot_iter; }
+    // with "twodot_to_onedot auto" the switch sweep is set during the run by
+    // SweepParams::end_twodot_sweep from these energy change and discarded
+    // weight thresholds
+    int &set_twodot_to_onedot_iter() { return m_twodot_to_onedot_iter; }
+    const bool &twodot_to_onedot_auto() const {
+        return m_twodot_to_onedot_auto;
+    }
+    const double &onedot_switch_energy() const {
+        return m_onedot_switch_energy;
+    }
+    const double &onedot_switch_dw() const { return m_onedot_switch_dw; }
     std::vector<std::map<SpinQuantum, int>> &get_quantaToKeep() {
         return m_quantaToKeep;
     }
@@ -556,6 +981,12 @@ class Input {
     double &oneindex_screen_tol() { return m_oneindex_screen_tol; }
     const double &twoindex_screen_tol() const { return m_twoindex_screen_tol; }
     double &twoindex_screen_tol() { return m_twoindex_screen_tol; }
+    // with a budget the two-index screening threshold of each block is
+    // chosen by screen.C:twoindex_screen_tol
+    const double &twoindex_screen_budget() const {
+        return m_twoindex_screen_budget;
+    }
+    double &twoindex_screen_budget() { return m_twoindex_screen_budget; }
     const int &total_spin() const { return m_total_spin; }
     const std::vector<int> &spin_vector() const { return m_spin_vector; }
     const std::string &save_prefix() const { return m_save_prefix; }
@@ -633,6 +1064,11 @@ class Input {
     bool &spatpdm_disk_dump() { return m_spatpdm_disk_dump; }
     const bool &pdm_unsorted() const { return m_pdm_unsorted; }
     bool &pdm_unsorted() { return m_pdm_unsorted; }
+    const bool &npdm_tiles() const { return m_npdm_tiles; }
+    bool &npdm_tiles() { return m_npdm_tiles; }
+    // NpdmContraction flags, 0 if the 3PDM / 4PDM is stored as usual
+    const int &npdm_contract() const { return m_npdm_contract; }
+    int &npdm_contract() { return m_npdm_contract; }
     const std::vector<int> &specificpdm() const { return m_specificpdm; }
     std::vector<int> &specificpdm() { return m_specificpdm; }
     const bool &store_nonredundant_pdm() const {
@@ -646,6 +1082,12 @@ class Input {
     const int &virt_size() const { return m_virt_size; }
     const int &total_size() const { return m_total_orbs; }
     const int &nevpt_state_num() const { return m_nevpt_state_num; }
+    // the perturbers of MPS-NEVPT2 run in this many groups of the ranks at
+    // once, see SplitPerturberGroups
+    const int &nevpt_groups() const { return m_nevpt_groups; }
+    // output goes through a buffer that a background thread writes every
+    // this many milliseconds, 0 writes it at once
+    const int &buffered_output() const { return m_buffered_output; }
     bool &spinAdapted() { return m_spinAdapted; }
     bool &npdm_intermediate() { return m_npdm_intermediate; }
     const bool &npdm_intermediate() const { return m_npdm_intermediate; }
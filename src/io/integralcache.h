@@ -0,0 +1,91 @@
+/*
+Developed by Sandeep Sharma and Garnet K.-L. Chan, 2012
+Copyright (c) 2012, Garnet K.-L. Chan
+
+This program is integrated in Molpro with the permission of
+Sandeep Sharma and Garnet K.-L. Chan
+*/
+
+#ifndef SPIN_INTEGRAL_CACHE_HEADER
+#define SPIN_INTEGRAL_CACHE_HEADER
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace SpinAdapted {
+
+// one line of the integral part of an FCIDUMP, indices already shifted to
+// start at 0 (so -1 marks an unused index)
+struct IntegralLine {
+    double value;
+    int i, j, k, l;
+};
+
+// Parses the integral lines of an FCIDUMP from the current position of
+// dumpFile to its end. The text is read in one go and the lines are parsed
+// in parallel; comments after ! and empty lines are skipped. Returns false
+// and the offending line in badline if a line is not one value followed by
+// four indices.
+bool ReadIntegralLines(std::istream &dumpFile, int offset,
+                       std::vector<IntegralLine> &lines, std::string &badline);
+
+// Binary cache of the integrals of a spin restricted FCIDUMP with the
+// 8-fold permutational symmetry unpacked. t and v use the layout of TInt and
+// VInt in pyblock/qchem/fcidump.py (lower triangles over orbital pairs), so
+// the file is shared with the python side. Layout, little endian:
+//
+//   0   char[8]  "BLKFCI01"
+//   8   int64    norb
+//   16  int64    size of the FCIDUMP the cache was made from
+//   24  int64    modification time (seconds) of that FCIDUMP
+//   32  uint64   checksum of t and v, see Checksum
+//   40  double   core energy
+//   48  int64[2] reserved
+//   64  double   t[norb (norb + 1) / 2], then v[m (m + 1) / 2], m = norb (norb + 1) / 2
+//
+// The cache is valid for an FCIDUMP of the same size and modification time.
+class IntegralCache {
+  private:
+    void *map;
+    size_t length;
+    IntegralCache(const IntegralCache &);
+    IntegralCache &operator=(const IntegralCache &);
+
+  public:
+    int norb;
+    double ecore;
+    const double *t, *v;
+
+    IntegralCache() : map(0), length(0), norb(0), ecore(0.), t(0), v(0) {}
+    ~IntegralCache() { Close(); }
+
+    static long Pair(int i, int j) {
+        return i >= j ? (long)i * (i + 1) / 2 + j : (long)j * (j + 1) / 2 + i;
+    }
+    double T(int i, int j) const { return t[Pair(i, j)]; }
+    // (ij|kl), chemist notation as in the FCIDUMP
+    double V(int i, int j, int k, int l) const {
+        long p = Pair(i, j), q = Pair(k, l);
+        return v[p >= q ? p * (p + 1) / 2 + q : q * (q + 1) / 2 + p];
+    }
+    long TSize() const { return Pair(norb - 1, 0) + 1; }
+    long VSize() const { return TSize() * (TSize() + 1) / 2; }
+
+    // maps file read only. Fails (with a message) unless it is a complete
+    // cache of source with the right checksum.
+    bool Open(const std::string &file, const std::string &source);
+    void Close();
+
+    // fills t, v and ecore from the lines of an FCIDUMP (as returned by
+    // ReadIntegralLines) and writes them to file
+    static void Write(const std::string &file, const std::string &source,
+                      int norb, const std::vector<IntegralLine> &lines);
+
+    // position weighted sum of the 64 bit words of data, starting at word
+    // index start
+    static unsigned long long Checksum(const double *data, long n,
+                                       long start);
+};
+
+} // namespace SpinAdapted
+#endif
@@ -0,0 +1,58 @@
+/*
+Developed by Sandeep Sharma and Garnet K.-L. Chan, 2012
+Copyright (c) 2012, Garnet K.-L. Chan
+
+This program is integrated in Molpro with the permission of
+Sandeep Sharma and Garnet K.-L. Chan
+*/
+
+#ifndef SPIN_METRICS_HEADER_H
+#define SPIN_METRICS_HEADER_H
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace SpinAdapted {
+
+// The counters of one sweep position of this rank, for the block.metrics
+// module of the python interface
+struct PositionMetrics {
+    int sweep, block, sites;
+    bool forward;
+    double energy;           // lowest of the roots
+    double discarded_weight; // largest of the position
+    long davidson_iterations;
+    double multiplyH_time, multiplyH_flops;
+    // peaks of all the Stackmem and of all the data pages, in bytes
+    double stack_peak, datapage_peak;
+    // blocks written by store and read by restore
+    double io_bytes, io_time;
+    // in the MPI collectives, see WaitScope
+    double wait_time;
+    double wall_time;
+};
+
+// Off by default: then the counting calls only test metricsOn. On, a record
+// is taken at the end of every sweep position, kept in the history and
+// passed to the callback, which runs on the thread of the sweep.
+extern bool metricsOn;
+void enableMetrics(bool on);
+void setMetricsCallback(const std::function<void(const PositionMetrics &)> &f);
+// a copy, safe against the sweep adding records meanwhile
+std::vector<PositionMetrics> metricsHistory();
+void clearMetrics();
+// the history as one json object per line, for the report of report.h
+void writeMetrics(const std::string &file);
+
+void metricsDavidsonIteration();
+void metricsFlops(double flops);
+void metricsBlockIO(double bytes);
+// takes the peaks of the allocators into the position before memory_report
+// resets them
+void metricsNotePeaks();
+void metricsPositionStart();
+void metricsPositionEnd(int sweep, int block, int sites, bool forward,
+                        double energy, double discarded_weight);
+
+} // namespace SpinAdapted
+#endif
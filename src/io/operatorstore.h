@@ -0,0 +1,44 @@
+/*
+Developed by Sandeep Sharma and Garnet K.-L. Chan, 2012
+Copyright (c) 2012, Garnet K.-L. Chan
+
+This program is integrated in Molpro with the permission of
+Sandeep Sharma and Garnet K.-L. Chan
+*/
+
+#ifndef SPIN_OPERATORSTORE_HEADER
+#define SPIN_OPERATORSTORE_HEADER
+#include <string>
+#include <vector>
+
+namespace SpinAdapted {
+
+// Storage of the disk based NPDM operators (keyword npdm_op_store) in place
+// of one file per operator. The operators of one array (the key up to its
+// ".tmp", e.g. CreCreCre_p0) share one file, indexed in memory by key, so
+// every operator is one pread wherever it is. Saving queues a copy and
+// returns, a writer thread deflates the data (see writeCompressedData) and
+// puts it into the first free slot large enough or at the end. Loading an
+// operator asks the kernel to read ahead the ones saved after it in the same
+// array, which is the order in which they are built and used.
+
+// an operator found by LoadStoredOperator
+struct StoredOperator {
+    std::string header;        // the shell written by the caller
+    std::vector<char> payload; // compressed data read from the store
+    std::vector<double> data;  // or the data that is still queued
+};
+
+// saves header and the n doubles at data under key, replacing an older
+// operator of the same key
+void SaveStoredOperator(const std::string &key, const std::string &header,
+                        const double *data, long n);
+// false if nothing was saved under key in this run
+bool LoadStoredOperator(const std::string &key, StoredOperator &op);
+// the n doubles of an operator found by LoadStoredOperator
+void UnpackStoredOperator(const StoredOperator &op, double *data, long n);
+// waits for the queued operators and prints how much was stored
+void FinishOperatorStore();
+
+} // namespace SpinAdapted
+#endif
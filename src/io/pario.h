@@ -23,20 +23,35 @@ void print_trace(int sig);
 #define numthrds 1
 #endif
 
+// the p<n>out and p<n>err with n above this are compiled out, e.g. build
+// with -DBLOCK_MAX_OUTPUTLEVEL=1 to drop the per operator prints of the
+// sweep loops whatever the outputlevel of the input
+#ifndef BLOCK_MAX_OUTPUTLEVEL
+#define BLOCK_MAX_OUTPUTLEVEL 3
+#endif
+
 #define pout if (mpigetrank() == 0 && dmrginp.outputlevel() >= 0) bout
 #define perr if (mpigetrank() == 0 && dmrginp.outputlevel() >= 0) berr
 
-#define p1out if (mpigetrank() == 0 && dmrginp.outputlevel() >= 1) bout
-#define p1err if (mpigetrank() == 0 && dmrginp.outputlevel() >= 1) berr
+#define p1out if (BLOCK_MAX_OUTPUTLEVEL >= 1 && dmrginp.outputlevel() >= 1 && mpigetrank() == 0) bout
+#define p1err if (BLOCK_MAX_OUTPUTLEVEL >= 1 && dmrginp.outputlevel() >= 1 && mpigetrank() == 0) berr
 
-#define p2out if (mpigetrank() == 0 && dmrginp.outputlevel() >= 2) bout
-#define p2err if (mpigetrank() == 0 && dmrginp.outputlevel() >= 2) berr
+#define p2out if (BLOCK_MAX_OUTPUTLEVEL >= 2 && dmrginp.outputlevel() >= 2 && mpigetrank() == 0) bout
+#define p2err if (BLOCK_MAX_OUTPUTLEVEL >= 2 && dmrginp.outputlevel() >= 2 && mpigetrank() == 0) berr
 
-#define p3out if (mpigetrank() == 0 && dmrginp.outputlevel() >= 3) bout
-#define p3err if (mpigetrank() == 0 && dmrginp.outputlevel() >= 3) berr
+#define p3out if (BLOCK_MAX_OUTPUTLEVEL >= 3 && dmrginp.outputlevel() >= 3 && mpigetrank() == 0) bout
+#define p3err if (BLOCK_MAX_OUTPUTLEVEL >= 3 && dmrginp.outputlevel() >= 3 && mpigetrank() == 0) berr
 
 extern ostream &bout, &berr;
 
+// bout writes into a buffer of this rank (endl does not flush it) which a
+// background thread hands to the output every interval_ms milliseconds, or
+// at once when it is full. berr is not buffered. What is in the buffer is
+// still written on abort() and exit().
+void startBufferedOutput(int interval_ms);
+// writes the buffer and gives bout its own stream buffer back
+void stopBufferedOutput();
+
 class blockout {
    public:
       ostream *outstream;
@@ -0,0 +1,41 @@
+/*
+Developed by Sandeep Sharma and Garnet K.-L. Chan, 2012
+Copyright (c) 2012, Garnet K.-L. Chan
+
+This program is integrated in Molpro with the permission of
+Sandeep Sharma and Garnet K.-L. Chan
+*/
+
+#ifndef SPIN_PROFILER_HEADER_H
+#define SPIN_PROFILER_HEADER_H
+#include <string>
+
+namespace SpinAdapted {
+
+// Times the enclosing scope when the "profile" keyword is set. Scopes opened
+// while another one is alive on the same thread are recorded as its
+// children, together with the call count, the flops counted in
+// dmrginp.matmultFlops and the bytes passed to profileBytes. With the
+// "profile_counters" keyword the scopes also count cycles, instructions and
+// last level cache misses of the thread, and writeProfile prints the
+// roofline of the regions. name should be a string literal.
+class ProfileScope {
+  private:
+    bool active;
+
+  public:
+    ProfileScope(const char *name);
+    ~ProfileScope();
+};
+
+// counts bytes of operator, wavefunction or density matrix data that this
+// rank sends or receives in an MPI transfer, for the scopes open on the
+// calling thread
+void profileBytes(double bytes);
+
+// writes the calls of all threads as a chrome trace (chrome://tracing) with
+// the per thread call tree in the "summary" entry
+void writeProfile(const std::string &file);
+
+} // namespace SpinAdapted
+#endif
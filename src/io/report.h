@@ -0,0 +1,60 @@
+/*
+Developed by Sandeep Sharma and Garnet K.-L. Chan, 2012
+Copyright (c) 2012, Garnet K.-L. Chan
+
+This program is integrated in Molpro with the permission of
+Sandeep Sharma and Garnet K.-L. Chan
+*/
+
+#ifndef SPIN_REPORT_HEADER_H
+#define SPIN_REPORT_HEADER_H
+#include <map>
+#include <string>
+#include <vector>
+
+namespace SpinAdapted {
+
+// A profiled region, summed over the threads and ranks of a run. The path
+// is the chain of the enclosing regions joined by ';', as in the folded
+// stacks of flamegraph.pl; self is the time not spent in the children.
+struct ReportRegion {
+    long count;
+    double time, self, flops, bytes;
+};
+
+// A sweep position, the wall time is the largest of the ranks and the other
+// counters are sums over the ranks
+struct ReportPosition {
+    int sweep, block, sites, ranks;
+    bool forward;
+    double wall_time, multiplyH_time, multiplyH_flops, io_time, io_bytes,
+        wait_time, stack_peak;
+};
+
+// A completed run as written to its save prefix by the "profile" keyword:
+// the call trees of profile.rank<n>.json and the sweep positions of
+// metrics.rank<n>.json of all the ranks
+struct PerformanceReport {
+    int ranks;
+    std::map<std::string, ReportRegion> regions;
+    std::vector<ReportPosition> positions;
+};
+
+// false, with a message on perr, if there is no profile of rank 0 in prefix
+bool readPerformanceReport(const std::string &prefix,
+                           PerformanceReport &report);
+
+// the self times in microseconds as folded stacks, one "path count" line per
+// region, the input of flamegraph.pl or speedscope
+void writeFlameGraph(const PerformanceReport &report,
+                     const std::string &file);
+
+// the time of the phases and of the sweep positions. With a baseline run the
+// top regions and positions that became slower are listed, by the seconds
+// they lost.
+std::string formatPerformanceReport(const PerformanceReport &report,
+                                    const PerformanceReport *baseline = 0,
+                                    int top = 10);
+
+} // namespace SpinAdapted
+#endif
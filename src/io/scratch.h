@@ -0,0 +1,58 @@
+/*
+Developed by Sandeep Sharma and Garnet K.-L. Chan, 2012
+Copyright (c) 2012, Garnet K.-L. Chan
+
+This program is integrated in Molpro with the permission of
+Sandeep Sharma and Garnet K.-L. Chan
+*/
+
+#ifndef SPIN_SCRATCH_HEADER
+#define SPIN_SCRATCH_HEADER
+#include <stdio.h>
+#include <string>
+
+namespace SpinAdapted {
+
+// Tiered scratch storage, keyword local_scratch <dir> [<size> k|m|g]. The
+// block files, which every sweep step writes and reads, are kept in a
+// directory of this process under dir, usually node-local storage, instead
+// of the prefix on the shared filesystem. The tier before it are the blocks
+// that block_cache keeps in memory. With a size, the least recently used
+// block files beyond it are moved to the prefix by a background thread.
+// The files a restart needs from the sweep history, the block files that are
+// only local, are copied to the prefix at every checkpoint and at the end of
+// the run; rotation matrices, wavefunctions and state files are written to
+// the prefix as before. Files are always named by their path under the
+// prefix, the local one is derived from it.
+
+// the name to write file under, either local or file itself. Waits if an
+// older version of file is being moved or copied.
+std::string ScratchWriteName(const std::string &file);
+// the local file written under the name from ScratchWriteName is complete
+void ScratchCommit(const std::string &file);
+// where file is now
+std::string ScratchReadName(const std::string &file);
+// opens file where it is for reading, 0 if it does not exist
+FILE *ScratchOpen(const std::string &file);
+// copies the local files that are not in the prefix yet and waits for it
+void FlushScratch();
+// flushes, removes the local directory and prints what was moved
+void FinishScratch();
+
+// Garbage collection of the scratch, keyword scratch_gc. A released file is
+// not read again by the calculation. It is dropped from the checkpoint at
+// once and removed, locally and in the prefix, by the next ScratchCollect,
+// which savestate calls after the position that released it is saved, so a
+// restart never needs it. The size of the local directory and the prefix of
+// this rank is measured before every collection and the peak is printed by
+// FinishScratch.
+
+// file will not be read again and goes at the next ScratchCollect
+void ScratchRelease(const std::string &file);
+// file, and its stripes, are written again and are kept
+void ScratchRetain(const std::string &file);
+// removes the released files
+void ScratchCollect();
+
+} // namespace SpinAdapted
+#endif
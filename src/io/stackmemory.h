@@ -0,0 +1,36 @@
+/*
+Developed by Sandeep Sharma and Garnet K.-L. Chan, 2012
+Copyright (c) 2012, Garnet K.-L. Chan
+
+This program is integrated in Molpro with the permission of
+Sandeep Sharma and Garnet K.-L. Chan
+*/
+
+#ifndef SPIN_STACKMEMORY_HEADER
+#define SPIN_STACKMEMORY_HEADER
+#include <cstddef>
+
+namespace SpinAdapted {
+
+// Memory of the Stackmem arena. With the keyword hugepage_stack it is mapped
+// with explicit huge pages (hugetlbfs) if the system has enough of them
+// reserved, otherwise aligned to 2 MB with transparent huge pages requested.
+// Every thread then first touches an equal share of it, so that on a NUMA
+// machine the slices SplitStackmem hands out with equal_thread_memory live on
+// the node of the thread using them (the threads have to be bound, e.g.
+// OMP_PROC_BIND=true). The kind of pages obtained is printed. Without the
+// keyword this is new[].
+double *AllocateStackMemory(std::size_t n);
+// frees memory of AllocateStackMemory
+void FreeStackMemory(double *p);
+
+// Address space for the stacks of threads 1 .. num, n doubles each, in one
+// mapping that is only backed by memory where it has been written (and so on
+// the node of the thread writing it). It is kept for the later calls, which
+// get the same stacks if they ask for no more. 0 if it can not be reserved.
+double *ReserveThreadStacks(std::size_t n, int num);
+// gives the memory of n doubles at p of a thread stack back to the system
+void ReleaseThreadStack(double *p, std::size_t n);
+
+} // namespace SpinAdapted
+#endif
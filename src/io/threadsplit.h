@@ -0,0 +1,45 @@
+/*
+Developed by Sandeep Sharma and Garnet K.-L. Chan, 2012
+Copyright (c) 2012, Garnet K.-L. Chan
+
+This program is integrated in Molpro with the permission of
+Sandeep Sharma and Garnet K.-L. Chan
+*/
+
+#ifndef SPIN_THREADSPLIT_HEADER_H
+#define SPIN_THREADSPLIT_HEADER_H
+#include <chrono>
+#include <utility>
+#include <vector>
+
+namespace SpinAdapted {
+
+// With the keyword adaptive_threads, splits the quanta_thrds x mkl_thrds
+// threads of the input between the loops over quanta blocks and the BLAS
+// calls for the enclosing scope. blocks are the (rows, cols) of the blocks
+// the scope works on. As many quanta threads are used as the work of the
+// blocks keeps busy, the rest goes to BLAS: many small blocks at the edge
+// sites run one gemm per thread, a few large ones in the middle get threaded
+// gemms. The split, the parallelism of the blocks and the time are printed
+// when the scope ends and the input values are restored. Every quanta
+// thread takes its temporaries from the stack of the calling thread, so more
+// quanta threads than in the input need that much more stack memory.
+// Without MKL the number of BLAS threads cannot be set and only the quanta
+// threads change.
+class ThreadSplit {
+  private:
+    bool active;
+    const char *name;
+    int quanta, blas;
+    double parallelism;
+    std::size_t nblocks;
+    std::chrono::steady_clock::time_point start;
+
+  public:
+    ThreadSplit(const char *name,
+                const std::vector<std::pair<int, int>> &blocks);
+    ~ThreadSplit();
+};
+
+} // namespace SpinAdapted
+#endif
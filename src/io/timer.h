@@ -43,6 +43,7 @@ class cumulTimer {
         localStart = -1.0;
         cumulativeSum = 0.;
     }
+    double total() const { return cumulativeSum; }
 
 #ifdef _OPENMP
     void start() {
@@ -179,5 +180,12 @@ class Timer {
 void __GetMachineName(char *machineName);
 void mcheck(const char *message);
 void mdebugcheck(const char *message);
+
+// peak Stackmem and data page usage of a sweep phase (keyword
+// memory_report), each stop appends a line to memory_report.csv
+void memoryPhaseStart();
+void memoryPhaseStop(const char *phase, int sites);
+// prints the largest peak so far and a memory setting that covers it
+void memoryPhaseSummary();
 } // namespace SpinAdapted
 #endif
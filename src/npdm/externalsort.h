@@ -7,9 +7,12 @@
 #include <boost/filesystem.hpp>
 #include <boost/archive/binary_oarchive.hpp>
 #include <boost/archive/binary_iarchive.hpp>
+#include <algorithm>
+#include <string>
 #include <vector> 
 #include <fstream>
 #include <iostream>
+#include <omp.h>
 #define Buff_SIZE 1024*1024*8
 #define merge_buff_size (Buff_SIZE*100) // during the merge of file, only one processor works. More momery available.
 
@@ -128,6 +131,7 @@ class cache
   //Now, it is not implented, because there is no option to detect the end of pieces of one file.
   cache(char* filename, size_t buffer_size, size_t seek_set_of_file =0) {
     cache_size=buffer_size;
+    finishedread=false;
     begin_pointer=(valuetype*) malloc(sizeof(valuetype)*cache_size);
     if(begin_pointer==NULL){
       pout << "cannot allocate memory for cache, abort\n";
@@ -259,139 +263,219 @@ class batch_index{
   }
 };
 
+// Sorts v with OpenMP: every thread sorts one slice, then the sorted slices
+// are merged pairwise in log2(number of slices) rounds.
+template<class T>
+void parallel_sort(std::vector<T>& v){
+  int nslice = 1;
+#ifdef _OPENMP
+  nslice = omp_get_max_threads();
+#endif
+  const long n = v.size();
+  if(nslice <= 1 || n < 1024*nslice){
+    std::sort(v.begin(),v.end());
+    return;
+  }
+  std::vector<long> bound(nslice+1);
+  for(int i=0; i<= nslice; i++)
+    bound[i] = n*i/nslice;
+#pragma omp parallel for schedule(static,1)
+  for(int i=0; i< nslice; i++)
+    std::sort(v.begin()+bound[i],v.begin()+bound[i+1]);
+
+  std::vector<T> other(n);
+  std::vector<T>* from = &v;
+  std::vector<T>* to = &other;
+  for(int width=1; width< nslice; width*=2){
+#pragma omp parallel for schedule(dynamic)
+    for(int i=0; i< nslice; i+=2*width){
+      long lo = bound[i];
+      long mid = bound[std::min(i+width,nslice)];
+      long hi = bound[std::min(i+2*width,nslice)];
+      std::merge(from->begin()+lo,from->begin()+mid,from->begin()+mid,from->begin()+hi,to->begin()+lo);
+    }
+    std::swap(from,to);
+  }
+  if(from != &v) v.swap(other);
+}
+
+// Loser (tournament) tree over the current values of k sorted runs. The run
+// holding the smallest value is top(); pop() advances it and replays only its
+// path to the root, so one merged element costs log2(k) comparisons instead
+// of a scan over all the runs. Ties go to the run with the lower number.
+template<class T>
+class loser_tree{
+  public:
+  loser_tree(std::vector<cache<T>>& runs0):runs(runs0),k(runs0.size()),tree(std::max((int)runs0.size(),1)),alive(runs0.size(),true){
+    if(k>0) tree[0] = build(1);
+  }
+  bool empty() const { return k==0 || !alive[tree[0]]; }
+  int top() const { return tree[0]; }
+  T& value() { return runs[tree[0]].value(); }
+  void pop(){
+    int winner = tree[0];
+    if(!runs[winner].forward()){
+      alive[winner] = false;
+      free(runs[winner].begin_pointer);
+    }
+    for(int node=(winner+k)/2; node>0; node/=2)
+      if(beats(tree[node],winner)) std::swap(tree[node],winner);
+    tree[0] = winner;
+  }
+
+  private:
+  // node >= k is the leaf of run node-k; the inner nodes keep the loser
+  int build(int node){
+    if(node >= k) return node-k;
+    int a = build(2*node);
+    int b = build(2*node+1);
+    if(beats(a,b)){ tree[node] = b; return a; }
+    tree[node] = a;
+    return b;
+  }
+  bool beats(int a, int b){
+    if(!alive[a]) return false;
+    if(!alive[b]) return true;
+    if(runs[a].value() < runs[b].value()) return true;
+    if(runs[b].value() < runs[a].value()) return false;
+    return a < b;
+  }
+  std::vector<cache<T>>& runs;
+  int k;
+  std::vector<int> tree;
+  std::vector<bool> alive;
+};
+
+// Buffered output of sorted data covering the indices [first, end). With
+// addzero only the values are written, one per index, and the indices
+// missing from the data are written as zeros.
+template<class T, bool addzero> 
+class sorted_writer{
+  public:
+  typedef typename T::valuetype valuetype;
+  typedef typename T::indextype indextype;
+  sorted_writer(char* filename, indextype first, indextype end0):next(first),end(end0){
+    outputfile = fopen(filename,"wb");
+    if(outputfile==NULL){
+      pout << "cannot open :"<<filename<<endl;
+      abort();
+    }
+    if(addzero) values.reserve(Buff_SIZE);
+    else elements.reserve(Buff_SIZE);
+  }
+  void put(const T& x){
+    if(addzero){
+      // a repeated index has already been checked to carry the same value
+      if(x.index < next) return;
+      for(; next< x.index; next++) push(0.);
+      push(x.element);
+      next = x.index+1;
+    }
+    else{
+      elements.push_back(x);
+      if(elements.size()==Buff_SIZE) flush();
+    }
+  }
+  void close(){
+    if(addzero)
+      for(; next< end; next++) push(0.);
+    flush();
+    fclose(outputfile);
+  }
+
+  private:
+  void push(valuetype x){
+    values.push_back(x);
+    if(values.size()==Buff_SIZE) flush();
+  }
+  void flush(){
+    if(values.size()) fwrite(&values[0],sizeof(valuetype),values.size(),outputfile);
+    if(elements.size()) fwrite(&elements[0],sizeof(T),elements.size(),outputfile);
+    values.clear();
+    elements.clear();
+  }
+  FILE* outputfile;
+  std::vector<valuetype> values;
+  std::vector<T> elements;
+  indextype next;
+  indextype end;
+};
+
+// Sorts the data of inputfilename into outputfilename. In the MPI build the
+// data of this rank must already belong to its part of the index range (see
+// partition_data). Input that fits into one buffer is sorted in memory,
+// otherwise sorted runs of Buff_SIZE elements are written next to the output
+// and merged with a loser tree.
 template<class T, bool addzero = true > 
 void externalsort(char* inputfilename, char* outputfilename, long number_of_data){
 #ifndef SERIAL
   boost::mpi::communicator world;
   long partition_index=number_of_data/world.size();
-#endif
-  FILE* datafile;
-  FILE* outputfile;
-  long read_size;
-  bool read_success =true;
-  datafile=fopen(inputfilename,"rb");
-  int piecesnumber=0;
-  // sort within different pieces;
-  while(read_success){
-    char tmpfile[100];
-#ifndef SERIAL
-    sprintf (tmpfile, "%s%d%s%d","tmpsortingfile", piecesnumber,".",world.rank());
+  typename T::indextype first_index = partition_index*world.rank();
+  typename T::indextype end_index = world.rank()== world.size()-1 ? number_of_data : partition_index*(world.rank()+1);
 #else
-    sprintf (tmpfile, "%s%d","tmpsortingfile", piecesnumber);
+  typename T::indextype first_index = 0;
+  typename T::indextype end_index = number_of_data;
 #endif
-    outputfile=fopen(tmpfile,"wb");
-    //index_element onepiece[Buff_SIZE];
-    T onepiece[Buff_SIZE];
-    read_size=fread(onepiece,sizeof(T),Buff_SIZE,datafile);
-    if(read_size == 0) break;
-    else if( read_size != Buff_SIZE) read_success =false;
-
-    std::vector<index_element> sortedpiece(onepiece,onepiece+read_size);
-    boost::sort(sortedpiece);
-    std::copy(sortedpiece.begin(),sortedpiece.end(),onepiece);
-  //  loaddata >> onepiece;
-    //file >> onepiece.index;
-    //file >> onepiece.element;
-    //for(int i =0 ; i< Buff_SIZE;i++)
-    //  pout << onepiece[i]<<std::endl;
-    //data.push_back(onepiece[0]);
-    fwrite(onepiece,sizeof(T),read_size,outputfile);
-    piecesnumber++;
-    fclose(outputfile);
-    //pout << "piecenumber: "<<piecesnumber<<std::endl;
+  FILE* datafile=fopen(inputfilename,"rb");
+  if(datafile==NULL){
+    pout << "cannot open :"<<inputfilename<<endl;
+    abort();
+  }
+  const long total = boost::filesystem::file_size(inputfilename)/sizeof(T);
+  sorted_writer<T,addzero> output(outputfilename,first_index,end_index);
+  std::vector<T> piece(std::min(total,(long)Buff_SIZE));
+
+  if(total <= Buff_SIZE){
+    long read_size = total ? fread(&piece[0],sizeof(T),total,datafile) : 0;
+    piece.resize(read_size);
+    fclose(datafile);
+    parallel_sort(piece);
+    for(long i=0; i< piece.size(); i++)
+      output.put(piece[i]);
+    output.close();
+    return;
+  }
 
+  // sort within different pieces;
+  std::vector<std::string> runfiles;
+  for(;;){
+    long read_size=fread(&piece[0],sizeof(T),Buff_SIZE,datafile);
+    if(read_size == 0) break;
+    piece.resize(read_size);
+    parallel_sort(piece);
+    char tmpfile[5000];
+    sprintf (tmpfile, "%s%s%d",outputfilename,".run",(int)runfiles.size());
+    FILE* runfile=fopen(tmpfile,"wb");
+    if(runfile==NULL){
+      pout << "cannot open :"<<tmpfile<<endl;
+      abort();
+    }
+    fwrite(&piece[0],sizeof(T),read_size,runfile);
+    fclose(runfile);
+    runfiles.push_back(tmpfile);
+    if(read_size != Buff_SIZE) break;
+    piece.resize(Buff_SIZE);
   };
   fclose(datafile);
+  std::vector<T>().swap(piece);
+
   // Merge these pieces;
-  
   std::vector<cache<T>> filecache;
-  char tmpfile[100];
-  for(int i =0; i< piecesnumber; i++){
-#ifndef SERIAL
-    sprintf (tmpfile, "%s%d%s%d","tmpsortingfile", i,".",world.rank());
-#else
-    sprintf (tmpfile, "%s%d","tmpsortingfile", i);
-#endif
-
-    //cache<T> tmpcache( tmpfile, Buff_SIZE/piecesnumber);
-    cache<T> tmpcache( tmpfile, Buff_SIZE/20);
-    //cache<T> tmpcache( tmpfile, Buff_SIZE);
+  for(int i =0; i< runfiles.size(); i++){
+    cache<T> tmpcache(&runfiles[i][0], Buff_SIZE/20);
     if(tmpcache.current_position()!= NULL)
       filecache.push_back(tmpcache);
-      //filecache.emplace_back(tmpcache);
-
-  }
-  //pout <<"cachesize"<< filecache.size()<<std::endl;
-  char sortedfile[100];
-
-#ifndef SERIAL
-  typename T::indextype previous_index= partition_index*world.rank()-1;
-#else
-  typename T::indextype previous_index= -1;
-#endif
-  outputfile = fopen(outputfilename,"wb");
-  setvbuf(outputfile,NULL,_IOFBF,3*Buff_SIZE);
-
-  for(;;){
-    // select the smallest one in the current positions of different caches.
-    int smallest = 0;
-    for(int i=1 ; i< filecache.size(); i++){
-      if(filecache[i].value() < filecache[smallest].value())
-        smallest =i;
-    }
-    T current_value = filecache[smallest].value();
-    //outputbuff[outputbuff_position++]=filecache[smallest].value();
-
-    if(addzero){ 
-      int n=(current_value.index - previous_index);
-      for(int i=1; i<n;i++){
-        typename T::valuetype tmp=0.;
-        fwrite(&tmp,sizeof(typename T::valuetype),1,outputfile);
-      }
-      fwrite(&(current_value.element),sizeof(typename T::valuetype),1,outputfile);
-      previous_index=current_value.index;
-    }
     else
-      fwrite(&(filecache[smallest].value()),sizeof(T),1,outputfile);
-
-    if(!filecache[smallest].forward()){
-      filecache.erase(filecache.begin()+smallest);
-      if (filecache.size()==0) {
-        if(addzero){
-          int n;
-#ifndef SERIAL
-          if(world.rank()== world.size()-1)
-            n =number_of_data-current_value.index;
-          else
-            n =(partition_index*(world.rank()+1)-current_value.index);
-#else
-          n =number_of_data-current_value.index;
-#endif
-          
-          for(int i =1; i<n; i++)
-          {
-            typename T::valuetype tmp=0.;
-            fwrite(&tmp,sizeof(typename T::valuetype),1,outputfile);
-          }
-        }
-      break;
-      }
-    }
+      free(tmpcache.begin_pointer);
   }
+  loser_tree<T> merge(filecache);
+  for(; !merge.empty(); merge.pop())
+    output.put(merge.value());
+  output.close();
 
-
-  fclose(outputfile);
-  for(int i=0; i< piecesnumber;i++)
-  {
-    char tmpfile[100];
-#ifndef SERIAL
-    sprintf (tmpfile, "%s%d%s%d","tmpsortingfile", i,".",world.rank());
-#else
-    sprintf (tmpfile, "%s%d","tmpsortingfile", i);
-#endif
-
-    boost::filesystem::remove(tmpfile);
-  }
+  for(int i=0; i< runfiles.size();i++)
+    boost::filesystem::remove(runfiles[i]);
 }
 
 #ifndef SERIAL
@@ -421,9 +505,9 @@ void partition_data(long number_of_data, char* inputfilename, char* outputfilena
     pout <<"processor "<<world.rank()<< " cannot open "<<inputfilename<<std::endl;
     abort();
   }
-  T inputbuff[Buff_SIZE];
+  std::vector<T> inputbuff(Buff_SIZE);
   bool send_end= false;
-  long realsize=fread(inputbuff,sizeof(T),Buff_SIZE,inputfile);
+  long realsize=fread(&inputbuff[0],sizeof(T),Buff_SIZE,inputfile);
   if(realsize==0) {
     fclose(inputfile);
     std::vector<boost::mpi::request> req(world.size());
@@ -451,7 +535,7 @@ void partition_data(long number_of_data, char* inputfilename, char* outputfilena
       }
 
       if(!finished){
-        realsize=fread(inputbuff,sizeof(T),Buff_SIZE,inputfile);
+        realsize=fread(&inputbuff[0],sizeof(T),Buff_SIZE,inputfile);
         if(realsize==0){
           finished=true;
           send_end=true;
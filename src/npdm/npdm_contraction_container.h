@@ -0,0 +1,62 @@
+/*
+Developed by Sandeep Sharma and Garnet K.-L. Chan, 2012
+Copyright (c) 2012, Garnet K.-L. Chan
+
+This program is integrated in Molpro with the permission of
+Sandeep Sharma and Garnet K.-L. Chan
+*/
+
+#ifndef NPDM_CONTRACTION_CONTAINER_H
+#define NPDM_CONTRACTION_CONTAINER_H
+
+#include "npdm.h"
+#include "npdm_container.h"
+#include <vector>
+
+namespace SpinAdapted{
+namespace Npdm{
+
+//===========================================================================================================================================================
+// Container for the npdm_contract option. The spatial 3PDM or 4PDM elements are fed into the selected
+// kernels (NpdmContraction flags) as they are computed and then dropped, so the full tensor is never
+// stored; only the results of the kernels are kept:
+//
+//   trace     the next lower PDM by a partial trace, i.e. the 2PDM (dim^4) from the 3PDM or the
+//             3PDM (dim^6) from the 4PDM, normalised as in the saved PDMs
+//   diagonal  the diagonal elements E^{ijk}_{kji} (E^{ijkl}_{lkji}), dim^3 (dim^4)
+//   energy    the energy from the 2PDM traced down from the 3PDM (4PDM) with v_1, v_2
+//
+// Like Nevpt2_container, every spatial element must be passed once only.
+
+class Npdm_contraction_container : public Npdm_container {
+
+  public:
+    Npdm_contraction_container( int sites, NpdmOrder order );
+
+    void save_npdms(const int &i, const int &j, int integralIndex=0);
+    void store_npdm_elements( const std::vector< std::pair< std::vector<int>, double > > & new_spin_orbital_elements );
+    void clear();
+
+  private:
+    NpdmOrder order_;
+    int nindex_;
+    int dim_;
+    int kernels_;
+    // lower PDM of the trace kernel (the 2PDM for the 3PDM is kept in twopdm_)
+    std::vector<double> trace_;
+    std::vector<double> diagonal_;
+    // 2PDM for the energy
+    std::vector<double> twopdm_;
+
+    void update_contractions( const std::vector< std::pair< std::vector<int>, double > >& spatial_batch );
+    void accumulate( std::vector<double>& v );
+    void save_text( const std::vector<double>& v, int rank, const char* name, const int &i, const int &j );
+    double energy( int integralIndex );
+};
+
+//===========================================================================================================================================================
+
+}
+}
+
+#endif
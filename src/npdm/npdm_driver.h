@@ -8,6 +8,7 @@
 #include "threepdm_container.h"
 #include "fourpdm_container.h"
 #include "pairpdm_container.h"
+#include "npdm_contraction_container.h"
 #include "npdm.h"
 #include "Stackwavefunction.h"
 
@@ -16,6 +17,23 @@ namespace Npdm{
 
 //===========================================================================================================================================================
 
+// Positions of the tasks sorted by decreasing estimated cost. Dynamic OpenMP loops over them start
+// the expensive tasks first, so that the threads do not wait for a large one at the end.
+std::vector<int> largest_first( const std::vector<double>& cost );
+// Number of elements of the intermediate wavefunctions, a cost estimate for contracting with them
+double intermediate_size( const std::map<std::vector<int>, StackWavefunction>& waves );
+
+// The operator wrappers of a block are set up once per cd type while a scope is open, and reused by all
+// the operator patterns and states computed at the sweep position. Scopes nest, the wrappers are released
+// when the outermost one closes, which has to happen before the blocks of the position go away.
+class Npdm_op_wrapper_scope {
+  public:
+    Npdm_op_wrapper_scope();
+    ~Npdm_op_wrapper_scope();
+};
+
+//===========================================================================================================================================================
+
 class Npdm_driver_base {
   public:
     Npdm_driver_base() {}
@@ -109,6 +127,27 @@ class Twopdm_driver : public Npdm_driver_base {
 
 //===========================================================================================================================================================
 
+// The 1PDM and 2PDM from one sweep, each in its own container. At every sweep position the orders are evaluated
+// on the same blocks, and the operator wrappers are set up once for both within the shared scope.
+
+class Onetwopdm_driver : public Npdm_driver_base {
+  public:
+    explicit Onetwopdm_driver( int sites ) : onepdm( sites ), twopdm( sites ) {}
+    void clear() { onepdm.clear(); twopdm.clear(); }
+    void save_data( const int i, const int j, int integralIndex=0 ) { onepdm.save_data(i,j, integralIndex); twopdm.save_data(i,j, integralIndex); }
+    void compute_npdm_elements( std::vector<StackWavefunction> & wavefunctions, const StackSpinBlock & big, int sweepPos, int endPos ) 
+    {
+      Npdm_op_wrapper_scope op_wrapper_scope;
+      onepdm.compute_npdm_elements(wavefunctions, big, sweepPos, endPos );
+      twopdm.compute_npdm_elements(wavefunctions, big, sweepPos, endPos );
+    }
+  private:
+    Onepdm_driver onepdm;
+    Twopdm_driver twopdm;
+};
+
+//===========================================================================================================================================================
+
 class Threepdm_driver : public Npdm_driver_base {
   public:
     explicit Threepdm_driver( int sites ) : container( Threepdm_container(sites) ), driver( Npdm_driver(NPDM_THREEPDM, container) ) {}
@@ -137,6 +176,22 @@ class Fourpdm_driver : public Npdm_driver_base {
 
 //===========================================================================================================================================================
 
+// 3PDM or 4PDM fed into the npdm_contract kernels instead of being stored
+
+class Contracted_npdm_driver : public Npdm_driver_base {
+  public:
+    explicit Contracted_npdm_driver( NpdmOrder order, int sites ) : container( Npdm_contraction_container(sites, order) ), driver( Npdm_driver(order, container) ) {}
+    void clear() { driver.clear(); }
+    void save_data( const int i, const int j, int integralIndex=0 ) { driver.save_data(i,j, integralIndex); }
+    void compute_npdm_elements( std::vector<StackWavefunction> & wavefunctions, const StackSpinBlock & big, int sweepPos, int endPos ) 
+      { driver.compute_npdm_elements(wavefunctions, big, sweepPos, endPos ); }
+  private:
+    Npdm_contraction_container container;
+    Npdm_driver driver;
+};
+
+//===========================================================================================================================================================
+
 class Pairpdm_driver : public Npdm_driver_base {
   public:
     explicit Pairpdm_driver( int sites ) : container( Pairpdm_container(sites) ), driver( Npdm_driver(NPDM_PAIRMATRIX, container) ) {}
@@ -39,6 +39,9 @@ class Npdm_expectations {
     void get_op_string( NpdmSpinOps_base & rhsOps, std::string& op_string);
     void get_op_string( NpdmSpinOps_base & lhsOps, NpdmSpinOps_base & dotOps, std::string& op_string );
 		double diskread_time = 0;
+    // Elements and operator combinations left out by npdm_screen_tol
+    long screened_elements = 0;
+    long screened_contractions = 0;
     std::vector<std::string> intermediate_filenames;
 
 
@@ -51,6 +54,9 @@ class Npdm_expectations {
     const NpdmOrder npdm_order_;
 
     bool screen_op_string_for_duplicates( const std::string& op, const std::vector<int>& indices );
+    bool screen_by_operator_norms( NpdmSpinOps_base& lhsOps, NpdmSpinOps_base& rhsOps, NpdmSpinOps_base& dotOps );
+    void add_screened_elements( const std::vector< std::vector<int> >& so_indices, const std::vector<double>& x,
+                                std::vector< std::pair< std::vector<int>, double > >& new_pdm_elements );
     double contract_spin_adapted_operators( int ilhs, int idot, int irhs, NpdmSpinOps_base& lhsOps, NpdmSpinOps_base& rhsOps, NpdmSpinOps_base& dotOps );
     void build_spin_adapted_singlet_expectations( NpdmSpinOps_base & lhsOps, NpdmSpinOps_base & rhsOps, NpdmSpinOps_base & dotOps);
     void build_spin_adapted_singlet_expectations( const char inner, NpdmSpinOps_base & lhsOps, NpdmSpinOps_base & rhsOps, NpdmSpinOps_base & dotOps, std::map<std::vector<int>, StackWavefunction>& waves );
@@ -7,6 +7,24 @@
 namespace SpinAdapted {
 namespace Npdm {
 
+//===========================================================================================================================================================
+// Spin-adapted to spin-orbital transformation of one cre-des build pattern, e.g. ((CC)(D))(D).
+// The spins of the tensor operators follow from the build pattern, so the pattern is the whole key. The spin-orbital
+// indices are stored for the spatial indices 1,2,3,... and already commuted into NPDM order (cre,cre..,des,des..).
+
+struct Npdm_spin_transform {
+  // Transformation matrix
+  Matrix A;
+  // Rows of A corresponding to singlet expectations
+  std::vector<int> singlet_rows;
+  // Spin-orbital indices ordered according to A
+  std::vector< std::vector<int> > so_indices;
+  // Parity of the commutation into NPDM order
+  int parity;
+  // Columns of inverse(A) in the singlet rows, so x = A^{-1}b is a small matrix-vector product (dim x singlet_rows.size())
+  std::vector<double> singlet_inverse;
+};
+
 //===========================================================================================================================================================
 
 class Npdm_spin_adaptation {
@@ -14,11 +32,15 @@ class Npdm_spin_adaptation {
   public:
     void npdm_set_up_linear_equations( const int dim, const std::string& op_string, const std::vector<int>& indices, const std::vector<double>& b0, 
                                        Matrix& A, ColumnVector& b, std::vector< std::vector<int> >& so_indices );
+    // Spin-orbital elements x from the singlet expectations b0, i.e. the solution of the linear equations above
+    void npdm_transform( const int dim, const std::string& op_string, const std::vector<int>& indices, const std::vector<double>& b0, 
+                         std::vector<double>& x, std::vector< std::vector<int> >& so_indices );
 
-    std::vector<std::map< std::string, Matrix > > stored_A_mats_;
-    std::vector<std::map< std::string, std::vector<int> > > stored_singlet_rows_;
-    std::vector<std::map< std::string, std::vector< std::vector<int> > > > stored_so_indices_;
   private:
+    // Built once per build pattern and shared read-only by all threads (std::map references stay valid on insertion)
+    std::map< std::string, Npdm_spin_transform > transforms_;
+
+    const Npdm_spin_transform& get_transform( const int dim, const int order, const std::string& op_string );
 
     void parse_result_into_matrix( const std::vector<TensorOp>& tensor_ops, 
                                    Matrix& matrix, std::vector< std::vector<int> >& so_indices, std::vector<int>& singlet_rows);
@@ -27,10 +49,10 @@ class Npdm_spin_adaptation {
     int commute_so_indices_to_pdm_order( const std::string& s, std::vector< std::vector<int> >& so_indices);
     std::map< std::vector<int>, double > get_matrix_row ( const TensorOp& op, bool & is_singlet );
     std::map< std::vector<int>, int > get_map_to_int( std::vector< std::map< std::vector<int>, double > > & matrix_rows );
-    void get_so_indices( std::string& cd_string, const std::vector<int>& indices, std::vector< std::vector<int> >& so_indices );
+    void get_so_indices( const std::vector< std::vector<int> >& stored_so_indices, const std::vector<int>& indices, std::vector< std::vector<int> >& so_indices );
 
     void build_new_A_mat( const std::string& op_string, Matrix& A, std::vector<int>& singlet_rows, std::vector<std::vector<int> >& so_indices);
-    void store_new_A_mat( const int so_dim, const int order, const std::string& cd_string );
+    void store_new_A_mat( const int so_dim, const int order, const std::string& cd_string, Npdm_spin_transform& transform );
 
 };
 
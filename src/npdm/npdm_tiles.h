@@ -0,0 +1,91 @@
+/*
+Developed by Sandeep Sharma and Garnet K.-L. Chan, 2012
+Copyright (c) 2012, Garnet K.-L. Chan
+
+This program is integrated in Molpro with the permission of
+Sandeep Sharma and Garnet K.-L. Chan
+*/
+
+#ifndef NPDM_TILES_H
+#define NPDM_TILES_H
+
+#include <stdio.h>
+#include <vector>
+
+namespace SpinAdapted{
+namespace Npdm{
+
+//===========================================================================================================================================================
+// Tiled binary file of a spatial NPDM with `order' orbital indices (6 for the 3PDM, 8 for the 4PDM).
+// The element (i_1, ..., i_order) lives in the tile of its leading order/2 indices, at the position of
+// its trailing order/2 indices, both counted row major.  Every tile is stored on its own, as a list of
+// its nonzero elements when that is smaller than the dense tile, so a reader can fetch a single tile
+// (e.g. all E^{ijkl}_{....} for fixed i,j,k,l) without touching the rest of the O(norb^order) tensor.
+// Layout, little endian:
+//
+//   0   char[8]  "BLKPDMT1"
+//   8   int64    order
+//   16  int64    norb
+//   24  int64    number of tiles = norb^(order/2), also the number of elements of one tile
+//   32  int64    offset of the tile directory
+//   40  int64[3] reserved
+//   64  tile data
+//
+// The directory holds, for every tile, the int64 offset of its data and an int64 count:
+// 0 for a tile of zeros (no data), -1 for a dense tile (tile size doubles), otherwise the
+// number of nonzero elements, stored as count uint32 positions followed by count doubles.
+
+class NpdmTileWriter {
+
+  public:
+    NpdmTileWriter( const char* filename, int order, int norb );
+    ~NpdmTileWriter() { if (file) close(); }
+    long tile_size() const { return size_; }
+    // tiles have to be added in order, tile_size() doubles each
+    void add_tile( const double* tile );
+    // writes the directory; all the tiles must have been added
+    void close();
+
+  private:
+    NpdmTileWriter( const NpdmTileWriter& );
+    NpdmTileWriter& operator=( const NpdmTileWriter& );
+    FILE* file;
+    int order_, norb_;
+    long size_;
+    long offset_;
+    std::vector<long> directory_;
+    std::vector<unsigned int> positions_;
+    std::vector<double> values_;
+};
+
+class NpdmTileReader {
+
+  public:
+    NpdmTileReader( const char* filename );
+    ~NpdmTileReader() { fclose(file); }
+    int order() const { return order_; }
+    int norb() const { return norb_; }
+    long tile_size() const { return size_; }
+    // fills tile_size() doubles
+    void read_tile( long t, double* tile );
+    double element( const std::vector<int>& indices );
+
+  private:
+    NpdmTileReader( const NpdmTileReader& );
+    NpdmTileReader& operator=( const NpdmTileReader& );
+    FILE* file;
+    int order_, norb_;
+    long size_;
+    std::vector<long> directory_;
+};
+
+// Streams the dense file of norb^order doubles written by the external sort into a tiled file,
+// holding one tile in memory at a time.
+void write_npdm_tiles( const char* densefile, const char* tilefile, int order, int norb );
+
+//===========================================================================================================================================================
+
+}
+}
+
+#endif
@@ -44,6 +44,10 @@ class Onepdm_container : public Npdm_container {
     void load_npdm_binary(const int &i, const int &j);
     void accumulate_npdm();
     void accumulate_spatial_npdm();
+    // onepdm_binary: one MPI_Reduce of the whole array into rank 0, and the
+    // spin and spatial arrays in one file
+    void reduce_npdm(array_2d<double>& npdm);
+    void save_combined_npdm_binary(const int &i, const int &j);
   
     void update_full_spin_array( std::vector< std::pair< std::vector<int>, double > >& spin_batch );
     void update_full_spatial_array( std::vector< std::pair< std::vector<int>, double > >& spin_batch );
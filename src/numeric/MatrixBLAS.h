@@ -12,6 +12,7 @@ Sandeep Sharma and Garnet K.-L. Chan
 #include "ObjectMatrix.h"
 #include "StackMatrix.h"
 #include "blas_calls.h"
+#include "gpublas.h"
 #include <cassert>
 #include <cstdio>
 #include <fstream>
@@ -25,6 +26,46 @@ using namespace std;
 
 namespace SpinAdapted {
 
+// column-major c = alpha op(a) op(b) + beta c like dgemm, but the product is
+// done by sgemm on float copies of a and b and then added to c in double
+void dgemm_single(char transa, char transb, FORTINT m, FORTINT n, FORTINT k,
+                  double alpha, const double *a, FORTINT lda, const double *b,
+                  FORTINT ldb, double beta, double *c, FORTINT ldc);
+
+// largest small_gemm_size, the small kernels are instantiated up to it
+const int SMALL_GEMM_MAX = 32;
+
+// column-major c = alpha op(a) op(b) + beta c like dgemm. Depending on the
+// shape the product goes to dgemm_single (while single_precision_gemm is
+// set), to register blocked kernels if m, n and k are at most
+// small_gemm_size, to the device or to dgemm. The calls and flops of every
+// path are counted per thread, see printGemmStatistics.
+void dispatch_dgemm(char transa, char transb, int m, int n, int k,
+                    double alpha, const double *a, int lda, const double *b,
+                    int ldb, double beta, double *c, int ldc);
+// prints the calls and flops of dispatch_dgemm of all threads of this rank
+// by path (tiny is at most 4 in every dimension) and resets them
+void printGemmStatistics();
+
+// c(i*brows+k, j*bcols+l) += scale * op(a)(i, j) * op(b)(k, l) for row
+// major a, b and c (leading dimension ldc); op(x) is x for 'n' and its
+// transpose for 't', and arows x acols, brows x bcols are the sizes of op(a)
+// and op(b)
+void KroneckerProduct(const double *a, int arows, int acols, char conjA,
+                      const double *b, int brows, int bcols, char conjB,
+                      double scale, double *c, long ldc);
+
+// Fused passes over contiguous vectors of length n, e.g. the flat data of
+// wavefunctions with the same layout. v = a x + b y (+ c z), returning v.v;
+// v may be one of the inputs.
+double VectorCombine(long n, double a, const double *x, double b,
+                     const double *y, double *v);
+double VectorCombine(long n, double a, const double *x, double b,
+                     const double *y, double c, const double *z, double *v);
+// dots[k] = x.y[k] for k < m in one pass over x
+void VectorDots(long n, const double *x, int m, const double *const *y,
+                double *dots);
+
 template <class T> void MatrixScale(double d, T &a) {
 #ifdef BLAS
     DSCAL(a.Storage(), d, a.Store(), 1);
@@ -122,101 +163,35 @@ void MatrixTensorProduct(const T1 &a_ref, char conjA, Real scaleA,
     //    abort();
 #else
     try {
-        if (conjA == 'n' && conjB == 'n') {
 #ifdef BLAS
-            int aRows = a.Nrows();
-            int aCols = a.Ncols();
-            int bRows = b.Nrows();
-            int bCols = b.Ncols();
-
-            for (int i = 0; i < aRows; ++i)
-                for (int j = 0; j < aCols; ++j) {
-                    Real scale = scaleA * scaleB * a(i + 1, j + 1);
-                    for (int k = 0; k < bRows; ++k)
-                        DAXPY(bCols, scale, &b(k + 1, 1), 1,
-                              &c(i * bRows + k + 1 + rowstride,
-                                 j * bCols + 1 + colstride),
-                              1);
-                }
-            return;
+        const int ldc = c.Ncols();
+        KroneckerProduct(a.Store(), conjA == 'n' ? arows : acols,
+                         conjA == 'n' ? acols : arows, conjA, b.Store(),
+                         conjB == 'n' ? b.Nrows() : b.Ncols(),
+                         conjB == 'n' ? b.Ncols() : b.Nrows(), conjB,
+                         scaleA * scaleB,
+                         c.Store() + (long)rowstride * ldc + colstride, ldc);
 #else
+        if (conjA == 'n' && conjB == 'n') {
             A = a;
             B = b;
-#endif
         } else if (conjA == 't' && conjB == 'n') {
-#ifdef BLAS
-            int aRows = a.Ncols();
-            int aCols = a.Nrows();
-            int bRows = b.Nrows();
-            int bCols = b.Ncols();
-
-            for (int i = 0; i < aRows; ++i)
-                for (int j = 0; j < aCols; ++j) {
-                    Real scale = scaleA * scaleB * a(j + 1, i + 1);
-                    for (int k = 0; k < bRows; ++k)
-                        DAXPY(bCols, scale, &b(k + 1, 1), 1,
-                              &c(i * bRows + k + 1 + rowstride,
-                                 j * bCols + 1 + colstride),
-                              1);
-                }
-            return;
-#else
             A = a.t();
             B = b;
-#endif
         } else if (conjA == 'n' && conjB == 't') {
-#ifdef BLAS
-            int aRows = a.Nrows();
-            int aCols = a.Ncols();
-            int bRows = b.Ncols();
-            int bCols = b.Nrows();
-
-            for (int i = 0; i < aRows; ++i)
-                for (int j = 0; j < aCols; ++j) {
-                    Real scale = scaleA * scaleB * a(i + 1, j + 1);
-                    for (int k = 0; k < bRows; ++k)
-                        DAXPY(bCols, scale, &b(1, k + 1), bRows,
-                              &c(i * bRows + k + 1 + rowstride,
-                                 j * bCols + 1 + colstride),
-                              1);
-                }
-            return;
-#else
             A = a;
             B = b.t();
-#endif
         } else if (conjA == 't' && conjB == 't') {
-#ifdef BLAS
-            int aRows = a.Ncols();
-            int aCols = a.Nrows();
-            int bRows = b.Ncols();
-            int bCols = b.Nrows();
-
-            for (int i = 0; i < aRows; ++i)
-                for (int j = 0; j < aCols; ++j) {
-                    Real scale = scaleA * scaleB * a(j + 1, i + 1);
-                    for (int k = 0; k < bRows; ++k)
-                        DAXPY(bCols, scaleA * scaleB * a(j + 1, i + 1),
-                              &b(1, k + 1), bRows,
-                              &c(i * bRows + k + 1 + rowstride,
-                                 j * bCols + 1 + colstride),
-                              1);
-                }
-            return;
-#else
             A = a.t();
             B = b.t();
-#endif
         } else
             abort();
-#ifndef BLAS
         for (int i = 1; i <= A.Nrows(); ++i)
             for (int j = 1; j <= A.Ncols(); ++j)
                 c.SubMatrix((i - 1) * B.Nrows() + 1, i * B.Nrows(),
                             (j - 1) * B.Ncols() + 1, j * B.Ncols()) +=
                     (scaleA * scaleB) * A(i, j) * B;
 #endif
-
     } catch (Exception) {
         pout << Exception::what() << endl;
         abort();
@@ -224,6 +199,52 @@ void MatrixTensorProduct(const T1 &a_ref, char conjA, Real scaleA,
 #endif
 }
 
+// c[rowstride:, colstride:] += scale * op(a) x I_n, without forming the
+// identity: every element of op(a) is added along a diagonal of length n
+template <class T1, class T3>
+void MatrixTensorProductIdentityRight(const T1 &a_ref, char conjA, Real scale,
+                                      int n, T3 &c, int rowstride,
+                                      int colstride) {
+    T1 &a = const_cast<T1 &>(a_ref);
+    int ldc = c.Ncols();
+    int ars = conjA == 'n' ? a.Ncols() : 1;
+    int acs = conjA == 'n' ? 1 : a.Ncols();
+    int arows = conjA == 'n' ? a.Nrows() : a.Ncols();
+    int acols = conjA == 'n' ? a.Ncols() : a.Nrows();
+    const double *aptr = a.Store();
+    double *cptr = c.Store() + rowstride * ldc + colstride;
+    for (int i = 0; i < arows; ++i)
+        for (int j = 0; j < acols; ++j) {
+            double s = scale * aptr[i * ars + j * acs];
+            if (s == 0.0)
+                continue;
+            double *cij = cptr + (long)i * n * ldc + j * n;
+            for (int k = 0; k < n; ++k)
+                cij[(long)k * (ldc + 1)] += s;
+        }
+}
+
+// c[rowstride:, colstride:] += scale * I_n x op(a), without forming the
+// identity: op(a) is added into the n diagonal blocks
+template <class T1, class T3>
+void MatrixTensorProductIdentityLeft(int n, const T1 &a_ref, char conjA,
+                                     Real scale, T3 &c, int rowstride,
+                                     int colstride) {
+    T1 &a = const_cast<T1 &>(a_ref);
+    int ldc = c.Ncols();
+    int arows = conjA == 'n' ? a.Nrows() : a.Ncols();
+    int acols = conjA == 'n' ? a.Ncols() : a.Nrows();
+    double *cptr = c.Store() + rowstride * ldc + colstride;
+    for (int k = 0; k < n; ++k) {
+        double *ck = cptr + (long)k * arows * ldc + k * acols;
+        for (int i = 0; i < arows; ++i)
+            if (conjA == 'n')
+                DAXPY(acols, scale, a.Store() + i * acols, 1, ck + i * ldc, 1);
+            else
+                DAXPY(acols, scale, a.Store() + i, arows, ck + i * ldc, 1);
+    }
+}
+
 template <class T1, class T2>
 void MatrixMultiply(double d, const T1 &a, T2 &b) {
     //  b += d * a;
@@ -255,8 +276,8 @@ void MatrixMultiply(const T1 &a, char conjA, const T2 &b, char conjB, T3 &c,
             dmrginp.matmultFlops[omprank] += aCols * cRows * cCols;
             assert((aCols == bRows) && (cRows == aRows) && (cCols == bCols));
 #ifdef BLAS
-            dgemm_(&conjA, &conjB, &bCols, &aRows, &bRows, &scale, b.Store(),
-                   &bCols, a.Store(), &aCols, &cfactor, c.Store(), &bCols);
+            dispatch_dgemm(conjA, conjB, bCols, aRows, bRows, scale, b.Store(),
+                           bCols, a.Store(), aCols, cfactor, c.Store(), bCols);
 #else
             c += (scale * a) * b;
 #endif
@@ -264,8 +285,8 @@ void MatrixMultiply(const T1 &a, char conjA, const T2 &b, char conjB, T3 &c,
             dmrginp.matmultFlops[omprank] += aCols * cRows * cCols;
             assert((aCols == bCols) && (cRows == aRows) && (cCols == bRows));
 #ifdef BLAS
-            dgemm_(&conjB, &conjA, &bRows, &aRows, &bCols, &scale, b.Store(),
-                   &bCols, a.Store(), &aCols, &cfactor, c.Store(), &bRows);
+            dispatch_dgemm(conjB, conjA, bRows, aRows, bCols, scale, b.Store(),
+                           bCols, a.Store(), aCols, cfactor, c.Store(), bRows);
 #else
             c += (scale * a) * b.t();
 #endif
@@ -273,8 +294,8 @@ void MatrixMultiply(const T1 &a, char conjA, const T2 &b, char conjB, T3 &c,
             dmrginp.matmultFlops[omprank] += aRows * cRows * cCols;
             assert((aRows == bRows) && (cRows == aCols) && (cCols == bCols));
 #ifdef BLAS
-            dgemm_(&conjB, &conjA, &bCols, &aCols, &bRows, &scale, b.Store(),
-                   &bCols, a.Store(), &aCols, &cfactor, c.Store(), &bCols);
+            dispatch_dgemm(conjB, conjA, bCols, aCols, bRows, scale, b.Store(),
+                           bCols, a.Store(), aCols, cfactor, c.Store(), bCols);
 #else
             c += (scale * a.t()) * b;
 #endif
@@ -282,8 +303,8 @@ void MatrixMultiply(const T1 &a, char conjA, const T2 &b, char conjB, T3 &c,
             dmrginp.matmultFlops[omprank] += aRows * cRows * cCols;
             assert((aRows == bCols) && (cRows == aCols) && (cCols == bRows));
 #ifdef BLAS
-            dgemm_(&conjB, &conjA, &bRows, &aCols, &bCols, &scale, b.Store(),
-                   &bCols, a.Store(), &aCols, &cfactor, c.Store(), &bRows);
+            dispatch_dgemm(conjB, conjA, bRows, aCols, bCols, scale, b.Store(),
+                           bCols, a.Store(), aCols, cfactor, c.Store(), bRows);
 #else
             c += (scale * a.t()) * b.t();
 #endif
@@ -367,6 +388,8 @@ Matrix& c, Matrix& d)
 }
 */
 
+// thin svd M = U e V^T of a matrix with at least as many rows as columns,
+// U has the shape of M and V is square
 void svd(Matrix &M, DiagonalMatrix &e, Matrix &U, Matrix &V);
 void svd(StackMatrix &M, DiagonalMatrix &e, Matrix &U, Matrix &V);
 void xsolve_AxeqB(const Matrix &a, const ColumnVector &b, ColumnVector &x);
@@ -375,7 +398,15 @@ void xsolve_AxeqB(const Matrix &a, const ColumnVector &b, ColumnVector &x);
 double dotproduct(const ColumnVector &a, const ColumnVector &b);
 double dotproduct(const RowVector &a, const RowVector &b);
 double rowdoubleproduct(Matrix &a, int rowa, Matrix &b, int rowb);
+// eigenvalues in ascending order and vec(j, i) the j-th component of the i-th
+// eigenvector; all eigensolvers and the svd go to LAPACK on contiguous
+// storage, never to the newmat routines
 void diagonalise(Matrix &sym, DiagonalMatrix &d, Matrix &vec);
+// symmetric matrices from this size on are diagonalised with the divide and
+// conquer dsyevd instead of dsyevr
+const int DSYEVD_MIN_SIZE = 128;
+// names of the LAPACK routines behind diagonalise and svd, for the output
+const char *EigensolverBackend();
 void diagonalise(StackMatrix &sym, DiagonalMatrix &d);
 void diagonalise_tridiagonal(std::vector<double> &diagonal,
                              std::vector<double> &offdiagonal, int numelements,
@@ -0,0 +1,46 @@
+/*
+Developed by Sandeep Sharma and Garnet K.-L. Chan, 2012
+Copyright (c) 2012, Garnet K.-L. Chan
+
+This program is integrated in Molpro with the permission of
+Sandeep Sharma and Garnet K.-L. Chan
+*/
+
+#ifndef SPIN_MATRIX_BATCH_HEADER
+#define SPIN_MATRIX_BATCH_HEADER
+#include "StackMatrix.h"
+#include "blas_calls.h"
+#include <map>
+#include <vector>
+
+namespace SpinAdapted {
+
+// Collects many small row-major products c = scale * op(a) * op(b) +
+// cfactor * c (same convention as MatrixMultiply) and executes them together.
+// With MKL the products are sent to dgemm_batch, otherwise they are issued
+// one by one in the order they were added. A batch that is large enough for
+// gpu_gemm_size is enqueued on the gpu as a whole (see gpublas.h).
+// Products writing to the same c are put into different waves, so that no
+// single batched call updates one block twice.
+class MatrixBatch {
+  private:
+    std::vector<char> transa, transb;
+    std::vector<FORTINT> m, n, k, lda, ldb, ldc;
+    std::vector<double> alpha, beta;
+    std::vector<double *> aptr, bptr, cptr;
+    std::vector<int> wave;
+    std::map<double *, int> nwrites;
+    int nwaves;
+    bool onDevice() const;
+
+  public:
+    MatrixBatch() : nwaves(0) {}
+    void add(const StackMatrix &a, char conjA, const StackMatrix &b,
+             char conjB, StackMatrix &c, double scale, double cfactor = 1.);
+    void perform();
+    void clear();
+    int size() const { return cptr.size(); }
+};
+
+} // namespace SpinAdapted
+#endif
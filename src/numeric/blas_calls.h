@@ -109,6 +109,10 @@ extern "C"
   void sscal(int *size, float *coeff, float *matrix,int *inc);
   void dstev(char* JOBZ,FORTINT* N,double* A,double* E, double* W, FORTINT* Wlen, double*WORK, FORTINT* INFO);
   void dsyev(char* JOBZ,char* UPLO,int* N,double* A,int* LDA,double* W,double*WORK,int*LWORK,int* INFO);
+  void dsyevd(char* JOBZ,char* UPLO,int* N,double* A,int* LDA,double* W,double*WORK,int*LWORK,int* IWORK,int* LIWORK,int* INFO);
+  void dsyevr(char* JOBZ,char* RANGE,char* UPLO,int* N,double* A,int* LDA,double* VL,double* VU,int* IL,int* IU,double* ABSTOL,int* M,double* W,double* Z,int* LDZ,int* ISUPPZ,double* WORK,int* LWORK,int* IWORK,int* LIWORK,int* INFO);
+  void dgesdd(char* JOBZ,int* M,int* N,double* A,int* LDA,double* S,double* U,int* LDU,double* VT,int* LDVT,double* WORK,int* LWORK,int* IWORK,int* INFO);
+  void dsyrk(char* UPLO,char* TRANS,int* N,int* K,double* ALPHA,double* A,int* LDA,double* BETA,double* C,int* LDC);
   void dgesv(int *n, int *nrhs, double *a, int *lda, int *ipiv, double *b, int *ldb, int *info);
 }
 #else //SGI, Linux
@@ -137,6 +141,10 @@ extern "C"
   void sscal_(FORTINT *size, float *coeff, float *matrix,FORTINT *inc);
   void dstev_(char* JOBZ,FORTINT* N,double* A,double* E, double* W, FORTINT* Wlen, double*WORK, FORTINT* INFO);
   void dsyev_(char* JOBZ,char* UPLO,FORTINT* N,double* A,FORTINT* LDA,double* W,double*WORK,FORTINT*LWORK,FORTINT* INFO);
+  void dsyevd_(char* JOBZ,char* UPLO,FORTINT* N,double* A,FORTINT* LDA,double* W,double*WORK,FORTINT*LWORK,FORTINT* IWORK,FORTINT* LIWORK,FORTINT* INFO);
+  void dsyevr_(char* JOBZ,char* RANGE,char* UPLO,FORTINT* N,double* A,FORTINT* LDA,double* VL,double* VU,FORTINT* IL,FORTINT* IU,double* ABSTOL,FORTINT* M,double* W,double* Z,FORTINT* LDZ,FORTINT* ISUPPZ,double* WORK,FORTINT* LWORK,FORTINT* IWORK,FORTINT* LIWORK,FORTINT* INFO);
+  void dgesdd_(char* JOBZ,FORTINT* M,FORTINT* N,double* A,FORTINT* LDA,double* S,double* U,FORTINT* LDU,double* VT,FORTINT* LDVT,double* WORK,FORTINT* LWORK,FORTINT* IWORK,FORTINT* INFO);
+  void dsyrk_(char* UPLO,char* TRANS,FORTINT* N,FORTINT* K,double* ALPHA,double* A,FORTINT* LDA,double* BETA,double* C,FORTINT* LDC);
   void dgesv_(FORTINT *n, FORTINT *nrhs, double *a, FORTINT *lda, FORTINT *ipiv, double *b, FORTINT *ldb, FORTINT *info);
   int idamax_(FORTINT &n, double* d, FORTINT &indx);
   //int idamax_(int &n, double* d, int &indx);
@@ -304,6 +312,16 @@ inline void DGEMV(char trans, FORTINT m, FORTINT n, double alpha,
 #endif
 }
 
+// C <- alpha op(A) op(A)^T + beta C, only the UPLO triangle of C is written
+inline void DSYRK(char UPLO, char TRANS, FORTINT N, FORTINT K, double ALPHA, double* A, FORTINT LDA, double BETA, double* C, FORTINT LDC)
+{
+#ifdef AIX
+  dsyrk(&UPLO,&TRANS,&N,&K,&ALPHA,A,&LDA,&BETA,C,&LDC);
+#else
+  dsyrk_(&UPLO,&TRANS,&N,&K,&ALPHA,A,&LDA,&BETA,C,&LDC);
+#endif
+}
+
 inline void DSYEV(char JOBZ, char UPLO, FORTINT N, double* A, FORTINT LDA, double* W, double* WORK, FORTINT LWORK, FORTINT INFO )
 {
 #ifdef AIX
@@ -313,6 +331,31 @@ inline void DSYEV(char JOBZ, char UPLO, FORTINT N, double* A, FORTINT LDA, doubl
 #endif
 }
 
+// divide and conquer, much faster than dsyev for large matrices when the
+// eigenvectors are wanted
+inline void DSYEVD(char JOBZ, char UPLO, FORTINT N, double* A, FORTINT LDA, double* W, double* WORK, FORTINT LWORK, FORTINT* IWORK, FORTINT LIWORK, FORTINT& INFO )
+{
+#ifdef AIX
+  dsyevd(&JOBZ,&UPLO,&N,A,&LDA,W,WORK,&LWORK,IWORK,&LIWORK,&INFO);
+#else
+  dsyevd_(&JOBZ,&UPLO,&N,A,&LDA,W,WORK,&LWORK,IWORK,&LIWORK,&INFO);
+#endif
+}
+
+// all eigenpairs by relatively robust representations, the eigenvectors go
+// to Z and A is destroyed
+inline void DSYEVR(char JOBZ, char UPLO, FORTINT N, double* A, FORTINT LDA, FORTINT& M, double* W, double* Z, FORTINT LDZ, FORTINT* ISUPPZ, double* WORK, FORTINT LWORK, FORTINT* IWORK, FORTINT LIWORK, FORTINT& INFO )
+{
+  char RANGE = 'A';
+  double VL = 0., VU = 0., ABSTOL = 0.;
+  FORTINT IL = 0, IU = 0;
+#ifdef AIX
+  dsyevr(&JOBZ,&RANGE,&UPLO,&N,A,&LDA,&VL,&VU,&IL,&IU,&ABSTOL,&M,W,Z,&LDZ,ISUPPZ,WORK,&LWORK,IWORK,&LIWORK,&INFO);
+#else
+  dsyevr_(&JOBZ,&RANGE,&UPLO,&N,A,&LDA,&VL,&VU,&IL,&IU,&ABSTOL,&M,W,Z,&LDZ,ISUPPZ,WORK,&LWORK,IWORK,&LIWORK,&INFO);
+#endif
+}
+
 inline void DSTEV(char JOBZ, FORTINT N, double* D, double* E, double* vec, FORTINT LDA, double* W, FORTINT INFO )
 {
 #ifdef AIX
@@ -356,6 +399,19 @@ inline void DGESVD(char JOBU, char JOBVT, FORTINT M, FORTINT N, double* A,
 	  &INFO);
 #endif
 }
+// divide and conquer singular value decomposition
+inline void DGESDD(char JOBZ, FORTINT M, FORTINT N, double* A, FORTINT LDA,
+		   double* S, double* U, FORTINT LDU, double* VT, FORTINT LDVT,
+		   double* WORK, FORTINT LWORK, FORTINT* IWORK, FORTINT& INFO)
+{
+#ifdef AIX
+  dgesdd(&JOBZ, &M, &N, A, &LDA, S, U, &LDU, VT, &LDVT, WORK, &LWORK, IWORK,
+	 &INFO);
+#else
+  dgesdd_(&JOBZ, &M, &N, A, &LDA, S, U, &LDU, VT, &LDVT, WORK, &LWORK, IWORK,
+	  &INFO);
+#endif
+}
 /*
 ** 
 ** void DSCAL(int ntot, double coeff, double *data, int inc);
@@ -8,6 +8,7 @@ Sandeep Sharma and Garnet K.-L. Chan
 
 #ifndef SPIN_DAVIDSON_HEADER
 #define SPIN_DAVIDSON_HEADER
+#include <vector>
 
 namespace SpinAdapted{
   class StackWavefunction;
@@ -16,6 +17,11 @@ namespace SpinAdapted{
 struct Davidson_functor
 {
   virtual void operator()(StackWavefunction& c, StackWavefunction& v) = 0;
+  // v[k] = H c[k] for a batch of vectors, one at a time unless the functor has a batched multiply
+  virtual void operator()(std::vector<StackWavefunction*>& c, std::vector<StackWavefunction*>& v)
+  {
+    for (int k=0; k<c.size(); k++) (*this)(*c[k], *v[k]);
+  }
   virtual const StackSpinBlock& get_block() = 0;
   virtual ~Davidson_functor() {};
 };
@@ -25,8 +31,11 @@ class multiply_h : public Davidson_functor
  private:
   const StackSpinBlock& block;
  public:
+  // the blocks of the operators built on the fly are cached while it lives
   multiply_h(const StackSpinBlock& b, const bool &onedot_);
+  ~multiply_h();
   void operator()(StackWavefunction& c, StackWavefunction& v);
+  void operator()(std::vector<StackWavefunction*>& c, std::vector<StackWavefunction*>& v);
   const StackSpinBlock& get_block() {return block;}
 };
 
@@ -36,6 +45,7 @@ class multiply_h_2Index : public Davidson_functor
   const StackSpinBlock& block;
  public:
   multiply_h_2Index(const StackSpinBlock& b, const bool &onedot_);
+  ~multiply_h_2Index();
   void operator()(StackWavefunction& c, StackWavefunction& v);
   const StackSpinBlock& get_block() {return block;}
 };
@@ -0,0 +1,92 @@
+/*
+Developed by Sandeep Sharma and Garnet K.-L. Chan, 2012
+Copyright (c) 2012, Garnet K.-L. Chan
+
+This program is integrated in Molpro with the permission of
+Sandeep Sharma and Garnet K.-L. Chan
+*/
+
+#ifndef SPIN_GPU_BLAS_HEADER
+#define SPIN_GPU_BLAS_HEADER
+
+// Optional gpu backend for the dense block products (built with -DCUDA=ON).
+// The stack memory is allocated as CUDA managed memory, so the operators and
+// wavefunctions on the stack can be read by the device without copies, and
+// products of at least gpu_gemm_size multiply-adds are done by cuBLAS on a
+// stream that belongs to the calling thread. Products on memory the device
+// cannot read (heap matrices, mapped disk files) stay on the cpu.
+
+namespace SpinAdapted {
+
+#ifdef _HAS_CUDA
+
+// picks the device of this rank, returns false if there is none that can
+// share managed memory with the host threads
+bool InitDevice();
+void FreeDevice();
+
+// managed memory for the stack, 0 if the device is not used
+double *deviceAllocateStack(long n);
+// returns false if p was not allocated by deviceAllocateStack
+bool deviceFreeStack(double *p);
+
+// column-major c = alpha op(a) op(b) + beta c on the stream of this thread,
+// waiting for the result. Returns false without doing anything if the
+// product is too small or the device can not read a, b or c.
+bool device_dgemm(char transa, char transb, int m, int n, int k, double alpha,
+                  const double *a, int lda, const double *b, int ldb,
+                  double beta, double *c, int ldc);
+// the same without the checks and without waiting, see deviceSynchronize
+void device_dgemm_async(char transa, char transb, int m, int n, int k,
+                        double alpha, const double *a, int lda,
+                        const double *b, int ldb, double beta, double *c,
+                        int ldc);
+// true if a product of this size would be sent to the device
+bool deviceOffload(double flops);
+// true if the device can read the memory at p
+bool deviceAccessible(const void *p);
+// waits for the products enqueued by this thread
+void deviceSynchronize();
+// true after a successful InitDevice
+bool deviceEnabled();
+
+// vector operations on the stream of this thread for the gpu Davidson; all
+// vectors have to be device accessible. device_ddot waits for its result,
+// the others only enqueue.
+double device_ddot(long n, const double *x, const double *y);
+void device_daxpy(long n, double a, const double *x, double *y);
+void device_dscal(long n, double a, double *x);
+void device_dcopy(long n, const double *x, double *y);
+void device_dgemv(char trans, int m, int n, double alpha, const double *a,
+                  int lda, const double *x, double beta, double *y);
+// r_i /= (e - d_i + levelshift) where |e - d_i| > 1e-12, the diagonal
+// preconditioner of Linear::precondition
+void device_precondition(long n, double *r, const double *d, double e,
+                         double levelshift);
+
+#else
+
+inline bool InitDevice() { return false; }
+inline void FreeDevice() {}
+inline double *deviceAllocateStack(long n) { return 0; }
+inline bool deviceFreeStack(double *p) { return false; }
+inline bool device_dgemm(char transa, char transb, int m, int n, int k,
+                         double alpha, const double *a, int lda,
+                         const double *b, int ldb, double beta, double *c,
+                         int ldc) {
+    return false;
+}
+inline void device_dgemm_async(char transa, char transb, int m, int n, int k,
+                               double alpha, const double *a, int lda,
+                               const double *b, int ldb, double beta,
+                               double *c, int ldc) {}
+inline bool deviceOffload(double flops) { return false; }
+inline bool deviceAccessible(const void *p) { return false; }
+inline void deviceSynchronize() {}
+inline bool deviceEnabled() { return false; }
+
+#endif
+
+} // namespace SpinAdapted
+
+#endif
@@ -0,0 +1,31 @@
+/*
+Developed by Sandeep Sharma and Garnet K.-L. Chan, 2012
+Copyright (c) 2012, Garnet K.-L. Chan
+
+This program is integrated in Molpro with the permission of
+Sandeep Sharma and Garnet K.-L. Chan
+*/
+
+// the few element-wise operations of the gpu Davidson that cuBLAS does not
+// have, see gpublas.h
+#include <cuda_runtime.h>
+#include <math.h>
+
+namespace SpinAdapted {
+
+__global__ void preconditionKernel(long n, double *r, const double *d,
+                                   double e, double levelshift) {
+    for (long i = blockIdx.x * (long)blockDim.x + threadIdx.x; i < n;
+         i += (long)gridDim.x * blockDim.x)
+        if (fabs(e - d[i]) > 1.e-12)
+            r[i] /= (e - d[i] + levelshift);
+}
+
+void launchPrecondition(long n, double *r, const double *d, double e,
+                        double levelshift, cudaStream_t stream) {
+    const int threads = 256;
+    const long blocks = n / threads + 1 < 65535 ? n / threads + 1 : 65535;
+    preconditionKernel<<<blocks, threads, 0, stream>>>(n, r, d, e, levelshift);
+}
+
+} // namespace SpinAdapted
@@ -20,8 +20,14 @@ namespace SpinAdapted{
   {
     void precondition(StackWavefunction& op, double e, DiagonalMatrix& diagonal, double levelshift=0.0);
     void olsenPrecondition(StackWavefunction& op, StackWavefunction& C0, double e, DiagonalMatrix& diagonal, double levelshift=0.0);
-    void block_davidson(std::vector<StackWavefunction>& b, DiagonalMatrix& e, double normtol, const bool &warmUp, Davidson_functor& h_mult, bool& useprecond, int currentRoot, std::vector<StackWavefunction>& lowerStates);
+    // with hpsi the H b of the converged roots are copied into it on the root.
+    // The allocated b after the roots are added to the initial subspace, and
+    // with ritz up to davidson_warm_vectors of the subspace vectors after the
+    // roots are copied into it, for the next site
+    void block_davidson(std::vector<StackWavefunction>& b, DiagonalMatrix& e, double normtol, const bool &warmUp, Davidson_functor& h_mult, bool& useprecond, int currentRoot, std::vector<StackWavefunction>& lowerStates, std::vector<double>* hpsi = 0, std::vector<double>* ritz = 0);
+    void lanczos(std::vector<StackWavefunction>& b, DiagonalMatrix& e, double normtol, Davidson_functor& h_mult, std::vector<StackWavefunction>& lowerStates);
     double MinResMethod(StackWavefunction& xi, double normtol, Davidson_functor& h_multiply, std::vector<StackWavefunction> &lowerStates);
+    void MinResMethod(std::vector<StackWavefunction*>& xi, std::vector<StackWavefunction*>& targets, double normtol, Davidson_functor& h_multiply, std::vector<StackWavefunction> &lowerStates, std::vector<double>& functionals, const std::vector<double>* shifts = 0);
     double ConjugateGradient(StackWavefunction& xi, double normtol, Davidson_functor& h_multiply, std::vector<StackWavefunction> &lowerStates);
   };
 }
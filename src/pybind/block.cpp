@@ -21,6 +21,9 @@ PYBIND11_MAKE_OPAQUE(vector<SpinQuantum>);
 PYBIND11_MAKE_OPAQUE(map<opTypes, boost::shared_ptr<StackOp_component_base>>);
 PYBIND11_MAKE_OPAQUE(vector<StackSpinBlock>);
 
+// store, restore, the operator transformations and the block builders
+// release the GIL. Like the sweep drivers they are not thread safe: they
+// allocate on the stack memory and read dmrginp.
 void pybind_block(py::module &m) {
 
     py::enum_<guessWaveTypes>(m, "GuessWaveTypes", py::arithmetic(),
@@ -90,7 +93,7 @@ void pybind_block(py::module &m) {
              "    right : int\n"
              "        Ket state (-1 for normal case).",
              py::arg("forward"), py::arg("sites"), py::arg("left"),
-             py::arg("right"))
+             py::arg("right"), py::call_guard<py::gil_scoped_release>())
         .def("restore",
              [](StackSpinBlock *self, bool forward, const vector<int> &sites,
                 int left, int right) {
@@ -107,19 +110,21 @@ void pybind_block(py::module &m) {
              "    right : int\n"
              "        Ket state (-1 for normal case).",
              py::arg("forward"), py::arg("sites"), py::arg("left"),
-             py::arg("right"))
+             py::arg("right"), py::call_guard<py::gil_scoped_release>())
         .def("deallocate", &StackSpinBlock::deallocate)
         .def("clear", &StackSpinBlock::clear)
         .def("transform_operators",
              (void (StackSpinBlock::*)(vector<Matrix> &)) &
-                 StackSpinBlock::transform_operators)
+                 StackSpinBlock::transform_operators,
+             py::call_guard<py::gil_scoped_release>())
         .def("transform_operators_2",
              (void (StackSpinBlock::*)(vector<Matrix> &, vector<Matrix> &, bool,
                                        bool)) &
                  StackSpinBlock::transform_operators,
              py::arg("left_rotate_matrix"), py::arg("right_rotate_matrix"),
              py::arg("clear_right_block") = true,
-             py::arg("clear_left_block") = true)
+             py::arg("clear_left_block") = true,
+             py::call_guard<py::gil_scoped_release>())
         .def("move_and_free_memory",
              [](StackSpinBlock *self, StackSpinBlock *system) {
                  long memoryToFree = self->getdata() - system->getdata();
@@ -136,8 +141,10 @@ void pybind_block(py::module &m) {
         .def("remove_additional_ops", &StackSpinBlock::removeAdditionalOps)
         .def("add_all_comp_ops", &StackSpinBlock::addAllCompOps)
         .def("multiply_overlap", &StackSpinBlock::multiplyOverlap, py::arg("c"),
-             py::arg("v"), py::arg("num_threads") = 1)
-        .def("diagonal_h", &StackSpinBlock::diagonalH)
+             py::arg("v"), py::arg("num_threads") = 1,
+             py::call_guard<py::gil_scoped_release>())
+        .def("diagonal_h", &StackSpinBlock::diagonalH,
+             py::call_guard<py::gil_scoped_release>())
         .def("renormalize_from",
              [](StackSpinBlock *self, vector<double> &energies,
                 vector<double> &spins, double error,
@@ -162,7 +169,8 @@ void pybind_block(py::module &m) {
              py::arg("additional_noise"), py::arg("one_dot"), py::arg("system"),
              py::arg("system_dot"), py::arg("environment"),
              py::arg("dot_with_sys"), py::arg("warm_up"), py::arg("sweep_iter"),
-             py::arg("current_root"), py::arg("lower_states"))
+             py::arg("current_root"), py::arg("lower_states"),
+             py::call_guard<py::gil_scoped_release>())
         .def("__repr__", [](StackSpinBlock *self) {
             stringstream ss;
             ss.precision(12);
@@ -179,13 +187,15 @@ void pybind_block(py::module &m) {
           py::arg("restart_size"), py::arg("restart"), py::arg("warm_up"),
           py::arg("integral_index"),
           py::arg("bra_quanta") = vector<SpinQuantum>(),
-          py::arg("ket_quanta") = vector<SpinQuantum>());
+          py::arg("ket_quanta") = vector<SpinQuantum>(),
+          py::call_guard<py::gil_scoped_release>());
 
     m.def("init_big_block", &InitBlocks::InitBigBlock,
           "Initialize big (super) block.", py::arg("left_block"),
           py::arg("right_block"), py::arg("big_block"),
           py::arg("bra_quanta") = vector<SpinQuantum>(),
-          py::arg("ket_quanta") = vector<SpinQuantum>());
+          py::arg("ket_quanta") = vector<SpinQuantum>(),
+          py::call_guard<py::gil_scoped_release>());
 
     m.def("init_new_system_block",
           [](StackSpinBlock &system, StackSpinBlock &system_dot,
@@ -201,7 +211,8 @@ void pybind_block(py::module &m) {
           py::arg("system_dot"), py::arg("new_system"), py::arg("left_state"),
           py::arg("right_state"), py::arg("sys_add"), py::arg("direct"),
           py::arg("integral_index"), py::arg("storage"),
-          py::arg("have_norm_ops"), py::arg("have_comp_ops"));
+          py::arg("have_norm_ops"), py::arg("have_comp_ops"),
+          py::call_guard<py::gil_scoped_release>());
 
     m.def("init_new_environment_block",
           [](StackSpinBlock &environment, StackSpinBlock &environment_dot,
@@ -224,5 +235,5 @@ void pybind_block(py::module &m) {
           py::arg("forward"), py::arg("direct"), py::arg("one_dot"),
           py::arg("use_slater"), py::arg("integral_index"),
           py::arg("have_norm_ops"), py::arg("have_comp_ops"),
-          py::arg("dot_with_sys"));
+          py::arg("dot_with_sys"), py::call_guard<py::gil_scoped_release>());
 }
@@ -9,16 +9,41 @@ void pybind_data_page(py::module &m) {
     
     m.def("init_data_pages", &block2::init_data_pages, py::arg("n_pages"));
     
-    m.def("release_data_pages", &block2::release_data_pages);
+    m.def("print_data_page_usage", &block2::print_data_page_usage,
+          "Print the largest use of each data page so far.");
     
-    m.def("activate_data_page", &block2::activate_data_page, py::arg("ip"));
+    m.def("release_data_pages", &block2::release_data_pages,
+          py::call_guard<py::gil_scoped_release>());
+    
+    m.def("activate_data_page", &block2::activate_data_page, py::arg("ip"),
+          py::call_guard<py::gil_scoped_release>());
     
     m.def("get_data_page_pointer", &block2::get_data_page_pointer, py::arg("ip"));
     
-    m.def("set_data_page_pointer", &block2::set_data_page_pointer, py::arg("ip"), py::arg("offset"));
+    m.def("set_data_page_pointer", &block2::set_data_page_pointer, py::arg("ip"), py::arg("offset"),
+          py::call_guard<py::gil_scoped_release>());
+    
+    // save and load release the GIL; they can overlap with kernels that do not
+    // write page ip
+    m.def("save_data_page", &block2::save_data_page, py::arg("ip"), py::arg("filename"),
+          py::call_guard<py::gil_scoped_release>());
+    
+    m.def("load_data_page", &block2::load_data_page, py::arg("ip"), py::arg("filename"),
+          py::call_guard<py::gil_scoped_release>());
+    
+    m.def("save_data_page_async", &block2::save_data_page_async, py::arg("ip"), py::arg("filename"),
+          "Queue the save of page ip on the I/O thread.");
+    
+    m.def("load_data_page_async", &block2::load_data_page_async, py::arg("ip"), py::arg("filename"),
+          "Queue the load of page ip on the I/O thread.");
+    
+    m.def("wait_data_page", &block2::wait_data_page, py::arg("ip") = -1,
+          "Wait for the queued saves and loads of page ip (all pages for -1).",
+          py::call_guard<py::gil_scoped_release>());
     
-    m.def("save_data_page", &block2::save_data_page, py::arg("ip"), py::arg("filename"));
+    m.def("data_page_ready", &block2::data_page_ready, py::arg("ip"));
     
-    m.def("load_data_page", &block2::load_data_page, py::arg("ip"), py::arg("filename"));
+    m.def("set_data_page_cache", &block2::set_data_page_cache, py::arg("n"),
+          "Keep up to n doubles of recently used page files in memory.");
 
 }
@@ -2,25 +2,124 @@
 #include "Stackspinblock.h"
 #include "enumerator.h"
 #include "fciqmchelper.h"
+#include "global.h"
+#include "scratch.h"
+#include "stackmemory.h"
 #include "sweep.h"
 #include "sweep_params.h"
 #include "stackguess_wavefunction.h"
 #include "wrapper.h"
+#include <boost/format.hpp>
 #include <pybind11/pybind11.h>
+#include <stdexcept>
+#include <stdio.h>
 #include <string>
 #include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace py = pybind11;
 using namespace std;
 using namespace SpinAdapted;
 
 PYBIND11_MAKE_OPAQUE(vector<bool>);
+PYBIND11_MAKE_OPAQUE(vector<double>);
 PYBIND11_MAKE_OPAQUE(vector<::Matrix>);
 PYBIND11_MAKE_OPAQUE(vector<StackSpinBlock>);
 
 void dmrg(double sweep_tol);
 int calldmrg(char *, char *);
+void ReadInput(char *conf);
 
+// DMRG calculations run one after the other in one process, as in the scans
+// over geometries, without the start up of calldmrg for each. The stack
+// memory is allocated once, and again only for a larger memory; the
+// coupling coefficient tables are kept; and the single site blocks are kept
+// for a run that says its integrals are those of the last run. A run reads
+// its input, with the integrals and the schedule, does the sweeps of a DMRG
+// calculation and returns the energies of the roots.
+class DMRGSession {
+    double *memory;
+    long size;
+    bool sites;
+
+  public:
+    DMRGSession() : memory(0), size(0), sites(false) {}
+    ~DMRGSession() { close(); }
+
+    vector<double> run(const string &conf, bool same_integrals) {
+#ifndef SERIAL
+        throw runtime_error("DMRGSession needs a serial build, use calldmrg");
+#endif
+        ReadInput((char *)conf.c_str());
+        if (dmrginp.calc_type() != DMRG || dmrginp.plan())
+            throw runtime_error("DMRGSession only runs DMRG calculations");
+        dmrginp.matmultFlops.assign(numthrds, 0.);
+        MAX_THRD = numthrds;
+#ifdef _OPENMP
+        omp_set_num_threads(MAX_THRD);
+#endif
+        if (memory == 0 || (long)dmrginp.getMemory() > size) {
+            if (memory != 0)
+                FreeStackMemory(memory);
+            size = dmrginp.getMemory();
+            memory = AllocateStackMemory(size);
+        }
+        Stackmem.resize(numthrds);
+        for (int i = 0; i < numthrds; i++) {
+            Stackmem[i].clear();
+            Stackmem[i].strict = !dmrginp.relaxed_stack();
+        }
+        Stackmem[0].data = memory;
+        Stackmem[0].size = size;
+        block2::current_page = &Stackmem[0];
+        dmrginp.initCumulTimer();
+
+        // the single site blocks hold the one and two site integrals
+        dmrginp.cache_dot_blocks() = true;
+        if (!same_integrals || !sites) {
+            freeSingleSiteBlocks();
+            singleSiteBlocks.resize(dmrginp.getNumIntegrals());
+            for (int i = 0; i < singleSiteBlocks.size(); i++)
+                initialiseSingleSiteBlocks(singleSiteBlocks[i], i);
+            sites = true;
+        }
+
+        dmrg(dmrginp.get_sweep_tol());
+        StackSpinBlock::flush_block_cache();
+        FinishScratch();
+
+        vector<double> energies(dmrginp.nroots(), 0.);
+        string efile =
+            str(boost::format("%s%s") % dmrginp.load_prefix() % "/dmrg.e");
+        FILE *f = fopen(efile.c_str(), "rb");
+        if (f == 0 || fread(&energies[0], sizeof(double), energies.size(),
+                            f) != energies.size()) {
+            if (f != 0)
+                fclose(f);
+            throw runtime_error("cannot read the energies from " + efile);
+        }
+        fclose(f);
+        return energies;
+    }
+
+    // frees the single site blocks and the stack memory
+    void close() {
+        if (sites)
+            freeSingleSiteBlocks();
+        sites = false;
+        if (memory != 0)
+            FreeStackMemory(memory);
+        memory = 0;
+        size = 0;
+    }
+};
+
+// The sweep drivers release the GIL, so other Python threads keep running
+// while they work. They use the stack memory, dmrginp and the files of the
+// calculation, so they are not thread safe: only one sweep driver or block
+// function may run at a time.
 void pybind_dmrg(py::module &m) {
 
     py::class_<SweepParams>(m, "SweepParams")
@@ -116,12 +215,14 @@ void pybind_dmrg(py::module &m) {
              "Save the sweep direction and "
              "number of sites in system block into the disk file "
              "'statefile.*.tmp'.",
-             py::arg("forward"), py::arg("size"));
+             py::arg("forward"), py::arg("size"),
+             py::call_guard<py::gil_scoped_release>());
 
     m.def("block_and_decimate", &Sweep::BlockAndDecimate,
           "Block and decimate to generate the new system block.",
           py::arg("sweep_params"), py::arg("system"), py::arg("new_system"),
-          py::arg("use_slater"), py::arg("dot_with_sys"));
+          py::arg("use_slater"), py::arg("dot_with_sys"),
+          py::call_guard<py::gil_scoped_release>());
 
     m.def("get_dot_with_sys",
           [](const StackSpinBlock &system, bool one_dot, bool forward) {
@@ -138,13 +239,29 @@ void pybind_dmrg(py::module &m) {
 
     m.def("do_one", &Sweep::do_one, "Perform one sweep procedure.",
           py::arg("sweep_params"), py::arg("warm_up"), py::arg("forward"),
-          py::arg("restart"), py::arg("restart_size"));
+          py::arg("restart"), py::arg("restart_size"),
+          py::call_guard<py::gil_scoped_release>());
 
-    m.def("dmrg", &dmrg, "Perform DMRG calculation.", py::arg("sweep_tol"));
+    m.def("dmrg", &dmrg, "Perform DMRG calculation.", py::arg("sweep_tol"),
+          py::call_guard<py::gil_scoped_release>());
 
     m.def("calldmrg",
           [](const string &conf) { calldmrg((char *)conf.c_str(), 0); },
-          "Global driver.", py::arg("input_file_name"));
+          "Global driver.", py::arg("input_file_name"),
+          py::call_guard<py::gil_scoped_release>());
+
+    py::class_<DMRGSession>(m, "Session",
+                            "DMRG calculations in one process that keep the "
+                            "stack memory and the single site blocks.")
+        .def(py::init<>())
+        .def("run", &DMRGSession::run,
+             "Read the input file and perform a DMRG calculation. Returns the "
+             "energies of the roots. With `same_integrals`, the single site "
+             "blocks of the last run are used again.",
+             py::arg("input_file_name"), py::arg("same_integrals") = false,
+             py::call_guard<py::gil_scoped_release>())
+        .def("close", &DMRGSession::close,
+             "Free the single site blocks and the stack memory.");
 
     m.def("make_system_environment_big_overlap_blocks",
           &Sweep::makeSystemEnvironmentBigOverlapBlocks,
@@ -153,7 +270,8 @@ void pybind_dmrg(py::module &m) {
           py::arg("environment"), py::arg("new_environment"), py::arg("big"),
           py::arg("sweep_params"), py::arg("dot_with_sys"),
           py::arg("use_slater"), py::arg("integral_index"),
-          py::arg("bra_state"), py::arg("ket_state"));
+          py::arg("bra_state"), py::arg("ket_state"),
+          py::call_guard<py::gil_scoped_release>());
 
     // second overloading
     m.def("guess_wavefunction",
@@ -162,7 +280,8 @@ void pybind_dmrg(py::module &m) {
                   const bool &, double)) & GuessWave::guess_wavefunctions,
           py::arg("solution"), py::arg("e"), py::arg("big"),
           py::arg("guess_wave_type"), py::arg("one_dot"), py::arg("state"),
-          py::arg("transpose_guess_wave"), py::arg("additional_noise") = 0.0);
+          py::arg("transpose_guess_wave"), py::arg("additional_noise") = 0.0,
+          py::call_guard<py::gil_scoped_release>());
 
     py::class_<MPS>(m, "MPS")
         .def(py::init<>())
@@ -174,8 +293,10 @@ void pybind_dmrg(py::module &m) {
         .def_readwrite_static("n_sweep_iters", &MPS::sweepIters,
                               "The number of ``site_tensors``.")
         .def("write_to_disk", &MPS::writeToDiskForDMRG, py::arg("state_index"),
-             py::arg("write_state_average") = false);
+             py::arg("write_state_average") = false,
+             py::call_guard<py::gil_scoped_release>());
 
     m.def("MPS_init", &readMPSFromDiskAndInitializeStaticVariables,
-          "Initialize the single site blocks :attr:`MPS.site_blocks`. ");
+          "Initialize the single site blocks :attr:`MPS.site_blocks`. ",
+          py::call_guard<py::gil_scoped_release>());
 }
@@ -2,6 +2,7 @@
 #include "SpinQuantum.h"
 #include "global.h"
 #include "input.h"
+#include "stackmemory.h"
 #include "timer.h"
 #ifdef _HAS_INTEL_MKL
 #include <mkl.h>
@@ -39,8 +40,10 @@ void pybind_io(py::module &m) {
         if (dmrginp.outputlevel() >= 0)
             cout << "allocating " << dmrginp.getMemory() << " doubles " << endl;
 
-        stackmemory = new double[dmrginp.getMemory()];
+        stackmemory = AllocateStackMemory(dmrginp.getMemory());
         Stackmem.resize(numthrds);
+        for (int i = 0; i < numthrds; i++)
+            Stackmem[i].strict = !dmrginp.relaxed_stack();
         Stackmem[0].data = stackmemory;
         Stackmem[0].size = dmrginp.getMemory();
         dmrginp.initCumulTimer();
@@ -54,7 +57,7 @@ void pybind_io(py::module &m) {
 
     m.def("release_stack_memory", []() {
         if (stackmemory != nullptr)
-            delete[] stackmemory;
+            FreeStackMemory(stackmemory);
     });
 
     py::enum_<algorithmTypes>(
@@ -134,7 +137,11 @@ void pybind_io(py::module &m) {
     py::class_<Global>(m, "Global", "Wrapper for global variables.")
         .def_property_static(
             "dmrginp", [](py::object) -> Input & { return dmrginp; },
-            [](py::object, const Input &input) { dmrginp = input; })
+            [](py::object, const Input &input) {
+                dmrginp = input;
+                couplingTable::table.init(
+                    dmrginp.spinAdapted() ? dmrginp.get_maxj() : 0);
+            })
         .def_property_static("non_abelian_sym",
                              [](py::object) -> bool { return NonabelianSym; },
                              [](py::object, bool b) { NonabelianSym = b; })
@@ -15,6 +15,8 @@ void pybind_operator(py::module &m);
 void pybind_matrix(py::module &m);
 void pybind_rev(py::module &m);
 void pybind_data_page(py::module &m);
+void pybind_metrics(py::module &m);
+void pybind_report(py::module &m);
 
 PYBIND11_MAKE_OPAQUE(vector<int>);
 PYBIND11_MAKE_OPAQUE(vector<bool>);
@@ -56,4 +58,12 @@ PYBIND11_MODULE(block, m) {
     
     py::module m_data_page = m.def_submodule("data_page", "Revised data page functions.");
     pybind_data_page(m_data_page);
+
+    py::module m_metrics = m.def_submodule(
+        "metrics", "Counters of the sweep positions, by callback or polling.");
+    pybind_metrics(m_metrics);
+
+    py::module m_report = m.def_submodule(
+        "report", "Performance reports of completed runs, with baselines.");
+    pybind_report(m_report);
 }
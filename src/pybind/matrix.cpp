@@ -3,9 +3,11 @@
 #include "StackMatrix.h"
 #include "StackOperators.h"
 #include "enumerator.h"
+#include "flatfile.h"
 #include "rotationmat.h"
 #include <Eigen/Dense>
 #include <pybind11/eigen.h>
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl_bind.h>
 #include <sstream>
@@ -25,6 +27,7 @@ void pybind_matrix(py::module &m) {
 
     py::class_<::Matrix>(m, "Matrix", "NEWMAT10 matrix.")
         .def(py::init<>())
+        .def(py::init<int, int>(), py::arg("nr"), py::arg("nc"))
         .def(py::init(
             [](Ref<Eigen::Matrix<double, Dynamic, Dynamic, RowMajor>> mat) {
                 ::Matrix smat(mat.rows(), mat.cols());
@@ -48,6 +51,8 @@ void pybind_matrix(py::module &m) {
             "rows", (int (::Matrix::*)() const)(&::Matrix::Nrows))
         .def_property_readonly(
             "cols", (int (::Matrix::*)() const)(&::Matrix::Ncols))
+        .def("resize", (void (::Matrix::*)(int, int)) & ::Matrix::ReSize,
+             py::arg("nr"), py::arg("nc"))
         .def("__repr__", [](::Matrix *self) {
             stringstream ss;
             ss << "[" << self->Nrows() << "x" << self->Ncols() << "]";
@@ -59,9 +64,76 @@ void pybind_matrix(py::module &m) {
     py::bind_vector<vector<::Matrix>, boost::shared_ptr<vector<::Matrix>>>(m, "VectorMatrix");
     py::bind_vector<vector<boost::shared_ptr<vector<::Matrix>>>>(m, "VectorVectorMatrix");
 
-    m.def("load_rotation_matrix", &LoadRotationMatrix, "Load rotation matrix.");
+    m.def("load_rotation_matrix",
+          (void (*)(const vector<int> &, vector<::Matrix> &, int)) &
+              LoadRotationMatrix,
+          "Load rotation matrix.");
 
-    m.def("save_rotation_matrix", &SaveRotationMatrix, "Save rotation matrix.");
+    m.def("save_rotation_matrix",
+          (void (*)(const vector<int> &, const vector<::Matrix> &, int)) &
+              SaveRotationMatrix,
+          "Save rotation matrix.");
+
+    m.def(
+        "load_rotation_matrix_arrays",
+        [](const vector<int> &sites, int state) {
+            const string file = RotationMatrixFile(sites, state);
+            py::list r;
+            if (IsFlatFile(file)) {
+                FlatFile *flat = new FlatFile();
+                flat->Open(file, FLAT_ROTATION);
+                py::capsule base(flat,
+                                 [](void *p) { delete (FlatFile *)p; });
+                for (size_t i = 0; i < flat->sections.size(); i++) {
+                    const FlatSection &sec = flat->sections[i];
+                    py::array_t<double> a(
+                        {(py::ssize_t)sec.rows, (py::ssize_t)sec.cols},
+                        (const double *)flat->Data(i), base);
+                    a.attr("setflags")(py::arg("write") = false);
+                    r.append(a);
+                }
+            } else {
+                vector<::Matrix> *mats = new vector<::Matrix>();
+                LoadRotationMatrix(sites, *mats, state);
+                py::capsule base(
+                    mats, [](void *p) { delete (vector<::Matrix> *)p; });
+                for (size_t i = 0; i < mats->size(); i++)
+                    r.append(py::array_t<double>(
+                        {(py::ssize_t)(*mats)[i].Nrows(),
+                         (py::ssize_t)(*mats)[i].Ncols()},
+                        (*mats)[i].data(), base));
+            }
+            return r;
+        },
+        py::arg("sites"), py::arg("state") = -1,
+        "Load rotation matrix as a list of numpy.ndarray, one per quantum "
+        "number. The arrays are read only views of the mapped file, or of the "
+        "loaded matrices for files in the boost archive format.");
+
+    m.def(
+        "save_rotation_matrix_arrays",
+        [](const vector<int> &sites, py::list arrays, int state) {
+            typedef py::array_t<double, py::array::c_style |
+                                            py::array::forcecast>
+                array_t;
+            vector<array_t> blocks;
+            vector<pair<int, int>> shapes;
+            vector<const double *> data;
+            for (auto x : arrays) {
+                blocks.push_back(array_t::ensure(x));
+                if (!blocks.back() || blocks.back().ndim() != 2)
+                    throw py::value_error("rotation matrix blocks have to be "
+                                          "two dimensional arrays");
+                shapes.push_back(make_pair((int)blocks.back().shape(0),
+                                           (int)blocks.back().shape(1)));
+                data.push_back(blocks.back().data());
+            }
+            SaveRotationMatrix(sites, shapes, data, state);
+        },
+        py::arg("sites"), py::arg("arrays"), py::arg("state") = -1,
+        "Save rotation matrix from a list of numpy.ndarray, one per quantum "
+        "number, in the flat format. C contiguous float64 arrays are written "
+        "without copying.");
 
     py::class_<::DiagonalMatrix>(m, "DiagonalMatrix",
                                  "NEWMAT10 diagonal matrix.")
@@ -0,0 +1,95 @@
+#include "metrics.h"
+#include <pybind11/functional.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl_bind.h>
+#include <memory>
+#include <vector>
+
+namespace py = pybind11;
+using namespace std;
+using namespace SpinAdapted;
+
+PYBIND11_MAKE_OPAQUE(vector<PositionMetrics>);
+
+void pybind_metrics(py::module &m) {
+
+    py::class_<PositionMetrics>(m, "PositionMetrics",
+                                "Counters of one sweep position of this rank.")
+        .def_readonly("sweep", &PositionMetrics::sweep)
+        .def_readonly("block", &PositionMetrics::block)
+        .def_readonly("sites", &PositionMetrics::sites)
+        .def_readonly("forward", &PositionMetrics::forward)
+        .def_readonly("energy", &PositionMetrics::energy)
+        .def_readonly("discarded_weight", &PositionMetrics::discarded_weight)
+        .def_readonly("davidson_iterations",
+                      &PositionMetrics::davidson_iterations)
+        .def_readonly("multiplyH_time", &PositionMetrics::multiplyH_time)
+        .def_readonly("multiplyH_flops", &PositionMetrics::multiplyH_flops)
+        .def_readonly("stack_peak", &PositionMetrics::stack_peak,
+                      "Peak of all Stackmem, in bytes.")
+        .def_readonly("datapage_peak", &PositionMetrics::datapage_peak,
+                      "Peak of all data pages, in bytes.")
+        .def_readonly("io_bytes", &PositionMetrics::io_bytes,
+                      "Bytes of the blocks stored and restored.")
+        .def_readonly("io_time", &PositionMetrics::io_time)
+        .def_readonly("wait_time", &PositionMetrics::wait_time,
+                      "Time blocked in MPI collectives.")
+        .def_readonly("wall_time", &PositionMetrics::wall_time)
+        .def("__repr__", [](const PositionMetrics &p) {
+            return "PositionMetrics(sweep=" + to_string(p.sweep) +
+                   ", block=" + to_string(p.block) +
+                   ", energy=" + to_string(p.energy) +
+                   ", wall_time=" + to_string(p.wall_time) + ")";
+        });
+
+    py::bind_vector<vector<PositionMetrics>>(m, "VectorPositionMetrics");
+
+    m.def("enable", &enableMetrics, py::arg("on") = true,
+          "Take a record at the end of every sweep position. Off, the "
+          "counters cost a test of a flag.");
+
+    m.def("enabled", []() { return metricsOn; });
+
+    // the sweep runs without the GIL, so the callback takes it
+    m.def(
+        "set_callback",
+        [](py::object f) {
+            if (f.is_none()) {
+                setMetricsCallback(function<void(const PositionMetrics &)>());
+                return;
+            }
+            // copies of the callback are made without the GIL, so they
+            // share one reference, released with the GIL
+            shared_ptr<py::function> g(new py::function(f),
+                                       [](py::function *p) {
+                                           py::gil_scoped_acquire acquire;
+                                           delete p;
+                                       });
+            setMetricsCallback([g](const PositionMetrics &p) {
+                py::gil_scoped_acquire acquire;
+                try {
+                    (*g)(p);
+                } catch (py::error_already_set &e) {
+                    e.restore();
+                    PyErr_Print();
+                }
+            });
+        },
+        py::arg("f"),
+        "Call f(record) at the end of every sweep position, on the thread of "
+        "the sweep. None removes it. Exceptions raised by f are printed.");
+
+    m.def("history", &metricsHistory,
+          "Records of all the positions since the last clear.");
+
+    m.def("latest",
+          []() -> py::object {
+              vector<PositionMetrics> h = metricsHistory();
+              if (h.empty())
+                  return py::none();
+              return py::cast(h.back());
+          },
+          "The record of the last position, or None.");
+
+    m.def("clear", &clearMetrics);
+}
@@ -10,6 +10,7 @@
 #include <Eigen/Dense>
 #include <boost/shared_ptr.hpp>
 #include <pybind11/eigen.h>
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl_bind.h>
 #include <sstream>
@@ -227,8 +228,39 @@ void pybind_operator(py::module &m) {
         m, "StackSparseMatrix",
         "Block-sparse matrix. \n"
         "Non-zero blocks are identified by symmetry (quantum numbers) "
-        "requirements and stored as :class:`StackMatrix` objects")
+        "requirements and stored as :class:`StackMatrix` objects. "
+        "The whole data region can be viewed with ``numpy.asarray``.",
+        py::buffer_protocol())
         .def(py::init<>())
+        .def_buffer([](StackSparseMatrix &self) -> py::buffer_info {
+            return py::buffer_info(self.get_data(), sizeof(double),
+                                   py::format_descriptor<double>::format(), 1,
+                                   {(ssize_t)self.set_totalMemory()},
+                                   {(ssize_t)sizeof(double)});
+        })
+        .def_property_readonly(
+            "block_offsets",
+            [](StackSparseMatrix *self) {
+                nz_blocks &nzb = self->get_nonZeroBlocks();
+                py::array_t<long> r(nzb.size());
+                for (size_t i = 0; i < nzb.size(); i++)
+                    r.mutable_at(i) = nzb[i].second.Store() - self->get_data();
+                return r;
+            },
+            "Offsets of the non zero blocks in the data region, in the order "
+            "of :attr:`StackSparseMatrix.non_zero_blocks`.")
+        .def_property_readonly(
+            "block_shapes",
+            [](StackSparseMatrix *self) {
+                nz_blocks &nzb = self->get_nonZeroBlocks();
+                py::array_t<int> r({(ssize_t)nzb.size(), (ssize_t)2});
+                for (size_t i = 0; i < nzb.size(); i++) {
+                    r.mutable_at(i, 0) = nzb[i].second.Nrows();
+                    r.mutable_at(i, 1) = nzb[i].second.Ncols();
+                }
+                return r;
+            },
+            "Rows and columns of the non zero blocks, as an n x 2 array.")
         .def_property(
             "total_memory",
             [](StackSparseMatrix *self) { return self->set_totalMemory(); },
@@ -289,7 +321,7 @@ void pybind_operator(py::module &m) {
         })
         .def_property("map_to_non_zero_blocks",
                       [](StackSparseMatrix *self) {
-                          return self->get_mapToNonZeroBlocks();
+                          return nz_map(self->get_mapToNonZeroBlocks());
                       },
                       [](StackSparseMatrix *self, const nz_map &m) {
                           self->get_mapToNonZeroBlocks() = m;
@@ -348,7 +380,7 @@ void pybind_operator(py::module &m) {
         .def(py::init<StackSparseMatrix&>());
 
     py::class_<StackWavefunction, boost::shared_ptr<StackWavefunction>,
-               StackSparseMatrix>(m, "Wavefunction")
+               StackSparseMatrix>(m, "Wavefunction", py::buffer_protocol())
         .def(py::init<>())
         .def_property("onedot", &StackWavefunction::get_onedot,
                       (void (StackWavefunction::*)(bool)) &
@@ -360,8 +392,10 @@ void pybind_operator(py::module &m) {
         .def("initialize_from", (void (StackWavefunction::*)(const StackWavefunction&))
              &StackWavefunction::initialise)
         .def("copy_data", &StackWavefunction::copyData)
+        // releases the GIL, only one thread may write the same file
         .def("save_wavefunction_info",
-             &StackWavefunction::SaveWavefunctionInfo);
+             &StackWavefunction::SaveWavefunctionInfo,
+             py::call_guard<py::gil_scoped_release>());
 
     py::class_<StackDensityMatrix, boost::shared_ptr<StackDensityMatrix>,
                StackSparseMatrix>(m, "DensityMatrix")
@@ -397,6 +431,8 @@ void pybind_operator(py::module &m) {
     pybind_stack_op_component<0, StackHam>(m, "Hamiltonian");
     pybind_stack_op_component<0, StackOverlap>(m, "Overlap");
 
+    // releases the GIL, thread safe if no two calls write the same c
     m.def("multiply_with_own_transpose",
-          &operatorfunctions::MultiplyWithOwnTranspose);
+          &operatorfunctions::MultiplyWithOwnTranspose,
+          py::call_guard<py::gil_scoped_release>());
 }
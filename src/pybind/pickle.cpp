@@ -1,11 +1,16 @@
 
 #include "SpinQuantum.h"
+#include "StateInfo.h"
 #include "StackBaseOperator.h"
 #include "StackMatrix.h"
 #include "Stackwavefunction.h"
 #include "enumerator.h"
+#include "flatmeta.h"
 #include <pybind11/pybind11.h>
 #include <pybind11/stl_bind.h>
+#include <boost/shared_ptr.hpp>
+#include <cstring>
+#include <map>
 #include <sstream>
 #include <string>
 
@@ -153,16 +158,113 @@ public:
             t_pickle<int>(this->rowCompressedForm),
             t_pickle<int>(this->colCompressedForm),
             t_pickle(this->nonZeroBlocks),
-            t_pickle(this->mapToNonZeroBlocks),
+            t_pickle(this->mapToNonZeroBlocks.get_elements()),
             this->symm_scale
         );
     }
 };
 
+// The shell as one flat record (StackSparseMatrix::PackFlat), the address of
+// the data and symm_scale. Tuples of the older list based form can still be
+// read.
 py::tuple pickle_stack_sparse_matrix(StackSparseMatrix *self) {
-    return ((PStackSparseMatrix*)self)->pickle();
+    vector<char> buf;
+    self->PackFlat(buf);
+    return py::make_tuple(py::bytes(buf.data(), buf.size()),
+                          (size_t)self->get_data(), self->symm_scale);
 }
 
 StackSparseMatrix unpickle_stack_sparse_matrix(py::tuple t) {
-    return (StackSparseMatrix) PStackSparseMatrix(t);
+    if (t.size() != 3)
+        return (StackSparseMatrix)PStackSparseMatrix(t);
+    StackSparseMatrix r;
+    string buf = t[0].cast<string>();
+    r.UnpackFlat(buf.data(), buf.size());
+    double *data = (double *)t[1].cast<size_t>();
+    if (data != 0) {
+        r.set_data(data);
+        r.allocateOperatorMatrix();
+    }
+    r.symm_scale = t[2].cast<double>();
+    return r;
+}
+
+py::bytes pickle_state_info(const StateInfo &self) {
+    vector<char> buf;
+    self.PackFlat(buf);
+    return py::bytes(buf.data(), buf.size());
+}
+
+StateInfo unpickle_state_info(const py::bytes &b) {
+    string buf = b;
+    StateInfo r;
+    r.UnpackFlat(buf.data(), buf.size());
+    return r;
+}
+
+// The StateInfos, and all that the left_state_info and right_state_info of
+// them and of their uncollected StateInfos point to, in one buffer: the
+// number of given and of all StateInfos, the record of each, then for each
+// the indices of its left, right, uncollected left and uncollected right
+// StateInfo (-1 for none).
+py::bytes pickle_state_infos(const vector<boost::shared_ptr<StateInfo>> &sis) {
+    vector<const StateInfo *> all;
+    map<const StateInfo *, long long> index;
+    auto add = [&all, &index](const StateInfo *x) -> long long {
+        if (x == 0)
+            return -1;
+        if (!index.count(x)) {
+            index[x] = all.size();
+            all.push_back(x);
+        }
+        return index[x];
+    };
+    for (auto &x : sis)
+        add(x.get());
+    vector<long long> links;
+    for (size_t i = 0; i < all.size(); i++) {
+        const StateInfo *x = all[i];
+        const StateInfo *u = x->unCollectedStateInfo.get();
+        links.push_back(add(x->leftStateInfo));
+        links.push_back(add(x->rightStateInfo));
+        links.push_back(u == 0 ? -1 : add(u->leftStateInfo));
+        links.push_back(u == 0 ? -1 : add(u->rightStateInfo));
+    }
+    vector<char> buf(2 * sizeof(long long));
+    long long n[2] = {(long long)sis.size(), (long long)all.size()};
+    memcpy(buf.data(), n, sizeof(n));
+    for (auto x : all)
+        x->PackFlat(buf);
+    size_t k = buf.size();
+    buf.resize(k + links.size() * sizeof(long long));
+    memcpy(buf.data() + k, links.data(), links.size() * sizeof(long long));
+    return py::bytes(buf.data(), buf.size());
+}
+
+// the given StateInfos first, then the ones they point to, which have to be
+// kept alive with them
+vector<boost::shared_ptr<StateInfo>> unpickle_state_infos(const py::bytes &b) {
+    string buf = b;
+    long long n[2];
+    memcpy(n, buf.data(), sizeof(n));
+    vector<boost::shared_ptr<StateInfo>> all(n[1]);
+    size_t k = sizeof(n);
+    for (auto &x : all) {
+        size_t len = FlatReader::RecordSize(buf.data() + k);
+        x = boost::shared_ptr<StateInfo>(new StateInfo);
+        x->UnpackFlat(buf.data() + k, len);
+        k += len;
+    }
+    vector<long long> links(4 * n[1]);
+    memcpy(links.data(), buf.data() + k, links.size() * sizeof(long long));
+    auto at = [&all](long long i) { return i == -1 ? (StateInfo *)0 : all[i].get(); };
+    for (size_t i = 0; i < all.size(); i++) {
+        all[i]->leftStateInfo = at(links[4 * i]);
+        all[i]->rightStateInfo = at(links[4 * i + 1]);
+        if (all[i]->unCollectedStateInfo) {
+            all[i]->unCollectedStateInfo->leftStateInfo = at(links[4 * i + 2]);
+            all[i]->unCollectedStateInfo->rightStateInfo = at(links[4 * i + 3]);
+        }
+    }
+    return all;
 }
\ No newline at end of file
@@ -0,0 +1,71 @@
+
+#include "report.h"
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <string>
+
+namespace py = pybind11;
+using namespace std;
+using namespace SpinAdapted;
+
+void pybind_report(py::module &m) {
+
+    py::class_<ReportRegion>(m, "ReportRegion",
+                             "A profiled region summed over threads and "
+                             "ranks, times in seconds.")
+        .def_readonly("count", &ReportRegion::count)
+        .def_readonly("time", &ReportRegion::time)
+        .def_readonly("self", &ReportRegion::self,
+                      "Time not spent in the child regions.")
+        .def_readonly("flops", &ReportRegion::flops)
+        .def_readonly("bytes", &ReportRegion::bytes);
+
+    py::class_<ReportPosition>(m, "ReportPosition",
+                               "A sweep position over the ranks.")
+        .def_readonly("sweep", &ReportPosition::sweep)
+        .def_readonly("block", &ReportPosition::block)
+        .def_readonly("sites", &ReportPosition::sites)
+        .def_readonly("ranks", &ReportPosition::ranks)
+        .def_readonly("forward", &ReportPosition::forward)
+        .def_readonly("wall_time", &ReportPosition::wall_time,
+                      "Largest of the ranks.")
+        .def_readonly("multiplyH_time", &ReportPosition::multiplyH_time)
+        .def_readonly("multiplyH_flops", &ReportPosition::multiplyH_flops)
+        .def_readonly("io_time", &ReportPosition::io_time)
+        .def_readonly("io_bytes", &ReportPosition::io_bytes)
+        .def_readonly("wait_time", &ReportPosition::wait_time)
+        .def_readonly("stack_peak", &ReportPosition::stack_peak);
+
+    py::class_<PerformanceReport>(m, "PerformanceReport",
+                                  "The profile and the sweep positions of a "
+                                  "completed run.")
+        .def_readonly("ranks", &PerformanceReport::ranks)
+        .def_readonly("regions", &PerformanceReport::regions,
+                      "Regions by their ';' separated call path.")
+        .def_readonly("positions", &PerformanceReport::positions)
+        .def("flame_graph", &writeFlameGraph, py::arg("file"),
+             "Write the self times as folded stacks for flamegraph.pl.")
+        .def(
+            "format",
+            [](const PerformanceReport &r, const PerformanceReport *baseline,
+               int top) { return formatPerformanceReport(r, baseline, top); },
+            py::arg("baseline") = (PerformanceReport *)nullptr,
+            py::arg("top") = 10,
+            "The phases and positions as text, with the top regressions "
+            "against baseline.")
+        .def("__str__", [](const PerformanceReport &r) {
+            return formatPerformanceReport(r);
+        });
+
+    m.def(
+        "read",
+        [](const string &prefix) {
+            PerformanceReport r;
+            if (!readPerformanceReport(prefix, r))
+                throw runtime_error("no profile in " + prefix);
+            return r;
+        },
+        py::arg("prefix"),
+        "Read the profile.rank<n>.json and metrics.rank<n>.json files that "
+        "the profile keyword leaves in the save prefix.");
+}
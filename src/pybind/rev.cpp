@@ -1,12 +1,15 @@
 
+#include "rev/block_tensor.hpp"
 #include "rev/operator_functions.hpp"
 #include "StackMatrix.h"
 #include "StackOperators.h"
 #include "enumerator.h"
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl_bind.h>
 #include <pybind11/iostream.h>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 
 namespace py = pybind11;
@@ -16,44 +19,164 @@ using namespace SpinAdapted;
 PYBIND11_MAKE_OPAQUE(vector<boost::shared_ptr<StateInfo>>);
 PYBIND11_MAKE_OPAQUE(vector<::Matrix>);
 
+// The kernels release the GIL. They only read dmrginp and their arguments
+// and write their output, so calls from several Python threads may run at
+// the same time if no two of them write the same matrix. The exceptions are
+// tensor_product_multiply and TensorProductMultiplyPlan.multiply(_batch), which
+// allocate temporaries on the current stack page: no other thread may
+// allocate on that page while they run.
 void pybind_rev(py::module &m) {
     
     m.def("tensor_trace", &block2::TensorTrace, py::arg("a"), py::arg("c"),
-          py::arg("state_info"), py::arg("trace_right"), py::arg("scale") = 1.0);
+          py::arg("state_info"), py::arg("trace_right"), py::arg("scale") = 1.0,
+          py::call_guard<py::gil_scoped_release>());
     
     m.def("tensor_product", &block2::TensorProduct, py::arg("a"), py::arg("b"), py::arg("c"),
-          py::arg("state_info"), py::arg("scale") = 1.0);
+          py::arg("state_info"), py::arg("scale") = 1.0, py::call_guard<py::gil_scoped_release>());
+    
+    m.def("tensor_product_batch", [](py::list c, py::list terms,
+                                     const vector<boost::shared_ptr<StateInfo>> &state_info) {
+              if (c.size() != terms.size())
+                  throw runtime_error("tensor_product_batch: c and terms have different lengths");
+              vector<StackSparseMatrix *> cs;
+              vector<vector<block2::TensorProductTerm>> ts(terms.size());
+              cs.reserve(c.size());
+              for (size_t i = 0; i < c.size(); i++) {
+                  cs.push_back(c[i].cast<StackSparseMatrix *>());
+                  py::list ti = terms[i].cast<py::list>();
+                  ts[i].reserve(ti.size());
+                  for (auto x : ti) {
+                      py::tuple t = x.cast<py::tuple>();
+                      block2::TensorProductTerm term;
+                      term.a = t[0].is_none() ? nullptr : t[0].cast<const StackSparseMatrix *>();
+                      term.b = t[1].is_none() ? nullptr : t[1].cast<const StackSparseMatrix *>();
+                      term.scale = t[2].cast<double>();
+                      ts[i].push_back(term);
+                  }
+              }
+              py::gil_scoped_release release;
+              block2::TensorProductBatch(ts, cs, state_info);
+          }, py::arg("c"), py::arg("terms"), py::arg("state_info"),
+          "Add the list of terms (a, b, scale) to each c, a or b None for the identity.");
     
     m.def("product", &block2::Product, py::arg("a"), py::arg("b"), py::arg("c"),
-          py::arg("state_info"), py::arg("scale") = 1.0);
+          py::arg("state_info"), py::arg("scale") = 1.0, py::call_guard<py::gil_scoped_release>());
     
     m.def("tensor_rotate", &block2::TensorRotate, py::arg("a"), py::arg("c"),
-          py::arg("state_info"), py::arg("rotate_matrices"), py::arg("scale") = 1.0);
+          py::arg("state_info"), py::arg("rotate_matrices"), py::arg("scale") = 1.0,
+          py::call_guard<py::gil_scoped_release>());
     
     m.def("tensor_trace_diagonal", &block2::TensorTraceDiagonal, py::arg("a"), py::arg("c"),
-          py::arg("state_info"), py::arg("trace_right"), py::arg("scale") = 1.0);
+          py::arg("state_info"), py::arg("trace_right"), py::arg("scale") = 1.0,
+          py::call_guard<py::gil_scoped_release>());
     
     m.def("tensor_product_diagonal", &block2::TensorProductDiagonal, py::arg("a"), py::arg("b"), py::arg("c"),
-          py::arg("state_info"), py::arg("scale") = 1.0);
+          py::arg("state_info"), py::arg("scale") = 1.0, py::call_guard<py::gil_scoped_release>());
     
-    m.def("tensor_scale", &block2::TensorScale, py::arg("scale"), py::arg("a"));
+    m.def("tensor_scale", &block2::TensorScale, py::arg("scale"), py::arg("a"),
+          py::call_guard<py::gil_scoped_release>());
     
     m.def("tensor_scale_add", (void (*)(double, const StackSparseMatrix &, StackSparseMatrix &,
         const vector<boost::shared_ptr<StateInfo>> &)) &block2::TensorScaleAdd, py::arg("scale"),
-          py::arg("a"), py::arg("c"), py::arg("state_info"));
+          py::arg("a"), py::arg("c"), py::arg("state_info"),
+          py::call_guard<py::gil_scoped_release>());
     
     m.def("tensor_scale_add_no_trans", (void (*)(double, const StackSparseMatrix &, StackSparseMatrix &))
-        &block2::TensorScaleAdd, py::arg("scale"), py::arg("a"), py::arg("c"));
+        &block2::TensorScaleAdd, py::arg("scale"), py::arg("a"), py::arg("c"),
+        py::call_guard<py::gil_scoped_release>());
         
-    m.def("tensor_dot_product", &block2::TensorDotProduct, py::arg("a"), py::arg("b"));
+    m.def("tensor_dot_product", &block2::TensorDotProduct, py::arg("a"), py::arg("b"),
+          py::call_guard<py::gil_scoped_release>());
     
-    m.def("tensor_precondition", &block2::TensorPrecondition, py::arg("a"), py::arg("e"), py::arg("diag"));
+    m.def("tensor_precondition", &block2::TensorPrecondition, py::arg("a"), py::arg("e"), py::arg("diag"),
+          py::call_guard<py::gil_scoped_release>());
     
     m.def("tensor_product_multiply", &block2::TensorProductMultiply, py::arg("a"), py::arg("b"), py::arg("c"), py::arg("v"),
-         py::arg("state_info"), py::arg("op_q"), py::arg("scale"));
+         py::arg("state_info"), py::arg("op_q"), py::arg("scale"),
+         py::call_guard<py::gil_scoped_release>());
+    
+    py::class_<block2::TensorProductMultiplyPlan>(m, "TensorProductMultiplyPlan",
+        "Precomputed block walk and coupling coefficients of :func:`tensor_product_multiply`.")
+        .def(py::init<const StackSparseMatrix &, const StackSparseMatrix &, const StackWavefunction &,
+                      const StackWavefunction &, const vector<boost::shared_ptr<StateInfo>> &,
+                      const SpinQuantum>(),
+             py::arg("a"), py::arg("b"), py::arg("c"), py::arg("v"), py::arg("state_info"), py::arg("op_q"))
+        .def("multiply", &block2::TensorProductMultiplyPlan::multiply, py::arg("a"), py::arg("b"),
+             py::arg("c"), py::arg("v"), py::arg("scale"), py::call_guard<py::gil_scoped_release>())
+        .def("multiply_batch", [](const block2::TensorProductMultiplyPlan &plan, const StackSparseMatrix &a,
+                                  const StackSparseMatrix &b, py::list c, py::list v, double scale) {
+                 if (c.size() != v.size())
+                     throw runtime_error("multiply_batch: c and v must have the same length");
+                 vector<const StackWavefunction *> cs;
+                 vector<StackWavefunction *> vs;
+                 for (auto x : c)
+                     cs.push_back(&x.cast<const StackWavefunction &>());
+                 for (auto x : v)
+                     vs.push_back(&x.cast<StackWavefunction &>());
+                 py::gil_scoped_release release;
+                 plan.multiply_batch(a, b, cs, vs, scale);
+             }, py::arg("a"), py::arg("b"), py::arg("c"), py::arg("v"), py::arg("scale"),
+             "v[k] += scale * a c[k] b for all wavefunctions in the lists c and v.")
+        .def_property_readonly("size", &block2::TensorProductMultiplyPlan::size);
+    
+    m.def("block_tensor_contract", [](py::list a, py::list b, py::list c, py::list gemms) {
+              auto matrix = [](py::handle x, bool out) {
+                  py::array arr = py::reinterpret_borrow<py::array>(x);
+                  if (!py::isinstance<py::array_t<double>>(arr) || arr.ndim() != 2 ||
+                      !(arr.flags() & py::array::c_style) || (out && !arr.writeable()))
+                      throw runtime_error("block_tensor_contract: blocks must be C-contiguous 2-d float64 arrays");
+                  return arr;
+              };
+              vector<py::array> as, bs, cs;
+              for (auto x : a)
+                  as.push_back(matrix(x, false));
+              for (auto x : b)
+                  bs.push_back(matrix(x, false));
+              for (auto x : c)
+                  cs.push_back(matrix(x, true));
+              vector<block2::BlockGemm> gs;
+              gs.reserve(gemms.size());
+              for (auto x : gemms) {
+                  py::tuple t = x.cast<py::tuple>();
+                  size_t ia = t[0].cast<size_t>(), ib = t[1].cast<size_t>(), ic = t[2].cast<size_t>();
+                  if (ia >= as.size() || ib >= bs.size() || ic >= cs.size())
+                      throw runtime_error("block_tensor_contract: block index out of range");
+                  const py::array &xa = as[ia], &xb = bs[ib], &xc = cs[ic];
+                  if (xa.shape(1) != xb.shape(0) || xa.shape(0) != xc.shape(0) || xb.shape(1) != xc.shape(1))
+                      throw runtime_error("block_tensor_contract: block shapes do not match");
+                  block2::BlockGemm g;
+                  g.a = (const double *)xa.data();
+                  g.b = (const double *)xb.data();
+                  g.c = (double *)cs[ic].mutable_data();
+                  g.m = (int)xa.shape(0);
+                  g.n = (int)xb.shape(1);
+                  g.k = (int)xa.shape(1);
+                  gs.push_back(g);
+              }
+              py::gil_scoped_release release;
+              block2::BlockTensorContract(gs);
+          }, py::arg("a"), py::arg("b"), py::arg("c"), py::arg("gemms"),
+          "c[ic] += a[ia] @ b[ib] for each (ia, ib, ic) in gemms, all blocks C-contiguous 2-d float64 arrays.");
     
     m.def("tensor_trace_multiply", &block2::TensorTraceMultiply, py::arg("a"), py::arg("c"), py::arg("v"),
-         py::arg("state_info"), py::arg("trace_right"), py::arg("scale"));
+         py::arg("state_info"), py::arg("trace_right"), py::arg("scale"),
+         py::call_guard<py::gil_scoped_release>());
+    
+    m.def("tensor_trace_multiply_batch", [](const StackSparseMatrix &a, py::list c, py::list v,
+                                            const StateInfo &state_info, bool trace_right, double scale) {
+              if (c.size() != v.size())
+                  throw runtime_error("tensor_trace_multiply_batch: c and v must have the same length");
+              vector<const StackWavefunction *> cs;
+              vector<StackWavefunction *> vs;
+              for (auto x : c)
+                  cs.push_back(&x.cast<const StackWavefunction &>());
+              for (auto x : v)
+                  vs.push_back(&x.cast<StackWavefunction &>());
+              py::gil_scoped_release release;
+              for (size_t k = 0; k < cs.size(); k++)
+                  block2::TensorTraceMultiply(a, *cs[k], *vs[k], state_info, trace_right, scale);
+          }, py::arg("a"), py::arg("c"), py::arg("v"), py::arg("state_info"), py::arg("trace_right"),
+          py::arg("scale"), ":func:`tensor_trace_multiply` for all wavefunctions in the lists c and v.");
 //           py::call_guard<py::scoped_ostream_redirect,
 //                      py::scoped_estream_redirect>());
 
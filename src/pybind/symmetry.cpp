@@ -21,6 +21,11 @@ PYBIND11_MAKE_OPAQUE(vector<int>);
 
 PYBIND11_DECLARE_HOLDER_TYPE(T, boost::shared_ptr<T>);
 
+py::bytes pickle_state_info(const StateInfo &self);
+StateInfo unpickle_state_info(const py::bytes &b);
+py::bytes pickle_state_infos(const vector<boost::shared_ptr<StateInfo>> &sis);
+vector<boost::shared_ptr<StateInfo>> unpickle_state_infos(const py::bytes &b);
+
 void pybind_symmetry(py::module &m) {
 
     py::class_<SpinSpace>(m, "SpinSpace",
@@ -139,12 +144,18 @@ void pybind_symmetry(py::module &m) {
             "transform_state", &StateInfo::transform_state,
             "Truncate state space based on dimension of rotation matrix.")
         .def("collect_quanta", &StateInfo::CollectQuanta)
+        .def("build_collected_index", &StateInfo::BuildCollectedIndex,
+             "Rebuild the flat collected index tables after "
+             ":attr:`StateInfo.old_to_new_state` is set manually.")
         .def_readwrite("n_total_states", &StateInfo::totalStates)
         .def("copy",
              [](StateInfo *self) {
                  StateInfo x = *self;
                  return x;
              })
+        .def(py::pickle(
+            [](StateInfo *self) { return py::make_tuple(pickle_state_info(*self)); },
+            [](py::tuple t) { return unpickle_state_info(t[0].cast<py::bytes>()); }))
         .def("__repr__", [](StateInfo *self) {
             stringstream ss;
             ss << *self;
@@ -153,6 +164,14 @@ void pybind_symmetry(py::module &m) {
     
     py::bind_vector<vector<boost::shared_ptr<StateInfo>>>(m, "VectorStateInfo");
 
+    m.def("pickle_state_infos", &pickle_state_infos, py::arg("state_infos"),
+          "Several StateInfos with the StateInfos their left, right and "
+          "uncollected left and right StateInfo point to, as bytes.");
+    m.def("unpickle_state_infos", &unpickle_state_infos, py::arg("data"),
+          "The StateInfos of :func:`pickle_state_infos` with their pointers "
+          "restored: the given ones first, then the ones they point to, which "
+          "have to be kept alive as long as the given ones are used.");
+
     m.def("state_tensor_product", [](StateInfo &a, StateInfo &b) {
         StateInfo c;
         TensorProduct(a, b, c, NO_PARTICLE_SPIN_NUMBER_CONSTRAINT, 0);
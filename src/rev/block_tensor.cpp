@@ -0,0 +1,43 @@
+#include "rev/block_tensor.hpp"
+#include "blas_calls.h"
+#include "global.h"
+#include <algorithm>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+using namespace SpinAdapted;
+
+namespace block2 {
+
+void BlockTensorContract(const vector<BlockGemm> &gemms) {
+    
+    // group the products by output, keeping their order within each output
+    vector<int> idx(gemms.size());
+    for (int i = 0; i < (int)idx.size(); i++)
+        idx[i] = i;
+    stable_sort(idx.begin(), idx.end(),
+                [&gemms](int i, int j) { return gemms[i].c < gemms[j].c; });
+    vector<int> starts;
+    for (int i = 0; i < (int)idx.size(); i++)
+        if (i == 0 || gemms[idx[i]].c != gemms[idx[i - 1]].c)
+            starts.push_back(i);
+    starts.push_back((int)idx.size());
+    
+    int thrds = dmrginp.quanta_thrds();
+#pragma omp parallel for schedule(dynamic) num_threads(thrds) if (starts.size() > 2)
+    for (int ic = 0; ic < (int)starts.size() - 1; ic++)
+        for (int i = starts[ic]; i < starts[ic + 1]; i++) {
+            const BlockGemm &g = gemms[idx[i]];
+            if (g.m == 0 || g.n == 0 || g.k == 0)
+                continue;
+            // column-major c^T += b^T a^T
+            DGEMM('n', 'n', g.n, g.m, g.k, 1.0, const_cast<double *>(g.b), g.n,
+                  const_cast<double *>(g.a), g.k, 1.0, g.c, g.n);
+        }
+    
+}
+
+} // namespace block2
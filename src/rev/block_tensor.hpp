@@ -0,0 +1,25 @@
+#ifndef REV_BLOCK_TENSOR_HPP_
+#define REV_BLOCK_TENSOR_HPP_
+
+#include <vector>
+
+using namespace std;
+
+namespace block2 {
+
+// c += a b for dense row-major blocks, a is m x k, b is k x n and c is m x n
+// one product of a reduced block contraction in pyblock.tensor.Tensor.contract
+struct BlockGemm {
+    const double *a, *b;
+    double *c;
+    int m, n, k;
+};
+
+// all block products of one block-sparse contraction.
+// products with the same output are done in the given order by one thread,
+// different outputs in parallel
+void BlockTensorContract(const vector<BlockGemm> &gemms);
+
+} // namespace block2
+
+#endif /* REV_BLOCK_TENSOR_HPP_ */
@@ -3,12 +3,21 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <cstring>
+#include <deque>
+#include <list>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <sys/mman.h>
 #ifdef _HAS_INTEL_MKL
 #include <mkl.h>
 #endif
 #include "global.h"
 #include "alloc.h"
 #include "data_page.hpp"
+#include "stackmemory.h"
 
 using namespace std;
 using namespace SpinAdapted;
@@ -19,6 +28,25 @@ int main_page = 0;
 StackAllocator<double> *current_page;
 vector<StackAllocator<double>> DataPages;
 
+// doubles of address space of each page, 0 for the fixed layout
+static size_t page_reserve = 0;
+// high water mark of each page over the whole run
+static vector<size_t> page_peak;
+
+// gives the memory of page ip above memused back to the system, the next
+// use of it is a zero page. Not worth a system call for small amounts.
+static void trim_data_page(int ip) {
+    StackAllocator<double> &p = DataPages[ip];
+    page_peak[ip] = max(page_peak[ip], p.touched);
+    const size_t chunk = 262144;
+    size_t from = (p.memused + chunk - 1) / chunk * chunk;
+    if (page_reserve == 0 || p.touched < from + chunk * 4)
+        return;
+    size_t to = (p.touched + chunk - 1) / chunk * chunk;
+    madvise(p.data + from, sizeof(double) * (to - from), MADV_DONTNEED);
+    p.touched = p.memused;
+}
+
 void init_data_pages(int n_pages) {
     dmrginp.matmultFlops.resize(max(numthrds, dmrginp.quanta_thrds()), 0.);
     dmrginp.initCumulTimer();
@@ -33,11 +61,38 @@ void init_data_pages(int n_pages) {
             n_pages << " data pages" << ")" << endl;
     
     size_t n_total = dmrginp.getMemory();
-    size_t n_vari = n_total / 200;
+    DataPages.resize(n_pages);
+    page_peak.assign(n_pages, 0);
+    
+    // every page reserves address space for the whole budget, so a page can
+    // grow as far as the others leave room; physical memory is only used
+    // where a page has been written, and is given back when it shrinks
+    page_reserve = (n_total + 262143) / 262144 * 262144;
+    void *arena = mmap(0, sizeof(double) * page_reserve * n_pages, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (arena != MAP_FAILED) {
+        // the pages grow on demand, so only transparent huge pages fit here
+        if (dmrginp.hugepage_stack())
+            madvise(arena, sizeof(double) * page_reserve * n_pages, MADV_HUGEPAGE);
+        for (int i = 0; i < n_pages; i++) {
+            DataPages[i].size = page_reserve;
+            DataPages[i].memused = 0;
+            DataPages[i].strict = !dmrginp.relaxed_stack();
+            DataPages[i].data = (double *)arena + page_reserve * i;
+            DataPages[i].arena = &DataPages;
+            DataPages[i].arena_size = n_total;
+        }
+        if (dmrginp.outputlevel() >= 0)
+            cout << "pages share " << n_total << " doubles" << endl;
+        activate_data_page(0);
+        return;
+    }
+    
+    // fixed layout if the address space can not be reserved
+    page_reserve = 0;
     size_t n_base = n_total / (n_pages + 1) / 262144 * 262144;
     size_t n_acc = 0;
-    double *ptr = new double[n_total];
-    DataPages.resize(n_pages);
+    double *ptr = AllocateStackMemory(n_total);
     
     for (int i = 1; i < n_pages; i++)
         DataPages[i].size = n_base, n_acc += n_base;
@@ -48,18 +103,195 @@ void init_data_pages(int n_pages) {
         if (dmrginp.outputlevel() >= 0)
             cout << "page " << i << " allocated " << DataPages[i].size << " doubles" << endl;
         DataPages[i].memused = 0;
+        DataPages[i].strict = !dmrginp.relaxed_stack();
         DataPages[i].data = ptr;
     }
     
     activate_data_page(0);
 }
 
+// page files queued for the I/O thread
+struct PageTask {
+    int ip;
+    string filename;
+    bool save;
+};
+
+static deque<PageTask> page_tasks;
+static vector<int> page_pending; // queued or running tasks of each page
+static mutex page_mutex;
+static condition_variable page_condition;
+static thread *page_io = 0;
+static bool stop_page_io = false;
+
+// copies of page files, most recently used first
+typedef list<pair<string, vector<double>>> page_cache_list;
+static page_cache_list page_cache;
+static map<string, page_cache_list::iterator> page_cache_index;
+static size_t page_cache_size = 0, page_cache_used = 0;
+static mutex page_cache_mutex;
+
+static void drop_cached_page(const string& filename) {
+    map<string, page_cache_list::iterator>::iterator it = page_cache_index.find(filename);
+    if (it != page_cache_index.end()) {
+        page_cache_used -= it->second->second.size();
+        page_cache.erase(it->second);
+        page_cache_index.erase(it);
+    }
+}
+
+static void cache_page(int ip, const string& filename) {
+    lock_guard<mutex> lock(page_cache_mutex);
+    drop_cached_page(filename);
+    size_t n = DataPages[ip].memused;
+    if (n > page_cache_size)
+        return;
+    while (page_cache_used + n > page_cache_size) {
+        page_cache_used -= page_cache.back().second.size();
+        page_cache_index.erase(page_cache.back().first);
+        page_cache.pop_back();
+    }
+    page_cache.push_front(make_pair(filename, vector<double>(DataPages[ip].data,
+        DataPages[ip].data + n)));
+    page_cache_index[filename] = page_cache.begin();
+    page_cache_used += n;
+}
+
+static bool load_cached_page(int ip, const string& filename) {
+    lock_guard<mutex> lock(page_cache_mutex);
+    map<string, page_cache_list::iterator>::iterator it = page_cache_index.find(filename);
+    if (it == page_cache_index.end())
+        return false;
+    page_cache.splice(page_cache.begin(), page_cache, it->second);
+    const vector<double>& d = it->second->second;
+    DataPages[ip].memused = d.size();
+    if (!d.empty())
+        memcpy(DataPages[ip].data, &d[0], sizeof(double) * d.size());
+    DataPages[ip].touched = max(DataPages[ip].touched, d.size());
+    return true;
+}
+
+static void write_page(int ip, const string& filename) {
+    ofstream ofs(filename.c_str(), ios::binary);
+    ofs.write((char*)&DataPages[ip].memused, sizeof(DataPages[ip].memused));
+    ofs.write((char*)DataPages[ip].data, sizeof(double) * DataPages[ip].memused);
+    ofs.close();
+    if (page_cache_size != 0)
+        cache_page(ip, filename);
+}
+
+static void read_page(int ip, const string& filename) {
+    if (page_cache_size == 0 || !load_cached_page(ip, filename)) {
+        size_t n = 0;
+        ifstream ifs(filename.c_str(), ios::binary);
+        ifs.read((char*)&n, sizeof(n));
+        if (n > DataPages[ip].size) {
+            cout << "data page file " << filename << " does not fit in page " << ip << endl;
+            abort();
+        }
+        DataPages[ip].memused = n;
+        ifs.read((char*)DataPages[ip].data, sizeof(double) * n);
+        ifs.close();
+        DataPages[ip].touched = max(DataPages[ip].touched, n);
+        if (page_cache_size != 0)
+            cache_page(ip, filename);
+    }
+    trim_data_page(ip);
+}
+
+static void page_io_loop() {
+    unique_lock<mutex> lock(page_mutex);
+    while (true) {
+        page_condition.wait(lock, [] { return !page_tasks.empty() || stop_page_io; });
+        if (page_tasks.empty())
+            return;
+        PageTask t = page_tasks.front();
+        page_tasks.pop_front();
+        lock.unlock();
+        if (t.save)
+            write_page(t.ip, t.filename);
+        else
+            read_page(t.ip, t.filename);
+        lock.lock();
+        page_pending[t.ip]--;
+        page_condition.notify_all();
+    }
+}
+
+static void stop_page_thread() {
+    {
+        unique_lock<mutex> lock(page_mutex);
+        stop_page_io = true;
+        page_condition.notify_all();
+    }
+    if (page_io != 0) {
+        page_io->join();
+        delete page_io;
+        page_io = 0;
+    }
+    stop_page_io = false;
+}
+
+static void queue_page_task(int ip, const string& filename, bool save) {
+    unique_lock<mutex> lock(page_mutex);
+    if (page_io == 0)
+        page_io = new thread(page_io_loop);
+    if (page_pending.size() < DataPages.size())
+        page_pending.resize(DataPages.size(), 0);
+    page_pending[ip]++;
+    PageTask t = { ip, filename, save };
+    page_tasks.push_back(t);
+    page_condition.notify_all();
+}
+
+void wait_data_page(int ip) {
+    unique_lock<mutex> lock(page_mutex);
+    page_condition.wait(lock, [ip] {
+        for (size_t i = 0; i < page_pending.size(); i++)
+            if ((ip == -1 || ip == (int)i) && page_pending[i] != 0)
+                return false;
+        return true;
+    });
+}
+
+bool data_page_ready(int ip) {
+    lock_guard<mutex> lock(page_mutex);
+    return ip >= (int)page_pending.size() || page_pending[ip] == 0;
+}
+
+void set_data_page_cache(size_t n) {
+    lock_guard<mutex> lock(page_cache_mutex);
+    page_cache_size = n;
+    while (page_cache_used > page_cache_size) {
+        page_cache_used -= page_cache.back().second.size();
+        page_cache_index.erase(page_cache.back().first);
+        page_cache.pop_back();
+    }
+}
+
+void print_data_page_usage() {
+    for (size_t i = 0; i < DataPages.size(); i++) {
+        page_peak[i] = max(page_peak[i], DataPages[i].touched);
+        cout << "page " << i << " peak " << page_peak[i] << " doubles" << endl;
+    }
+}
+
 void release_data_pages() {
-    delete[] DataPages[0].data;
+    wait_data_page(-1);
+    stop_page_thread();
+    set_data_page_cache(0);
+    if (dmrginp.outputlevel() >= 0)
+        print_data_page_usage();
+    if (page_reserve != 0)
+        munmap(DataPages[0].data, sizeof(double) * page_reserve * DataPages.size());
+    else
+        FreeStackMemory(DataPages[0].data);
     DataPages.resize(0);
+    page_pending.resize(0);
 }
 
 void activate_data_page(int ip) {
+    wait_data_page(ip);
     main_page = ip;
     current_page = &DataPages[ip];
 }
@@ -69,21 +301,28 @@ size_t get_data_page_pointer(int ip) {
 }
 
 void set_data_page_pointer(int ip, size_t offset) {
+    wait_data_page(ip);
     DataPages[ip].memused = offset;
+    DataPages[ip].release_deferred();
+    trim_data_page(ip);
 }
 
 void save_data_page(int ip, const string& filename) {
-    ofstream ofs(filename.c_str(), ios::binary);
-    ofs.write((char*)&DataPages[ip].memused, sizeof(DataPages[ip].memused));
-    ofs.write((char*)DataPages[ip].data, sizeof(double) * DataPages[ip].memused);
-    ofs.close();
+    wait_data_page(ip);
+    write_page(ip, filename);
 }
 
 void load_data_page(int ip, const string& filename) {
-    ifstream ifs(filename.c_str(), ios::binary);
-    ifs.read((char*)&DataPages[ip].memused, sizeof(DataPages[ip].memused));
-    ifs.read((char*)DataPages[ip].data, sizeof(double) * DataPages[ip].memused);
-    ifs.close();
+    wait_data_page(ip);
+    read_page(ip, filename);
+}
+
+void save_data_page_async(int ip, const string& filename) {
+    queue_page_task(ip, filename, true);
+}
+
+void load_data_page_async(int ip, const string& filename) {
+    queue_page_task(ip, filename, false);
 }
     
 } // namespace block2
\ No newline at end of file
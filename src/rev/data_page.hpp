@@ -8,8 +8,13 @@ using namespace std;
 
 namespace block2 {
 
+// the pages share dmrginp.getMemory() doubles, each one can use what the
+// others leave free
 void init_data_pages(int n_pages);
 
+// prints the largest use of each page during the run
+void print_data_page_usage();
+
 void release_data_pages();
 
 void activate_data_page(int ip);
@@ -22,6 +27,24 @@ void save_data_page(int ip, const string& filename);
 
 void load_data_page(int ip, const string& filename);
 
+// save and load on a background I/O thread, in the order they are queued.
+// page ip must not be written before the operation is finished, and a loaded
+// page must not be read before; activate_data_page, set_data_page_pointer and
+// the synchronous save/load wait for the pending operations on their page.
+void save_data_page_async(int ip, const string& filename);
+
+void load_data_page_async(int ip, const string& filename);
+
+// waits for the pending operations on page ip, or on all pages if ip == -1
+void wait_data_page(int ip);
+
+// true if there is no pending operation on page ip
+bool data_page_ready(int ip);
+
+// keep copies of up to n doubles of the most recently saved or loaded page
+// files in memory, loads of these files are done with a copy
+void set_data_page_cache(size_t n);
+
 } // namespace block2
 
 #endif /* REV_OPERATOR_FUNCTIONS_H_ */
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "couplingCoeffs.h"
 #include "global.h"
 #include "newmat.h"
+#include "quanta_tasks.h"
 #include <cmath>
 #include <vector>
 #include <iostream>
@@ -49,35 +50,27 @@ void TensorTraceElement(const StackSparseMatrix &a, StackSparseMatrix &c,
     const StateInfo *rs = cs->rightStateInfo;
     
     const char conjC = trace_right ? 'n' : 't';
-    const std::vector<int> oldToNewI = cs->oldToNewState.at(cq);
-    const std::vector<int> oldToNewJ = cs->oldToNewState.at(cqprime);
+    assert(cs->collectedStart.size() == cs->quanta.size() + 1);
     
-    int rowstride = 0, colstride = 0;
-
-    for (int oldi = 0; oldi < oldToNewI.size(); oldi++) {
-        colstride = 0;
-        for (int oldj = 0; oldj < oldToNewJ.size(); oldj++) {
+    for (int oldi = cs->collectedStart[cq]; oldi < cs->collectedStart[cq + 1]; oldi++) {
+        const int rowstride = cs->collectedOffset[oldi];
+        for (int oldj = cs->collectedStart[cqprime]; oldj < cs->collectedStart[cqprime + 1]; oldj++) {
+            const int colstride = cs->collectedOffset[oldj];
             if (conjC == 'n') {
-                aq = cs->leftUnMapQuanta[oldToNewI[oldi]];
-                aqprime = cs->leftUnMapQuanta[oldToNewJ[oldj]];
-                bq = cs->rightUnMapQuanta[oldToNewI[oldi]];
-                bqprime = cs->rightUnMapQuanta[oldToNewJ[oldj]];
+                aq = cs->collectedLeft[oldi];
+                aqprime = cs->collectedLeft[oldj];
+                bq = cs->collectedRight[oldi];
+                bqprime = cs->collectedRight[oldj];
                 bstates = rs->getquantastates(bq); // bq == bqprime, which is traced (right: 1)
             } else {
-                aq = cs->rightUnMapQuanta[oldToNewI[oldi]];
-                aqprime = cs->rightUnMapQuanta[oldToNewJ[oldj]];
-                bq = cs->leftUnMapQuanta[oldToNewI[oldi]];
-                bqprime = cs->leftUnMapQuanta[oldToNewJ[oldj]];
+                aq = cs->collectedRight[oldi];
+                aqprime = cs->collectedRight[oldj];
+                bq = cs->collectedLeft[oldi];
+                bqprime = cs->collectedLeft[oldj];
                 bstates = ls->getquantastates(bq); // bq == bqprime, which is traced (left: 0)
             }
 
             if (a.allowed(aq, aqprime) && (bq == bqprime)) {
-                
-                DiagonalMatrix unitMatrix(bstates);
-                unitMatrix = 1.;
-
-                Matrix unity(bstates, bstates);
-                unity = unitMatrix;
 
                 if (conjC == 'n') {
                     double scaleb = dmrginp.get_ninej()(
@@ -102,9 +95,9 @@ void TensorTraceElement(const StackSparseMatrix &a, StackSparseMatrix &c,
                     
                     // no fermion check for trace right A x I(bigger site index)
 
-                    MatrixTensorProduct(a.operator_element(aq, aqprime),
-                                        a.conjugacy(), scale, unity, 'n',
-                                        scaleb, cel, rowstride, colstride);
+                    MatrixTensorProductIdentityRight(
+                        a.operator_element(aq, aqprime), a.conjugacy(),
+                        scale * scaleb, bstates, cel, rowstride, colstride);
                 } else {
                     double scaleb = dmrginp.get_ninej()(
                         ls->quanta[bqprime].get_s().getirrep(),
@@ -134,15 +127,13 @@ void TensorTraceElement(const StackSparseMatrix &a, StackSparseMatrix &c,
                         IsFermion(ls->quanta[bqprime]))
                         scaleb *= -1.;
 
-                    MatrixTensorProduct(
-                        unity, 'n', scaleb, a.operator_element(aq, aqprime),
-                        a.conjugacy(), scale, cel, rowstride, colstride);
+                    MatrixTensorProductIdentityLeft(
+                        bstates, a.operator_element(aq, aqprime), a.conjugacy(),
+                        scale * scaleb, cel, rowstride, colstride);
                     
                 }
             }
-            colstride += cs->unCollectedStateInfo->quantaStates[oldToNewJ[oldj]];
         }
-        rowstride += cs->unCollectedStateInfo->quantaStates[oldToNewI[oldi]];
     }
 }
 
@@ -159,13 +150,12 @@ void TensorTrace(const StackSparseMatrix &a, StackSparseMatrix &c,
         c.get_nonZeroBlocks();
 
     int quanta_thrds = dmrginp.quanta_thrds();
-#pragma omp parallel for schedule(dynamic) num_threads(quanta_thrds)
-    for (int index = 0; index < nonZeroBlocks.size(); index++) {
+    parallelQuanta(nonZeroBlocks.size(), quanta_thrds, [&](int index, int slot) {
         int cq = nonZeroBlocks[index].first.first,
             cqprime = nonZeroBlocks[index].first.second;
         TensorTraceElement(a, c, state_info,
             nonZeroBlocks[index].second, cq, cqprime, trace_right, scale);
-    }
+    });
     
 }
     
@@ -278,22 +268,21 @@ void TensorProductElement(const StackSparseMatrix &a, const StackSparseMatrix &b
         rketS = ketstateinfo->rightStateInfo;
     }
 
-    const std::vector<int> &oldToNewI = brastateinfo->oldToNewState.at(cq);
-    const std::vector<int> &oldToNewJ = ketstateinfo->oldToNewState.at(cqprime);
+    assert(brastateinfo->collectedStart.size() == brastateinfo->quanta.size() + 1);
+    assert(ketstateinfo->collectedStart.size() == ketstateinfo->quanta.size() + 1);
 
     const char conjC = 'n';
 
-    int rowstride = 0, colstride = 0;
-
     int aq, aqprime, bq, bqprime;
 
-    for (int oldi = 0; oldi < oldToNewI.size(); oldi++) {
-        colstride = 0;
-        for (int oldj = 0; oldj < oldToNewJ.size(); oldj++) {
-            aq = brastateinfo->leftUnMapQuanta[oldToNewI[oldi]];
-            aqprime = ketstateinfo->leftUnMapQuanta[oldToNewJ[oldj]];
-            bq = brastateinfo->rightUnMapQuanta[oldToNewI[oldi]];
-            bqprime = ketstateinfo->rightUnMapQuanta[oldToNewJ[oldj]];
+    for (int oldi = brastateinfo->collectedStart[cq]; oldi < brastateinfo->collectedStart[cq + 1]; oldi++) {
+        const int rowstride = brastateinfo->collectedOffset[oldi];
+        for (int oldj = ketstateinfo->collectedStart[cqprime]; oldj < ketstateinfo->collectedStart[cqprime + 1]; oldj++) {
+            const int colstride = ketstateinfo->collectedOffset[oldj];
+            aq = brastateinfo->collectedLeft[oldi];
+            aqprime = ketstateinfo->collectedLeft[oldj];
+            bq = brastateinfo->collectedRight[oldi];
+            bqprime = ketstateinfo->collectedRight[oldj];
 
             double scaleA = scale;
             double scaleB = 1.0;
@@ -330,9 +319,7 @@ void TensorProductElement(const StackSparseMatrix &a, const StackSparseMatrix &b
                     scaleA, b.operator_element(bq, bqprime),
                     b.conjugacy(), scaleB, cel, rowstride, colstride);
             }
-            colstride += ketstateinfo->unCollectedStateInfo->quantaStates[oldToNewJ[oldj]];
         }
-        rowstride += brastateinfo->unCollectedStateInfo->quantaStates[oldToNewI[oldi]];
     }
 }
 
@@ -348,16 +335,36 @@ void TensorProduct(const StackSparseMatrix &a, const StackSparseMatrix &b, Stack
         c.get_nonZeroBlocks();
 
     int quanta_thrds = dmrginp.quanta_thrds();
-#pragma omp parallel for schedule(dynamic) num_threads(quanta_thrds)
-    for (int index = 0; index < nonZeroBlocks.size(); index++) {
+    parallelQuanta(nonZeroBlocks.size(), quanta_thrds, [&](int index, int slot) {
         int cq = nonZeroBlocks[index].first.first,
             cqprime = nonZeroBlocks[index].first.second;
         TensorProductElement(a, b, c, state_info, 
             nonZeroBlocks[index].second, cq, cqprime, scale);
-    }
+    });
 
 }
     
+void TensorProductBatch(const vector<vector<TensorProductTerm>> &terms, const vector<StackSparseMatrix *> &c,
+                        const vector<boost::shared_ptr<StateInfo>> &state_info) {
+    
+    assert(terms.size() == c.size());
+    
+    // the quanta loops inside TensorProduct and TensorTrace
+    // become tasks of this loop's team
+    int thrds = dmrginp.quanta_thrds();
+#pragma omp parallel for schedule(dynamic) num_threads(thrds) if (c.size() > 1)
+    for (int i = 0; i < c.size(); i++)
+        for (int j = 0; j < terms[i].size(); j++) {
+            const TensorProductTerm &t = terms[i][j];
+            if (t.a == 0)
+                TensorTrace(*t.b, *c[i], state_info, false, t.scale);
+            else if (t.b == 0)
+                TensorTrace(*t.a, *c[i], state_info, true, t.scale);
+            else
+                TensorProduct(*t.a, *t.b, *c[i], state_info, t.scale);
+        }
+    
+}
 
 void Product(const StackSparseMatrix &a, const StackSparseMatrix &b, const StackSparseMatrix &c,
              const StateInfo &state_info, double scale) {
@@ -498,8 +505,7 @@ void TensorRotate(const StackSparseMatrix &a, StackSparseMatrix &c,
     assert(new_kets->quanta.size() == new_to_old_map_ket.size());
     
     int quanta_thrds = dmrginp.quanta_thrds();
-#pragma omp parallel for schedule(dynamic) num_threads(quanta_thrds)
-    for (int index = 0; index < nonZeroBlocks.size(); index++) {
+    parallelQuanta(nonZeroBlocks.size(), quanta_thrds, [&](int index, int slot) {
         int cq = nonZeroBlocks[index].first.first,
             cqprime = nonZeroBlocks[index].first.second;
         int q = new_to_old_map_bra[cq],
@@ -510,7 +516,7 @@ void TensorRotate(const StackSparseMatrix &a, StackSparseMatrix &c,
         MatrixRotate((*rotate_bra)[q], a.operator_element(q, qprime),
             (*rotate_ket)[qprime], nonZeroBlocks[index].second, a.conjugacy(), factor);
         
-    }
+    });
     
 }
     
@@ -518,9 +524,10 @@ void TensorRotate(const StackSparseMatrix &a, StackSparseMatrix &c,
 // v = (lq) a(left) .(lq') c .(rq') b(right) (rq)
 // ket state info = c state info in lq' x rq'
 // bra state info = v staet info in lq x rq
-void TensorProductMultiply(const StackSparseMatrix &a, const StackSparseMatrix &b,
-                    const StackWavefunction &c, StackWavefunction &v,
-                    const vector<boost::shared_ptr<StateInfo>> &state_info, const SpinQuantum op_q, double scale) {
+TensorProductMultiplyPlan::TensorProductMultiplyPlan(
+    const StackSparseMatrix &a, const StackSparseMatrix &b,
+    const StackWavefunction &c, const StackWavefunction &v,
+    const vector<boost::shared_ptr<StateInfo>> &state_info, const SpinQuantum op_q) {
     
     const StateInfo *brastateinfo, *ketstateinfo;
     
@@ -531,11 +538,6 @@ void TensorProductMultiply(const StackSparseMatrix &a, const StackSparseMatrix &
         ketstateinfo = state_info[1].get();
     }
     
-    const int leftBraOpSz = brastateinfo->leftStateInfo->quanta.size();
-    const int leftKetOpSz = ketstateinfo->leftStateInfo->quanta.size();
-    const int rightBraOpSz = brastateinfo->rightStateInfo->quanta.size();
-    const int rightKetOpSz = ketstateinfo->rightStateInfo->quanta.size();
-
     const StateInfo *lbraS = brastateinfo->leftStateInfo,
                     *rbraS = brastateinfo->rightStateInfo;
     const StateInfo *lketS = ketstateinfo->leftStateInfo,
@@ -543,8 +545,6 @@ void TensorProductMultiply(const StackSparseMatrix &a, const StackSparseMatrix &
 
     const StackSparseMatrix &leftOp = a;
     const StackSparseMatrix &rightOp = b;
-    const char leftConj = a.conjugacy();
-    const char rightConj = b.conjugacy();
     const std::vector<std::pair<std::pair<int, int>, StackMatrix>>
         &nonZeroBlocks = v.get_nonZeroBlocks();
     
@@ -555,23 +555,10 @@ void TensorProductMultiply(const StackSparseMatrix &a, const StackSparseMatrix &
         assert(rbraS->quanta.size() == rightOp.nrows() && rketS->quanta.size() == rightOp.ncols());
     }
 
-    long long maxlen = 0;
-    for (int lQ = 0; lQ < leftBraOpSz; lQ++)
-        for (int rQPrime = 0; rQPrime < rightKetOpSz; rQPrime++)
-            if (maxlen <
-                (long long) lbraS->getquantastates(lQ) * rketS->getquantastates(rQPrime))
-                maxlen = (long long) lbraS->getquantastates(lQ) *
-                         rketS->getquantastates(rQPrime);
-    
-    int quanta_thrds = dmrginp.quanta_thrds();
-
-    double *dataArray[quanta_thrds];
-    for (int q = 0; q < quanta_thrds; q++) {
-        dataArray[q] = block2::current_page->allocate(maxlen);
-    }
-
-#pragma omp parallel for schedule(dynamic) num_threads(quanta_thrds)
+    max_len = 0;
+    block_start.reserve(nonZeroBlocks.size() + 1);
     for (int index = 0; index < nonZeroBlocks.size(); index++) {
+        block_start.push_back(factors.size());
         int lQ = nonZeroBlocks[index].first.first,
             rQ = nonZeroBlocks[index].first.second;
 
@@ -583,14 +570,9 @@ void TensorProductMultiply(const StackSparseMatrix &a, const StackSparseMatrix &
             for (int l = 0; l < rowinds.size(); l++) {
                 int lQPrime = rowinds[l];
                 if (leftOp.allowed(lQ, lQPrime)) {
-    
-                    StackMatrix m(dataArray[omprank],
-                                  lketS->getquantastates(lQPrime),
-                                  rbraS->getquantastates(rQ));
 
-                    double factor =
-                        scale * leftOp.get_scaling(lbraS->quanta[lQ],
-                                                   lketS->quanta[lQPrime]);
+                    double factor = leftOp.get_scaling(lbraS->quanta[lQ],
+                                                       lketS->quanta[lQPrime]);
                     factor *= dmrginp.get_ninej()(
                         lketS->quanta[lQPrime].get_s().getirrep(),
                         rketS->quanta[rQPrime].get_s().getirrep(),
@@ -616,22 +598,106 @@ void TensorProductMultiply(const StackSparseMatrix &a, const StackSparseMatrix &
                     factor *= rightOp.get_scaling(rbraS->quanta[rQ],
                                                   rketS->quanta[rQPrime]);
                     
-                    MatrixMultiply(c.operator_element(lQPrime, rQPrime), 'n',
-                                   rightOp.operator_element(rQ, rQPrime),
-                                   TransposeOf(rightOp.conjugacy()), m, 1.0,
-                                   0.);
-                    MatrixMultiply(leftOp.operator()(lQ, lQPrime), leftConj, m,
-                                   'n', v.operator_element(lQ, rQ),
-                                   factor * parity);
+                    l_q.push_back(lQ);
+                    r_q.push_back(rQ);
+                    l_q_prime.push_back(lQPrime);
+                    r_q_prime.push_back(rQPrime);
+                    m_rows.push_back(lketS->getquantastates(lQPrime));
+                    m_cols.push_back(rbraS->getquantastates(rQ));
+                    factors.push_back(factor * parity);
+                    if (max_len < (long long) m_rows.back() * m_cols.back())
+                        max_len = (long long) m_rows.back() * m_cols.back();
                 }
             }
         }
     }
+    block_start.push_back(factors.size());
+}
+
+void TensorProductMultiplyPlan::multiply(const StackSparseMatrix &a, const StackSparseMatrix &b,
+                                         const StackWavefunction &c, StackWavefunction &v,
+                                         double scale) const {
+    
+    if (factors.size() == 0)
+        return;
+    
+    const StackSparseMatrix &leftOp = a;
+    const StackSparseMatrix &rightOp = b;
+    const char leftConj = a.conjugacy();
+    
+    int quanta_thrds = dmrginp.quanta_thrds();
+
+    std::vector<double *> dataArray(quanta_thrds);
+    for (int q = 0; q < quanta_thrds; q++) {
+        dataArray[q] = block2::current_page->allocate(max_len);
+    }
+
+    parallelQuanta((int) block_start.size() - 1, quanta_thrds, [&](int index, int slot) {
+        for (int i = block_start[index]; i < block_start[index + 1]; i++) {
+            
+            StackMatrix m(dataArray[slot], m_rows[i], m_cols[i]);
+            
+            MatrixMultiply(c.operator_element(l_q_prime[i], r_q_prime[i]), 'n',
+                           rightOp.operator_element(r_q[i], r_q_prime[i]),
+                           TransposeOf(rightOp.conjugacy()), m, 1.0,
+                           0.);
+            MatrixMultiply(leftOp.operator()(l_q[i], l_q_prime[i]), leftConj, m,
+                           'n', v.operator_element(l_q[i], r_q[i]),
+                           scale * factors[i]);
+        }
+    });
+
+    for (int q = quanta_thrds - 1; q > -1; q--) {
+        block2::current_page->deallocate(dataArray[q], max_len);
+    }
+}
+
+void TensorProductMultiplyPlan::multiply_batch(const StackSparseMatrix &a, const StackSparseMatrix &b,
+                                               const vector<const StackWavefunction *> &c,
+                                               const vector<StackWavefunction *> &v,
+                                               double scale) const {
+    
+    assert(c.size() == v.size());
+    if (factors.size() == 0 || c.size() == 0)
+        return;
+    
+    const StackSparseMatrix &leftOp = a;
+    const StackSparseMatrix &rightOp = b;
+    const char leftConj = a.conjugacy();
+    
+    int quanta_thrds = dmrginp.quanta_thrds();
+
+    std::vector<double *> dataArray(quanta_thrds);
+    for (int q = 0; q < quanta_thrds; q++) {
+        dataArray[q] = block2::current_page->allocate(max_len);
+    }
+
+    parallelQuanta((int) block_start.size() - 1, quanta_thrds, [&](int index, int slot) {
+        for (int i = block_start[index]; i < block_start[index + 1]; i++) {
+            
+            StackMatrix m(dataArray[slot], m_rows[i], m_cols[i]);
+            const StackMatrix &bop = rightOp.operator_element(r_q[i], r_q_prime[i]);
+            const StackMatrix &aop = leftOp.operator()(l_q[i], l_q_prime[i]);
+            
+            for (size_t k = 0; k < c.size(); k++) {
+                MatrixMultiply(c[k]->operator_element(l_q_prime[i], r_q_prime[i]), 'n',
+                               bop, TransposeOf(rightOp.conjugacy()), m, 1.0, 0.);
+                MatrixMultiply(aop, leftConj, m, 'n', v[k]->operator_element(l_q[i], r_q[i]),
+                               scale * factors[i]);
+            }
+        }
+    });
 
     for (int q = quanta_thrds - 1; q > -1; q--) {
-        block2::current_page->deallocate(dataArray[q], maxlen);
+        block2::current_page->deallocate(dataArray[q], max_len);
     }
+}
+
+void TensorProductMultiply(const StackSparseMatrix &a, const StackSparseMatrix &b,
+                    const StackWavefunction &c, StackWavefunction &v,
+                    const vector<boost::shared_ptr<StateInfo>> &state_info, const SpinQuantum op_q, double scale) {
     
+    TensorProductMultiplyPlan(a, b, c, v, state_info, op_q).multiply(a, b, c, v, scale);
 }
 
 // MPO (a x I | I x a) act on MPS (c) => MPS (v)
@@ -740,9 +806,9 @@ void TensorScale(double scale, StackSparseMatrix &a) {
         a.get_nonZeroBlocks();
 
     int quanta_thrds = dmrginp.quanta_thrds();
-#pragma omp parallel for schedule(dynamic) num_threads(quanta_thrds)
-    for (int index = 0; index < nonZeroBlocks.size(); index++)
+    parallelQuanta(nonZeroBlocks.size(), quanta_thrds, [&](int index, int slot) {
         MatrixScale(scale, nonZeroBlocks[index].second);
+    });
 
 }
     
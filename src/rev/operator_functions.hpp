@@ -37,6 +37,18 @@ void TensorProductElement(const StackSparseMatrix &a, const StackSparseMatrix &b
 void TensorProduct(const StackSparseMatrix &a, const StackSparseMatrix &b, StackSparseMatrix &c,
                    const vector<boost::shared_ptr<StateInfo>> &state_info, double scale = 1.0);
 
+// one term scale * (A x B) of a batch; a == 0 means I x B (trace_left)
+// and b == 0 means A x I (trace_right)
+struct TensorProductTerm {
+    const StackSparseMatrix *a, *b;
+    double scale;
+};
+
+// C[i] += sum of terms[i] for all i, the outputs in parallel
+// the outputs must be initialized and different from each other
+void TensorProductBatch(const vector<vector<TensorProductTerm>> &terms, const vector<StackSparseMatrix *> &c,
+                        const vector<boost::shared_ptr<StateInfo>> &state_info);
+
 // PRODUCT (no kron product) A x B -> C
 void Product(const StackSparseMatrix &a, const StackSparseMatrix &b, const StackSparseMatrix &c,
              const StateInfo &state_info, double scale);
@@ -51,6 +63,36 @@ void TensorProductMultiply(const StackSparseMatrix &a, const StackSparseMatrix &
                     const StackWavefunction &c, StackWavefunction &v,
                     const vector<boost::shared_ptr<StateInfo>> &state_info, const SpinQuantum op_q, double scale);
 
+// Precomputed (cq, cqprime, aq, bq) block walk and coupling coefficients of
+// TensorProductMultiply. It stays valid as long as the quanta of a, b, c, v
+// and state_info do not change, so it can be built once per site and
+// replayed in every Davidson iteration.
+class TensorProductMultiplyPlan {
+    // entries of v nonzero block i are [block_start[i], block_start[i + 1])
+    vector<int> block_start;
+    vector<int> l_q, r_q, l_q_prime, r_q_prime;
+    // shape of the intermediate C B^T of each entry
+    vector<int> m_rows, m_cols;
+    // coupling factor and fermion parity, without the scale
+    vector<double> factors;
+    long long max_len;
+
+  public:
+    TensorProductMultiplyPlan(const StackSparseMatrix &a, const StackSparseMatrix &b,
+                              const StackWavefunction &c, const StackWavefunction &v,
+                              const vector<boost::shared_ptr<StateInfo>> &state_info,
+                              const SpinQuantum op_q);
+    // V += scale * A C B
+    void multiply(const StackSparseMatrix &a, const StackSparseMatrix &b,
+                  const StackWavefunction &c, StackWavefunction &v, double scale) const;
+    // V[k] += scale * A C[k] B for all k, the C[k] and V[k] having the quanta of
+    // the c and v of the plan. Each operator block is used for all k in turn.
+    void multiply_batch(const StackSparseMatrix &a, const StackSparseMatrix &b,
+                        const vector<const StackWavefunction *> &c,
+                        const vector<StackWavefunction *> &v, double scale) const;
+    int size() const { return factors.size(); }
+};
+
 // TENSOR ACT ON STATE (A x I) C -> V (trace_right) (I x A) C -> V (trace_left)
 void TensorTraceMultiply(const StackSparseMatrix &a, const StackWavefunction &c,
                          StackWavefunction &v, const StateInfo &state_info,
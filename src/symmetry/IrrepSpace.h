@@ -29,20 +29,20 @@ class IrrepSpace
   IrrepSpace() : irrep(0) {}
   explicit IrrepSpace(int ir) : irrep(ir) {}
 
-  void SaveThreadSafe(std::ofstream& ofs) const {ofs.write( (char*)(&irrep), sizeof(irrep));}
-  void LoadThreadSafe(std::ifstream& ifs) {ifs.read( (char*)(&irrep), sizeof(irrep));}
+  void SaveThreadSafe(std::ostream& ofs) const {ofs.write( (char*)(&irrep), sizeof(irrep));}
+  void LoadThreadSafe(std::istream& ifs) {ifs.read( (char*)(&irrep), sizeof(irrep));}
 
   std::vector<IrrepSpace> operator+=(IrrepSpace rhs);
-  bool operator==(IrrepSpace rhs) const;
-  bool operator!=(IrrepSpace rhs) const;
-  bool operator<(IrrepSpace rhs) const;
+  bool operator==(IrrepSpace rhs) const { return irrep == rhs.irrep; }
+  bool operator!=(IrrepSpace rhs) const { return irrep != rhs.irrep; }
+  bool operator<(IrrepSpace rhs) const { return irrep < rhs.irrep; }
   friend std::vector<IrrepSpace> operator+(IrrepSpace lhs, IrrepSpace rhs);
   friend std::vector<IrrepSpace> operator-(IrrepSpace lhs, IrrepSpace rhs);
   friend IrrepSpace operator-(IrrepSpace lhs);
   void Save(std::ofstream &ofs);
   void Load(std::ifstream &ifs);
   friend ostream& operator<<(ostream& os, const IrrepSpace s);
-  int getirrep() const ;
+  int getirrep() const { return irrep; }
 };
 }
 #endif
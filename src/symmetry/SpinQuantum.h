@@ -47,8 +47,8 @@ class SpinQuantum
   SpinQuantum (const int p, const SpinSpace s, const SpinAdapted::IrrepSpace orbS);
   SpinQuantum operator-() const;
 
-  void SaveThreadSafe(std::ofstream& ofs) const ;
-  void LoadThreadSafe(std::ifstream& ifs);
+  void SaveThreadSafe(std::ostream& ofs) const ;
+  void LoadThreadSafe(std::istream& ifs);
 
   /// \return Vector of (Sz type) quantum numbers with Sz=-S ... +S
   vector<SpinQuantum> spinToNonSpin() const;
@@ -58,14 +58,34 @@ class SpinQuantum
   /// \return Clebsch-Gordon sum of quantum numbers (if non-Abelian)
   /// or length-1 vector if Abelian.
   vector<SpinQuantum> operator+ (const SpinQuantum q) const;
+  /// Appends the Clebsch-Gordon sum of self and q to quanta, in the order
+  /// of operator+, without temporary vectors.
+  void sum (const SpinQuantum& q, vector<SpinQuantum>& quanta) const;
   vector<SpinQuantum> operator+ (const vector<SpinQuantum>& q) const;
 
   vector<SpinQuantum> operator- (const SpinQuantum q) const;
   vector<SpinQuantum> operator- (const vector<SpinQuantum>& q) const;
 
-  bool operator== (const SpinQuantum q) const;
-  bool operator!= (const SpinQuantum q) const;
-  bool operator< (const SpinQuantum q) const;
+  /// \return Canonical 64-bit encoding of (particle number, spin, irrep).
+  /// Two quanta are equal iff their keys are, and the keys are ordered like
+  /// operator< while |n|, |2S| < 2^19 and |irrep| < 2^23.
+  unsigned long long key() const
+  {
+    return ((unsigned long long)(particleNumber + (1 << 19)) << 44)
+      | ((unsigned long long)(totalSpin.getirrep() + (1 << 19)) << 24)
+      | (unsigned long long)(orbitalSymmetry.getirrep() + (1 << 23));
+  }
+
+  bool operator== (const SpinQuantum& q) const
+  {
+    return particleNumber == q.particleNumber && totalSpin == q.totalSpin && orbitalSymmetry == q.orbitalSymmetry;
+  }
+  bool operator!= (const SpinQuantum& q) const { return !(*this == q); }
+  bool operator< (const SpinQuantum& q) const
+  {
+    return particleNumber < q.particleNumber || (particleNumber == q.particleNumber && (totalSpin < q.totalSpin ||
+	  (totalSpin == q.totalSpin && orbitalSymmetry < q.orbitalSymmetry)));
+  }
 
   /// \return True if particleNumber is odd..
   friend bool IsFermion (const SpinQuantum q);
@@ -77,12 +97,22 @@ class SpinQuantum
   SpinAdapted::IrrepSpace get_symm() const {return orbitalSymmetry;}
 
   /// \return true if self is contained in (Clebsch-Gordon) sum, s1+s2.
-  bool allow(const SpinQuantum s1, const SpinQuantum s2) const;
+  bool allow(const SpinQuantum& s1, const SpinQuantum& s2) const;
 
 
   static bool can_complement (SpinQuantum q);
   vector<SpinQuantum> get_complement() const;
 };
+
+/// Hash of SpinQuantum::key(), for unordered containers of quanta.
+struct SpinQuantumHash
+{
+  size_t operator() (const SpinQuantum& q) const
+  {
+    unsigned long long k = q.key() * 0x9e3779b97f4a7c15ULL;
+    return (size_t)(k ^ (k >> 32));
+  }
+};
 }  
 
 
@@ -39,12 +39,12 @@ class SpinSpace
   SpinSpace() : irrep(0) {}
   explicit SpinSpace(int ir);
 
-  void SaveThreadSafe(std::ofstream& ofs) const {ofs.write( (char*)(&irrep), sizeof(irrep));}
-  void LoadThreadSafe(std::ifstream& ifs) {ifs.read( (char*)(&irrep), sizeof(irrep));}
+  void SaveThreadSafe(std::ostream& ofs) const {ofs.write( (char*)(&irrep), sizeof(irrep));}
+  void LoadThreadSafe(std::istream& ifs) {ifs.read( (char*)(&irrep), sizeof(irrep));}
   std::vector<SpinSpace> operator+=(SpinSpace rhs);
-  bool operator==(SpinSpace rhs) const;
-  bool operator!=(SpinSpace rhs) const;
-  bool operator<(SpinSpace rhs) const;
+  bool operator==(SpinSpace rhs) const { return irrep == rhs.irrep; }
+  bool operator!=(SpinSpace rhs) const { return irrep != rhs.irrep; }
+  bool operator<(SpinSpace rhs) const { return irrep < rhs.irrep; }
   /// Adds integer irreps in lhs, rhs. 
   /// \return If S2 symmetry (`dmrg.spinAdapted()==true`),  vector |S1-S2| ... S1+S2, else, 
   /// vector of length 1 containing Sz1+Sz2
@@ -57,7 +57,7 @@ class SpinSpace
   void Save(std::ofstream &ofs);
   void Load(std::ifstream &ifs);
   friend std::ostream& operator<<(std::ostream& os, const SpinSpace s);
-  int getirrep() const ;
+  int getirrep() const { return irrep; }
 };
 }
 #endif
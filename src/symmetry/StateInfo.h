@@ -53,9 +53,11 @@ namespace SpinAdapted{
 ///    states before and after renormalization (when some states are thrown out).
 ///    Made using `transform_state`.
 class StateInfo;
-void TensorProduct (StateInfo& a, StateInfo& b, const SpinQuantum q, const int constraint, StateInfo& c, StateInfo* compState=0);
+class FlatWriter;
+class FlatReader;
+void TensorProduct (StateInfo& a, StateInfo& b, const SpinQuantum q, const int constraint, StateInfo& c, StateInfo* compState=0, int envOrbs=-1);
 
-void TensorProduct (StateInfo& a, StateInfo& b, StateInfo& c, const int constraint, StateInfo* compState=0);
+void TensorProduct (StateInfo& a, StateInfo& b, StateInfo& c, const int constraint, StateInfo* compState=0, int envOrbs=-1);
 
 class StateInfo
 {
@@ -66,7 +68,8 @@ class StateInfo
     {
     ar & totalStates & initialised & unBlockedIndex & quanta & quantaStates
        & leftUnMapQuanta & rightUnMapQuanta & allowedQuanta
-      & quantaMap & oldToNewState & hasCollectedQuanta & newQuantaMap;
+      & quantaMap & oldToNewState & hasCollectedQuanta & newQuantaMap
+      & collectedStart & collectedLeft & collectedRight & collectedOffset;
     if (hasCollectedQuanta)
       ar & unCollectedStateInfo;
     ar & hasPreviousStateInfo;
@@ -124,6 +127,12 @@ class StateInfo
   std::vector< std::vector<int> > oldToNewState; //quanta[I] is the same as quanta[Ij] where Ij are the indices inside the Ith vector.
   std::vector<int> newQuantaMap;
 
+  /// @brief Flat form of `oldToNewState` for the tensor product kernels, built by `BuildCollectedIndex`.
+  /// The uncollected quanta of collected quantum I are the entries collectedStart[I] ... collectedStart[I+1]-1,
+  /// with their left and right quanta in `collectedLeft`, `collectedRight`, and the offset of their
+  /// states inside quantum I (counted in the uncollected StateInfo) in `collectedOffset`.
+  std::vector<int> collectedStart, collectedLeft, collectedRight, collectedOffset;
+
   /// flag for StateInfo in valid state
   bool initialised;
  public:
@@ -156,10 +165,13 @@ class StateInfo
   ///        Implemented only
   ///        with `LessThanQ`, only constructs a+b if a+b+compStateQ in q. Usually 0, 
   ///        used only in warmup.
-  friend void TensorProduct (StateInfo& a, StateInfo& b, const SpinQuantum q, const int constraint, StateInfo& c, StateInfo* compState);
+  /// \param[in] envOrbs Number of electrons the orbitals outside a and b can hold, or -1.
+  ///        Implemented only with `LessThanQ`, drops a+b if q can not be reached by adding
+  ///        at most envOrbs electrons (and the spin they can carry).
+  friend void TensorProduct (StateInfo& a, StateInfo& b, const SpinQuantum q, const int constraint, StateInfo& c, StateInfo* compState, int envOrbs);
 
   /// Interface to other TensorProduct function.
-  friend void TensorProduct (StateInfo& a, StateInfo& b, StateInfo& c, const int constraint, StateInfo* compState);
+  friend void TensorProduct (StateInfo& a, StateInfo& b, StateInfo& c, const int constraint, StateInfo* compState, int envOrbs);
 
   friend void makeStateInfo(StateInfo& s, int site);
 
@@ -169,12 +181,20 @@ class StateInfo
   void Free();
   void AllocatePreviousStateInfo ();
   void CollectQuanta();
+  void BuildCollectedIndex();
   void AllocateUnCollectedStateInfo ();
   int getquantastates(int i) {return quantaStates.at(i);}
   int getquantastates(int i) const {return quantaStates.at(i);}
   void UnMapQuantumState (const int QS, const int secondQSTotal, int& firstQS, int& secondQS) const;
   static void restore(bool forward, const vector<int>& sites, StateInfo& states, int state);
   static void store(bool forward, const vector<int>& sites, StateInfo& states, int state);
+  /// The members of `serialize` as a flat metadata record (flatmeta.h), appended to buf,
+  /// for the state files and the MPI broadcasts.
+  void PackFlat(std::vector<char>& buf) const;
+  /// Reads the record of `PackFlat` of n bytes at buf.
+  void UnpackFlat(const char* buf, size_t n);
+  void Pack(FlatWriter& w) const;
+  void Unpack(FlatReader& r);
 
   /// Make type 4. StateInfo
   /// \param[in] rotateMatrix Rotation matrix from DMRG truncation.
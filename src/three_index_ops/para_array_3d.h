@@ -10,6 +10,7 @@ Sandeep Sharma and Garnet K.-L. Chan
 #define THREEPDM_PARA_ARRAY_H
 
 #include <tuple>
+#include <unordered_map>
 #include <vector>
 #include "pario.h"
 //#include <iostream>
@@ -44,11 +45,11 @@ public:
   void clear()
   {
     global_indices_.clear();
-    global_indices_map_.clear();
     local_indices_.clear();
-    local_indices_map_.clear();
-    global_index_tuple_.clear();
-    local_index_tuple_.clear();
+    local_slots_.clear();
+    is_local_.clear();
+    tuples_.clear();
+    slots_.clear();
     store_.clear();
     length_ = 0;
   }
@@ -98,8 +99,8 @@ public:
 
   bool has_global_index(int i, int j, int k, int l=-1) const { return has_global_index( trimap_3d(i,j,k) ); }
   bool has_local_index(int i, int j, int k, int l=-1) const { return has_local_index( trimap_3d(i,j,k) ); }
-  bool has_global_index(int i) const { return (global_indices_map_.at(i) != -1); }
-  bool has_local_index(int i) const { return (local_indices_map_.at(i) != -1); }
+  bool has_global_index(int i) const { return slot(i) != -1; }
+  bool has_local_index(int i) const { int s = slot(i); return s != -1 && is_local_[s]; }
 
   const std::vector<int>& get_indices() const { return global_indices_; }
   const std::vector<int>& get_local_indices() const { return local_indices_; }
@@ -131,7 +132,7 @@ public:
     assert( has(i,j,k) );
     if (!stored_local_)
       assert( has_local_index( trimap_3d(i,j,k) ) );
-    return store_.at( trimap_3d(i,j,k) );
+    return store_.at( slot(trimap_3d(i,j,k)) );
   }
 
   const T& operator()(int i, int j, int k, int l=-1) const
@@ -141,28 +142,28 @@ public:
     assert(has(i,j,k));
     if (!stored_local_)
       assert( has_local_index( trimap_3d(i,j,k) ) );
-    return store_.at(trimap_3d(i,j,k));
+    return store_.at( slot(trimap_3d(i,j,k)) );
   }
 
 //-----------------------------------------------------------------------------------------------------------------------------------------------------------
 
   /// ith element of local storage
-  T& get_local_element(int i) { return store_.at( local_indices_.at(i) ); }
-  const T& get_local_element(int i) const { return store_.at( local_indices_.at(i) ); }
+  T& get_local_element(int i) { return store_.at( local_slots_.at(i) ); }
+  const T& get_local_element(int i) const { return store_.at( local_slots_.at(i) ); }
 
   /// ith element of global storage
-  T& get_global_element(int i) { return store_.at( global_indices_.at(i) ); }
-  const T& get_global_element(int i) const { return store_.at( global_indices_.at(i) ); }
+  T& get_global_element(int i) { return store_.at(i); }
+  const T& get_global_element(int i) const { return store_.at(i); }
 
   T& get(const std::vector<int>& orbs) { return (*this)(orbs[0], orbs[1], orbs[2]); }
 
 //-----------------------------------------------------------------------------------------------------------------------------------------------------------
 
   /// returns i,j,k for ith element of global storage
-  std::vector<int> unmap_global_index(int i) { return global_index_tuple_.at(i); }
+  std::vector<int> unmap_global_index(int i) { return element_tuple(i); }
 
   /// returns i,j,k for ith element of local storage
-  const std::vector<int> unmap_local_index(int i) const { return local_index_tuple_.at(i); }
+  const std::vector<int> unmap_local_index(int i) const { return element_tuple( local_slots_.at(i) ); }
 
 //-----------------------------------------------------------------------------------------------------------------------------------------------------------
 
@@ -177,15 +178,8 @@ public:
 
   void add_local_indices(int i, int j, int k)
   {
-    int index = trimap_3d(i,j,k);
-    std::vector<int> tuple = { i,j,k };
-    local_indices_.push_back(index);
-    local_indices_map_.at(index) = index;
-    local_index_tuple_.push_back( tuple );
     //FIXME MAW also update global, even though this wasn't done before
-    global_indices_.push_back(index);
-    global_indices_map_.at(index) = index;
-    global_index_tuple_.push_back( tuple );
+    add_element( std::vector<int>{ i,j,k }, true );
   }
 
 //-----------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -199,53 +193,20 @@ public:
     clear();
     length_ = len;
 
+    // one element of store_ per occupied tuple, nothing for the rest of the
+    // canonical index range
+    global_indices_.reserve( occupied.size() );
+    tuples_.reserve( 3 * occupied.size() );
+    is_local_.reserve( occupied.size() );
+    store_.reserve( occupied.size() );
     for (auto it = occupied.begin(); it != occupied.end(); ++it) {
       std::vector<int> tuple = { std::get<0>(it->first), std::get<1>(it->first), std::get<2>(it->first) };
       int rank = it->second; 
-      // Global indices
-      int idx = trimap_3d( tuple[0], tuple[1], tuple[2] );
-      global_indices_.push_back( idx );
-      global_index_tuple_.push_back( tuple );
-      // Local indices
-      if ( stored_local_ || rank == mpigetrank() ) {
-        // Assign to requested rank
-        local_indices_.push_back( idx );
-        local_index_tuple_.push_back( tuple );
-      }
-      else if ( rank == -1 ) {
-        // Load balance equally over ranks using global rule
-        if ( processorindex( idx ) == mpigetrank() ) {
-          local_indices_.push_back( idx );
-          local_index_tuple_.push_back( tuple );
-        }
-      }
+      // Assign to requested rank, or load balance equally over ranks using global rule
+      bool local = stored_local_ || rank == mpigetrank() ||
+                   ( rank == -1 && processorindex( trimap_3d(tuple[0], tuple[1], tuple[2]) ) == mpigetrank() );
+      add_element( tuple, local );
     }
-
-    // Global indices map
-    int length_1d = tristore_3d(len);
-    global_indices_map_.resize(length_1d);
-    for (int i=0; i < length_1d; ++i) {
-      global_indices_map_.at(i) = -1;
-    }
-    for (int i=0; i < global_indices_.size(); ++i) {
-      global_indices_map_.at( global_indices_.at(i) ) = global_indices_.at(i);
-    }
-    store_.resize(length_1d);
-
-    // Local indices map
-    local_indices_map_.resize(length_1d);
-    for (int i=0; i < length_1d; ++i) {
-      local_indices_map_.at(i) = -1;
-    }
-    for (int i=0; i < local_indices_.size(); ++i) {
-      local_indices_map_.at( local_indices_.at(i) ) = local_indices_.at(i);
-    }
-
-//if (stored_local_) pout << "3-index stored_local = true!\n";
-//for (auto it = local_index_tuple_.begin(); it != local_index_tuple_.end(); ++it) {
-//  pout << "para_array, p" << mpigetrank() << ": " << it->at(0) << "," << it->at(1) << "," << it->at(2) << "; local_size = " << local_indices_.size()<<endl;
-//}
-
   }
 
 //-----------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -253,35 +214,30 @@ public:
 private:
 
 //-----------------------------------------------------------------------------------------------------------------------------------------------------------
-//  /**
-//   * having filled out the global indices, assign indices
-//   * to individual processors (i.e. local indices)
-//   */
-//  void setup_local_indices( const std::map< std::tuple<int,int,int>, int >& occupied)
-//  {
-//    int length_1d = tristore_3d(length_);
-//    if (stored_local_) {
-//      abort();
-////      local_indices_ = global_indices_;
-////      local_indices_map_ = global_indices_map_;
-////      local_index_tuple_ = global_index_tuple_;
-////    }
-//    else {
-//      local_indices_map_.resize(length_1d);
-//      for (int p = 0; p < length_1d; ++p) local_indices_map_.at(p) = -1;
-//
-//      for (int p = 0; p < global_indices_.size(); ++p) {
-//       
-//
-//        if ( processorindex(global_indices_[p]) == mpigetrank() ) {
-//          local_indices_.push_back(global_indices_.at(p));
-//          local_indices_map_.at(global_indices_.at(p)) = global_indices_.at(p);
-//          local_index_tuple_.push_back(global_index_tuple_.at(p));
-//        }
-//
-//      }
-//    }
-//  }
+
+  /// position in store_ of the element with 1d index i, or -1
+  int slot(int i) const
+  {
+    std::unordered_map<int,int>::const_iterator it = slots_.find(i);
+    return it == slots_.end() ? -1 : it->second;
+  }
+
+  std::vector<int> element_tuple(int s) const { return std::vector<int>( tuples_.begin() + 3*s, tuples_.begin() + 3*(s+1) ); }
+
+  void add_element(const std::vector<int>& tuple, bool local)
+  {
+    int idx = trimap_3d( tuple[0], tuple[1], tuple[2] );
+    int s = store_.size();
+    slots_[idx] = s;
+    global_indices_.push_back( idx );
+    tuples_.insert( tuples_.end(), tuple.begin(), tuple.end() );
+    is_local_.push_back( local );
+    store_.push_back( T() );
+    if (local) {
+      local_indices_.push_back( idx );
+      local_slots_.push_back( s );
+    }
+  }
 
 //-----------------------------------------------------------------------------------------------------------------------------------------------------------
 
@@ -292,20 +248,28 @@ private:
     ar & stored_local_
        & length_
        & global_indices_
-       & global_indices_map_
        & local_indices_
-       & local_indices_map_
-       & global_index_tuple_
-       & local_index_tuple_
+       & local_slots_
+       & is_local_
+       & tuples_
        & store_;
+    if (Archive::is_loading::value) {
+      slots_.clear();
+      for (int s = 0; s < global_indices_.size(); ++s)
+        slots_[ global_indices_[s] ] = s;
+    }
   }
 
+  // store_ holds the occupied elements only, in the order of global_indices_
+  // (their 1d indices). tuples_ has the 3 orbital indices of each of them,
+  // is_local_ whether this rank owns it, and local_slots_ the positions of
+  // the local ones; slots_ maps a 1d index to its position in store_.
   std::vector<int> global_indices_;
-  std::vector<int> global_indices_map_;
   std::vector<int> local_indices_;
-  std::vector<int> local_indices_map_;
-  std::vector<std::vector<int> > global_index_tuple_;
-  std::vector<std::vector<int> > local_index_tuple_;
+  std::vector<int> local_slots_;
+  std::vector<char> is_local_;
+  std::vector<int> tuples_;
+  std::unordered_map<int,int> slots_;
   std::vector<T> store_;
   bool stored_local_;
   int length_;
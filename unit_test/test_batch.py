@@ -0,0 +1,52 @@
+
+from pyblock.legacy.batch import run_batch, job_input
+
+import pytest
+import json
+import os
+
+@pytest.fixture
+def data_dir(request):
+    filename = request.module.__file__
+    return os.path.join(os.path.dirname(filename), 'data')
+
+N2_CONF = """sym d2h
+orbitals FCIDUMP
+nelec 14
+spin 0
+hf_occ integral
+schedule
+0 250 1e-6 1e-6
+4 250 1e-8 0
+end
+twodot
+maxiter 8
+sweep_tol 1e-7
+memory 1 g
+"""
+
+class TestBatch:
+    
+    def test_job_input(self, tmp_path):
+        conf = os.path.join(str(tmp_path), 'dmrg.conf')
+        with open(conf, 'w') as f:
+            f.write(N2_CONF + 'prefix /tmp\n')
+        lines = job_input(conf, 'A.FCIDUMP', str(tmp_path / 'job0'), 2).splitlines()
+        assert lines.count('orbitals %s' % os.path.abspath('A.FCIDUMP')) == 1
+        assert sum(l.startswith('orbitals') for l in lines) == 1
+        assert sum(l.startswith('prefix') for l in lines) == 1
+        assert 'num_thrds 2' in lines
+    
+    def test_n2_batch(self, data_dir, tmp_path):
+        conf = os.path.join(str(tmp_path), 'dmrg.conf')
+        with open(conf, 'w') as f:
+            f.write(N2_CONF)
+        fcidump = os.path.join(data_dir, 'N2.STO3G.FCIDUMP')
+        output = os.path.join(str(tmp_path), 'results.json')
+        results = list(run_batch([(fcidump, conf)] * 3, str(tmp_path), n_workers=2, output=output))
+        assert sorted(r['job'] for r in results) == [0, 1, 2]
+        for r in results:
+            assert 'error' not in r
+            assert abs(r['energies'][0] - (-107.648250974014)) < 5E-6
+        with open(output, 'r') as f:
+            assert [json.loads(l) for l in f] == results
@@ -1,5 +1,5 @@
 
-from pyblock.numerical.davidson import Vector, Matrix, davidson
+from pyblock.numerical.davidson import Vector, Matrix, davidson, block_davidson
 
 import numpy as np
 import pytest
@@ -50,3 +50,23 @@ class TestDavidson:
             for ik in range(k):
                 assert np.linalg.norm(v[:, ik] - nb[ik].data) / n < 1E-3 \
                     or np.linalg.norm(v[:, ik] + nb[ik].data) / n < 1E-3
+
+    def test_block_random(self):
+        
+        for _ in range(4):
+            n = np.random.randint(400, 1500)
+            k = np.random.randint(1, 5)
+
+            a = np.random.random((n, n))
+            a = (a + a.T) / 2
+
+            b = [Vector(ib) for ib in np.eye(k, n)]
+
+            ld, nb, _ = block_davidson(Matrix(a), b, k, deflation_max_size=max(5, 3 * k + 10), max_iter=n * 2)
+            e, v = np.linalg.eigh(a)
+
+            assert len(ld) == k
+            assert np.allclose(e[:k], ld, atol=1E-6)
+            for ik in range(k):
+                assert np.linalg.norm(v[:, ik] - nb[ik].data) / n < 1E-3 \
+                    or np.linalg.norm(v[:, ik] + nb[ik].data) / n < 1E-3
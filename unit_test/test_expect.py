@@ -96,8 +96,30 @@ class TestExpect:
                 ex = Expect(xmpo, mps0, mps0, mps0.form, None, contractor=xctr)
                 ex.solve(forward=dmrg.forward, bond_dim=bdims)
                 assert np.allclose(ex.results, xstd, atol=1E-6)
+
+            # variance of the converged state, without the squared MPO
+            ctr.mps_info = copy.deepcopy(mps_info)
+            mps0 = copy.deepcopy(mps00)
+            ex = Expect(mpo, mps0, mps0, mps0.form, None, contractor=ctr, variance=True)
+            ex.solve(forward=dmrg.forward, bond_dim=bdims)
+            assert np.allclose(ex.results, ress[0], atol=1E-6)
+            assert len(ex.variances) == len(ex.results)
+            assert np.all(np.abs(ex.variances) <= 1E-5)
+
+            # all MPOs in one sweep
+            names = ['H', 'I', 'N', 'LN', 'NN']
+            multi_info = copy.deepcopy(mps_info)
+            for xctr in ctrs:
+                xctr.mps_info = multi_info
+            mps0 = copy.deepcopy(mps00)
+            ex = Expect(dict(zip(names, mpos)), mps0, mps0, mps0.form, None,
+                        contractor=dict(zip(names, ctrs)))
+            ex.solve(forward=dmrg.forward, bond_dim=bdims)
+            for r in ex.results:
+                for name, xstd in zip(names, ress):
+                    assert abs(r[name] - xstd) <= 1E-6
         page.clean()
-    
+
     def test_hubbard_ancilla_expect(self, data_dir, tmp_path, dot_scheme):
         fcidump = 'HUBBARD-L8-U2.FCIDUMP'
         pg = 'c1'
@@ -1,8 +1,9 @@
 
-from pyblock.qchem.fcidump import TInt, VInt, read_fcidump
+from pyblock.qchem.fcidump import TInt, VInt, read_fcidump, read_integral_cache
 
 import numpy as np
 import pytest
+import shutil
 import os
 
 @pytest.fixture
@@ -38,6 +39,34 @@ class TestInt:
             assert np.isclose(v[k, l, j, i], v[i, j, k, l])
             assert np.isclose(v[l, k, j, i], v[i, j, k, l])
 
+    def test_bulk_access(self):
+        n = 6
+        t = TInt(n)
+        v = VInt(n)
+        t.data = np.random.random(t.data.shape)
+        v.data = np.random.random(v.data.shape) * (np.random.random(v.data.shape) > 0.5)
+        ft = t.unpack()
+        fv = v.unpack()
+        assert np.allclose(ft, ft.T)
+        assert np.allclose(fv, fv.transpose(1, 0, 2, 3))
+        assert np.allclose(fv, fv.transpose(2, 3, 0, 1))
+        for i, j, k, l in np.ndindex(fv.shape):
+            assert fv[i, j, k, l] == v[i, j, k, l]
+        sites = np.arange(n)
+        assert np.allclose(t.gather(sites, 2), ft[:, 2])
+        assert np.allclose(v.gather(sites[:, None], 2, sites[None, :], 2), fv[:, 2, :, 2])
+        t[0, 1] = 2.0
+        assert t.unpack()[1, 0] == 2.0
+        part = [1, 3, 4]
+        i, j, k, l, x = v.nonzero(part)
+        assert np.all(np.isin(i, part)) and np.all(np.isin(l, part))
+        assert np.allclose(x, fv[i, j, k, l])
+        assert len(x) == len(set(zip(i, j, k, l))) == np.sum(np.abs(x) > 1E-13)
+        nz = {tuple(sorted([tuple(sorted(p, reverse=True)) for p in [(a, b), (c, d)]], reverse=True))
+              for a, b, c, d in np.ndindex(fv.shape)
+              if a in part and b in part and c in part and d in part and fv[a, b, c, d] != 0}
+        assert {(tuple(p), tuple(q)) for p, q in zip(zip(i, j), zip(k, l))} == nz
+
 class TestFCIDUMP:
     
     def test_read_fcidump(self, data_dir):
@@ -74,3 +103,22 @@ class TestFCIDUMP:
             l = np.random.randint(n)
             if i != j or j != k or k != l:
                 assert np.isclose(vb[i, j, k, l], 0)
+
+    def test_integral_cache(self, data_dir, tmp_path):
+        
+        src = os.path.join(str(tmp_path), 'FCIDUMP')
+        shutil.copy(os.path.join(data_dir, 'N2.STO3G.FCIDUMP'), src)
+        cont_dict_a, (ta, va, ea) = read_fcidump(src)
+        cont_dict_b, (tb, vb, eb) = read_fcidump(src, cache=True)
+        assert os.path.isfile(src + '.cache')
+        cont_dict_c, (tc, vc, ec) = read_fcidump(src, cache=True)
+        assert isinstance(vc.data, np.memmap)
+        assert cont_dict_a == cont_dict_c
+        assert ta == tc
+        assert va == vc
+        assert ea == ec
+        
+        # the cache belongs to the FCIDUMP as it was when it was written
+        with open(src, 'a') as f:
+            f.write('\n')
+        assert read_integral_cache(src + '.cache', src) is None
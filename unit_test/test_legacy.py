@@ -1,6 +1,8 @@
 
 from pyblock.qchem import BlockHamiltonian, MPS, MPSInfo, LineCoupling
 from pyblock.legacy.block_dmrg import DMRG as BLOCK_DMRG
+from block import metrics
+from block.dmrg import Session
 
 import pytest
 import os
@@ -61,3 +63,28 @@ class TestBlockDMRG:
             assert abs(ener - (-107.648250974014)) < 5E-6
         if os.path.isdir('node0'):
             shutil.rmtree('node0')
+    
+    def test_session_metrics(self, data_dir, tmp_path):
+        conf = os.path.join(str(tmp_path), 'dmrg.conf')
+        with open(conf, 'w') as f:
+            f.write('sym d2h\norbitals %s\nnelec 14\nspin 0\nhf_occ integral\n'
+                    'schedule\n0 250 1e-6 1e-6\n4 250 1e-8 0\nend\ntwodot\n'
+                    'maxiter 8\nsweep_tol 1e-7\nmemory 1 g\nprefix %s\n'
+                    % (os.path.join(data_dir, self.fcidump), str(tmp_path)))
+        seen = []
+        metrics.enable()
+        metrics.clear()
+        metrics.set_callback(lambda p: seen.append(p.energy))
+        session = Session()
+        ener = session.run(conf)
+        assert abs(ener[0] - (-107.648250974014)) < 5E-6
+        ener = session.run(conf, same_integrals=True)
+        assert abs(ener[0] - (-107.648250974014)) < 5E-6
+        session.close()
+        metrics.set_callback(None)
+        metrics.enable(False)
+        history = metrics.history()
+        assert len(history) == len(seen) > 0
+        assert all(p.davidson_iterations > 0 and p.wall_time >= 0 for p in history)
+        assert metrics.latest().energy == history[-1].energy
+        assert abs(min(seen) - (-107.648250974014)) < 5E-6
@@ -6,6 +6,8 @@ from pyblock.symmetry.symmetry import SU2, ParticleN, PGD2H
 import numpy as np
 import pytest
 import os
+import copy
+import pickle
 from fractions import Fraction
 
 @pytest.fixture
@@ -73,3 +75,28 @@ class TestMPS:
                     rot_mat = info.get_right_rotation_matrix(i, mps[i])
                     mpsx = info.from_right_rotation_matrix(i, rot_mat)
                     assert mpsx == mps[i]
+    
+    def test_mps_info_pickle(self, data_dir):
+        fcidump = 'C2.BLOCK.FCIDUMP'
+        pg = 'd2h'
+        with BlockHamiltonian.get(os.path.join(data_dir, fcidump), pg, su2=True, output_level=-1,
+                                  memory=1200) as hamil:
+            lcp = LineCoupling(hamil.n_sites, hamil.site_basis, hamil.empty, hamil.target)
+            lcp.set_bond_dimension(22)
+            mps = MPS(lcp, center=0, dot=2)
+            mps.randomize()
+            mps.canonicalize()
+            info = MPSInfo(lcp)
+            infox = pickle.loads(pickle.dumps(info))
+            infoy = copy.deepcopy(info)
+            for x in [infox, infoy]:
+                for i in range(hamil.n_sites):
+                    for a, b in [(info.left_state_info[i], x.left_state_info[i]),
+                                 (info.right_state_info[i], x.right_state_info[i]),
+                                 (info.left_state_info_no_trunc[i], x.left_state_info_no_trunc[i])]:
+                        assert repr(a) == repr(b)
+                        assert repr(a.left_state_info) == repr(b.left_state_info)
+                        assert repr(a.right_state_info) == repr(b.right_state_info)
+                for i in range(0, hamil.n_sites - 2):
+                    rot_mat = info.get_left_rotation_matrix(i, mps[i])
+                    assert x.from_left_rotation_matrix(i, rot_mat) == info.from_left_rotation_matrix(i, rot_mat)
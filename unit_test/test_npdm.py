@@ -2,7 +2,8 @@
 from pyblock.qchem import BlockHamiltonian, DMRGContractor
 from pyblock.qchem import DMRGDataPage, Simplifier, AllRules, PDM1Rules
 from pyblock.qchem import LineCoupling, MPSInfo, MPOInfo, MPS, MPO
-from pyblock.qchem.npdm import PDM1MPOInfo, PDM1MPO
+from pyblock.qchem.npdm import PDM1MPOInfo, PDM1MPO, NPDMTiles
+from pyblock.qchem.npdm.tiles import TILE_MAGIC, TILE_HEADER
 from pyblock.qchem.operator import OpNames
 from pyblock.algorithm import Expect, DMRG
 
@@ -11,6 +12,7 @@ import pytest
 import fractions
 import os
 import copy
+import struct
 
 @pytest.fixture
 def data_dir(request):
@@ -96,3 +98,35 @@ class TestNPDM:
                         assert abs(dm[i, j] - dm_std[(i, j)]) < 5E-4
             
         page.clean()
+
+    def test_npdm_tiles(self, tmp_path):
+        # 3PDM of 2 orbitals: one empty, one sparse and one dense tile, rest empty
+        n = 2
+        dm = np.zeros((n, ) * 6)
+        dm[0, 1, 0, 1, 1, 0] = 0.25
+        dm[1, 1, 1] = np.arange(1, n ** 3 + 1).reshape((n, ) * 3)
+        flat = dm.reshape((n ** 3, n ** 3))
+        data, directory = b'', []
+        for tile in flat:
+            pos = np.nonzero(tile)[0]
+            offset = TILE_HEADER.size + len(data)
+            if len(pos) == 0:
+                directory += [0, 0]
+            elif 12 * len(pos) >= 8 * len(tile):
+                data += tile.astype('<f8').tobytes()
+                directory += [offset, -1]
+            else:
+                data += pos.astype('<u4').tobytes() + tile[pos].astype('<f8').tobytes()
+                directory += [offset, len(pos)]
+        filename = str(tmp_path / 'spatial_threepdm.0.0.tiles')
+        with open(filename, 'wb') as f:
+            f.write(TILE_HEADER.pack(TILE_MAGIC, 6, n, n ** 3, TILE_HEADER.size + len(data)))
+            f.write(data)
+            f.write(struct.pack('<%dq' % len(directory), *directory))
+        
+        tiles = NPDMTiles(filename)
+        assert tiles.order == 6 and tiles.n == n
+        for lead in np.ndindex((n, ) * 3):
+            assert np.allclose(tiles.tile(*lead), dm[lead])
+        assert tiles[0, 1, 0, 1, 1, 0] == 0.25
+        assert [lead for lead, _ in tiles.tiles()] == [(0, 1, 0), (1, 1, 1)]
@@ -88,3 +88,18 @@ class TestOperator:
         assert (a + c + e) * 0 == 0 * (a + c + e) == 0
         assert (a + c + e) * (-0.5) == (-0.5) * (a + c + e) == (a + c + e) / (-2.0)
         assert (a + c).strings[0].op == a
+    
+    def test_interning(self):
+        import pickle, copy
+        a = OpElement(OpNames.P, (1, 2, 0))
+        b = OpElement(OpNames.P, (1, 2, 0), q_label=0)
+        c = OpElement(OpNames.P, (2, 1, 0))
+        assert a is not b and a == b and a.id == b.id and hash(a) == hash(b)
+        assert a != c and a.id != c.id
+        assert (a * 2.0).id != a.id and abs(a * 2.0).id == a.id
+        for x in [a, a * 2.0, a * c, a * c + c * a]:
+            assert pickle.loads(pickle.dumps(x)) == x
+            assert copy.deepcopy(x) == x
+        y = pickle.loads(pickle.dumps(a * c))
+        assert y.ids == (a.id, c.id) and hash(y) == hash(a * c)
+        assert len({a * c, b * c, c * a}) == 2